@@ -36,6 +36,7 @@ CBoundary::CBoundary( CDomain* pDomain )
 {
 	sName = "Boundary_" + toString( ++CBoundary::uiInstances );
 	this->pDomain = pDomain;
+	this->bFused = false;
 }
 
 /*
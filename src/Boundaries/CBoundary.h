@@ -19,8 +19,10 @@
 #ifndef HIPIMS_BOUNDARIES_CBOUNDARY_H_
 #define HIPIMS_BOUNDARIES_CBOUNDARY_H_
 
+#include <vector>
 #include "../common.h"
 #include "../Datasets/CCSVDataset.h"
+#include "../OpenCL/opencl.h"
 
 #define BOUNDARY_DEPTH_IGNORE			0
 #define BOUNDARY_DEPTH_IS_FSL			1
@@ -70,10 +72,17 @@ namespace uniformValues { enum lossUnits {
 	kValueLossRate					= 1
 }; }
 
+namespace fusableTypes { enum fusableTypes {
+	kFusableNone					= 0,	// Must run its own kernel
+	kFusableUniform					= 1,	// Can be applied by the scheme as a uniform source
+	kFusableGridded					= 2		// Can be applied by the scheme as a gridded source
+}; }
+
 }
 }
 
 // Class stubs
+class CBoundaryMap;
 class COCLBuffer;
 class COCLDevice;
 class COCLProgram;
@@ -92,7 +101,18 @@ public:
 	virtual void					streamBoundary(double) = 0;
 	virtual void					cleanBoundary() = 0;
 	virtual void					importMap(CCSVDataset*, bool = false)		{};
+	virtual void					importMapCells(CBoundaryMap*)				{};
 	std::string						getName()							{ return sName; };
+	virtual unsigned char			getFusableType()					{ return model::boundaries::fusableTypes::kFusableNone; };
+	virtual bool					isHydrological()					{ return false; };
+	virtual double					getNextActiveTime( double dTime )	{ return dTime; };		// Earliest time from which water may be added
+	virtual COCLBuffer*				getConfigurationBuffer()			{ return NULL; };
+	virtual COCLBuffer*				getTimeseriesBuffer()				{ return NULL; };
+	virtual bool					getFootprint( std::vector<cl_ulong>* )	{ return false; };	// Sorted cells written, false if any may be
+	virtual bool					replaceTimeseries( std::string, bool = true )	{ return false; };	// Swap in (or just check) a new forcing series in place
+	COCLKernel*						getKernel()							{ return oclKernel; };
+	void							setFused( bool b )					{ bFused = b; };
+	bool							isFused()							{ return bFused; };
 
 	static int			uiInstances;
 
@@ -101,6 +121,7 @@ protected:
 	CDomain*			pDomain;
 	COCLKernel*			oclKernel;
 	std::string			sName;
+	bool				bFused;
 
 	/*
 	unsigned int		iType;
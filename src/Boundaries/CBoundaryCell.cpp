@@ -17,16 +17,20 @@
  *
  */
 #include <vector>
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 
 #include "CBoundaryMap.h"
 #include "CBoundaryCell.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
+#include "../Datasets/CXMLDataset.h"
+#include "../Datasets/CVectorDataset.h"
 #include "../OpenCL/Executors/COCLBuffer.h"
 #include "../OpenCL/Executors/COCLKernel.h"
 #include "../common.h"
 
 using std::vector;
+using std::max;
 
 /* 
  *  Constructor
@@ -39,6 +43,11 @@ CBoundaryCell::CBoundaryCell( CDomain* pDomain )
 	this->pBufferConfiguration = NULL;
 	this->pBufferRelations = NULL;
 	this->pBufferTimeseries = NULL;
+	this->pRelations = NULL;
+	this->pTimeseries = NULL;
+	this->uiRelationCount = 0;
+	this->uiTimeseriesLength = 0;
+	this->uiTimeseriesCapacity = 0;
 
 	this->pDomain = pDomain;
 }
@@ -49,6 +58,7 @@ CBoundaryCell::CBoundaryCell( CDomain* pDomain )
 CBoundaryCell::~CBoundaryCell()
 {
 	delete[] this->pTimeseries;
+	delete[] this->pRelations;
 
 	delete this->pBufferRelations;
 	delete this->pBufferConfiguration;
@@ -60,7 +70,8 @@ CBoundaryCell::~CBoundaryCell()
  */
 bool CBoundaryCell::setupFromConfig(XMLElement* pElement, std::string sBoundarySourceDir)
 {
-	char *cBoundaryType, *cBoundaryName, *cBoundarySource, *cBoundaryDepth, *cBoundaryDischarge, *cBoundaryMap;
+	char *cBoundaryType, *cBoundaryName, *cBoundarySource, *cBoundaryDepth, *cBoundaryDischarge, *cBoundaryMap,
+		 *cBoundaryVector, *cBoundaryVectorLayer, *cBoundaryVectorField, *cBoundaryCapacity;
 
 	Util::toLowercase(&cBoundaryType,		pElement->Attribute("type"));
 	Util::toNewString(&cBoundaryName,		pElement->Attribute("name"));
@@ -68,9 +79,26 @@ bool CBoundaryCell::setupFromConfig(XMLElement* pElement, std::string sBoundaryS
 	Util::toLowercase(&cBoundaryMap,		pElement->Attribute("mapFile"));
 	Util::toLowercase(&cBoundaryDepth,		pElement->Attribute("depthValue"));
 	Util::toLowercase(&cBoundaryDischarge,		pElement->Attribute("dischargeValue"));
+	Util::toNewString(&cBoundaryVector,			pElement->Attribute("vectorFile"));
+	Util::toNewString(&cBoundaryVectorLayer,	pElement->Attribute("vectorLayer"));
+	Util::toNewString(&cBoundaryVectorField,	pElement->Attribute("vectorField"));
+	Util::toNewString(&cBoundaryCapacity,		pElement->Attribute("maxEntries"));
 
 	this->sName = std::string( cBoundaryName );
 
+	// Leave room in the device buffer for longer replacement timeseries
+	if (cBoundaryCapacity != NULL) {
+		if (CXMLDataset::isValidUnsignedInt(std::string(cBoundaryCapacity))) {
+			this->uiTimeseriesCapacity = boost::lexical_cast<unsigned int>(cBoundaryCapacity);
+		} else {
+			model::doError(
+				"Maximum timeseries entries must be a whole number.",
+				model::errorCodes::kLevelWarning
+			);
+		}
+		delete[] cBoundaryCapacity;
+	}
+
 	// Discharge column represents...?
 	if (cBoundaryDischarge == NULL || strcmp(cBoundaryDischarge, "total") == 0)
 	{
@@ -122,6 +150,29 @@ bool CBoundaryCell::setupFromConfig(XMLElement* pElement, std::string sBoundaryS
 	}
 	delete pCSVFile;
 
+	// Polygons/lines from a vector layer, optionally only features whose field matches this boundary's name
+	if ( cBoundaryVector != NULL ) {
+		CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
+		CVectorDataset* pVectorFile = new CVectorDataset();
+		std::vector<unsigned long> vCells;
+		std::string sVectorField = cBoundaryVectorField == NULL ? "" : std::string(cBoundaryVectorField);
+
+		if (!pDomain->isRemote() &&
+			(!pVectorFile->openFileRead(sBoundarySourceDir + std::string(cBoundaryVector), cBoundaryVectorLayer == NULL ? "" : std::string(cBoundaryVectorLayer)) ||
+			 !pVectorFile->rasteriseForDomain(pDomain, sVectorField, this->sName, &vCells))) {
+			model::doError(
+				"Could not read a boundary vector file.",
+				model::errorCodes::kLevelWarning
+			);
+			delete pVectorFile;
+			return false;
+		}
+		delete pVectorFile;
+
+		this->importCells(&vCells);
+		return true;
+	}
+
 	// Map file is optional -- could also have a single map file for all boundaries
 	if ( cBoundaryMap == NULL ) {
 		std::cout << "DEBUG: CBoundaryCell without map." << std::endl;
@@ -241,6 +292,7 @@ void CBoundaryCell::importMap(CCSVDataset *pCSV, bool realCoordinates)
 	if (!pCSV->isReady())
 		return;
 
+	delete[] this->pRelations;
 	this->pRelations = new sRelationCell[pCSV->getLength()];
 	this->uiRelationCount = 0;
 
@@ -323,6 +375,52 @@ void CBoundaryCell::importMap(CCSVDataset *pCSV, bool realCoordinates)
 	this->uiRelationCount = uiIndex;
 }
 
+/*
+ *	Take the cells for this boundary from the map file already indexed by the boundary map
+ */
+void CBoundaryCell::importMapCells(CBoundaryMap *pMap)
+{
+	CBoundaryMap::mapCellRange_t pNamed  = pMap->getMapCells(this->getName());
+	CBoundaryMap::mapCellRange_t pShared = pMap->getMapCells("");
+	unsigned int uiIndex = 0;
+
+	delete[] this->pRelations;
+	this->pRelations = new sRelationCell[std::distance(pNamed.first, pNamed.second) + std::distance(pShared.first, pShared.second)];
+
+	for (CBoundaryMap::mapCells_t::const_iterator it = pNamed.first; it != pNamed.second; it++, uiIndex++)
+	{
+		this->pRelations[uiIndex].uiCellX = it->second.uiCellX;
+		this->pRelations[uiIndex].uiCellY = it->second.uiCellY;
+	}
+	for (CBoundaryMap::mapCells_t::const_iterator it = pShared.first; it != pShared.second; it++, uiIndex++)
+	{
+		this->pRelations[uiIndex].uiCellX = it->second.uiCellX;
+		this->pRelations[uiIndex].uiCellY = it->second.uiCellY;
+	}
+
+	this->uiRelationCount = uiIndex;
+}
+
+/*
+ *	Take the cells for this boundary from a sorted list of cell IDs
+ */
+void CBoundaryCell::importCells(std::vector<unsigned long> *pCells)
+{
+	CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
+	unsigned long ulCols = pDomain->getCols();
+
+	delete[] this->pRelations;
+	this->pRelations = new sRelationCell[pCells->size()];
+
+	for (unsigned int i = 0; i < pCells->size(); i++)
+	{
+		this->pRelations[i].uiCellX = (*pCells)[i] % ulCols;
+		this->pRelations[i].uiCellY = (*pCells)[i] / ulCols;
+	}
+
+	this->uiRelationCount = pCells->size();
+}
+
 void CBoundaryCell::prepareBoundary(
 			COCLDevice* pDevice, 
 			COCLProgram* pProgram,
@@ -335,8 +433,75 @@ void CBoundaryCell::prepareBoundary(
 {
 	// TODO: Apply scaling if discharge column is the total volume across the boundary
 
+	this->ucFloatForm = pProgram->getFloatForm();
+	this->uiTimeseriesCapacity = max(this->uiTimeseriesCapacity, this->uiTimeseriesLength);
+
 	// Configuration for the boundary and timeseries data
-	if ( pProgram->getFloatForm() == model::floatPrecision::kSingle )
+	this->pBufferConfiguration = new COCLBuffer(
+		"Bdy_" + this->sName + "_Conf",
+		pProgram,
+		true,
+		true,
+		this->ucFloatForm == model::floatPrecision::kSingle ? sizeof(sConfigurationSP) : sizeof(sConfigurationDP),
+		true
+	);
+	this->pBufferTimeseries = new COCLBuffer(
+		"Bdy_" + this->sName + "_Series",
+		pProgram,
+		true,
+		true,
+		(this->ucFloatForm == model::floatPrecision::kSingle ? sizeof(cl_float4) : sizeof(cl_double4)) * this->uiTimeseriesCapacity,
+		true
+	);
+	this->fillBuffers();
+
+	this->pBufferConfiguration->createBuffer();
+	this->pBufferConfiguration->queueWriteAll();
+	this->pBufferTimeseries->createBuffer();
+	this->pBufferTimeseries->queueWriteAll();
+
+	// Cell relation data for the boundary
+	this->pBufferRelations = new COCLBuffer(
+		"Bdy_" + this->sName + "_Rels",
+		pProgram,
+		true,
+		true,
+		sizeof( cl_ulong ) * this->uiRelationCount,
+		true
+	);
+	// This is a bit of a mess... but it works...
+	CDomainCartesian* pDomainCart = static_cast<CDomainCartesian*>(this->pDomain);
+	cl_ulong* pCells = this->pBufferRelations->getHostBlock<cl_ulong*>();
+	for (unsigned int i = 0; i < this->uiRelationCount; ++i)
+		pCells[i] = pDomainCart->getCellID( this->pRelations[i].uiCellX, this->pRelations[i].uiCellY );
+	this->pBufferRelations->createBuffer();
+	this->pBufferRelations->queueWriteAll();
+
+	this->oclKernel = pProgram->getKernel("bdy_Cell");
+	COCLBuffer* aryArgsBdy[] = { 
+		pBufferConfiguration, 
+		pBufferRelations, 
+		pBufferTimeseries, 
+		pBufferTime, 
+		pBufferTimestep, 
+		pBufferTimeHydrological, 
+		NULL,	// Cell states (added later)
+		pBufferBed, 
+		pBufferManning
+	};
+
+	this->oclKernel->assignArguments(aryArgsBdy);
+	this->oclKernel->setGroupSize(8);
+	this->oclKernel->setGlobalSize( ( this->uiRelationCount / 8 + 1 ) * 8 );
+}
+
+// TODO: Only the cell buffer should be passed here...
+/*
+ *	Copy the configuration and timeseries into the host blocks of the buffers
+ */
+void CBoundaryCell::fillBuffers()
+{
+	if ( this->ucFloatForm == model::floatPrecision::kSingle )
 	{
 		sConfigurationSP pConfiguration;
 
@@ -347,28 +512,12 @@ void CBoundaryCell::prepareBoundary(
 		pConfiguration.DefinitionDischarge = (cl_uint)this->ucDischargeValue;
 		pConfiguration.RelationCount      = this->uiRelationCount;
 
-		this->pBufferConfiguration = new COCLBuffer(
-			"Bdy_" + this->sName + "_Conf",
-			pProgram,
-			true,
-			true,
-			sizeof(sConfigurationSP),
-			true
-		);
 		std::memcpy(
 			this->pBufferConfiguration->getHostBlock<void*>(),
 			&pConfiguration,
 			sizeof(sConfigurationSP)
 		);
 
-		this->pBufferTimeseries = new COCLBuffer(
-			"Bdy_" + this->sName + "_Series",
-			pProgram,
-			true,
-			true,
-			sizeof(cl_float4)* this->uiTimeseriesLength,
-			true
-		);
 		cl_float4 *pTimeseries = this->pBufferTimeseries->getHostBlock<cl_float4*>();
 		for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
 		{
@@ -393,37 +542,16 @@ void CBoundaryCell::prepareBoundary(
 		pConfiguration.DefinitionDischarge = (cl_uint)this->ucDischargeValue;
 		pConfiguration.RelationCount	  = this->uiRelationCount;
 
-		this->pBufferConfiguration = new COCLBuffer(
-			"Bdy_" + this->sName + "_Conf",
-			pProgram,
-			true,
-			true,
-			sizeof( sConfigurationDP ),
-			true
-		);
 		std::memcpy(
 			this->pBufferConfiguration->getHostBlock<void*>(),
 			&pConfiguration,
 			sizeof( sConfigurationDP )
 		);
 
-		this->pBufferTimeseries = new COCLBuffer(
-			"Bdy_" + this->sName + "_Series",
-			pProgram,
-			true,
-			true,
-			sizeof(cl_double4)* this->uiTimeseriesLength,
-			true
-		);
 		cl_double4 *pTimeseries = this->pBufferTimeseries->getHostBlock<cl_double4*>();
 		for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
 		{
-			std::cout << "DEBUG: " << __PRETTY_FUNCTION__ << " timeseries " << i << " / " << this->uiTimeseriesLength << " " << (void*)pTimeseries << " " << (void*)this->pTimeseries << std::endl;
-			std::cout << "DEBUG: " << this->pTimeseries[i].dTime << std::endl; 
-			std::cout << "DEBUG: " << pTimeseries[i].s[0] << std::endl; 
-			pTimeseries[i].s[0] = 123.0;
 			pTimeseries[i].s[0] = this->pTimeseries[i].dTime;
-			std::cout << "DEBUG: MARK" << std::endl; 
 			pTimeseries[i].s[1] = this->pTimeseries[i].dDepthComponent;
 			pTimeseries[i].s[2] = this->pTimeseries[i].dDischargeComponentX;
 			pTimeseries[i].s[3] = this->pTimeseries[i].dDischargeComponentY;
@@ -435,48 +563,68 @@ void CBoundaryCell::prepareBoundary(
 			}
 		}
 	}
+}
 
-	this->pBufferConfiguration->createBuffer();
-	this->pBufferConfiguration->queueWriteAll();
-	this->pBufferTimeseries->createBuffer();
-	this->pBufferTimeseries->queueWriteAll();
+/*
+ *	Swap in a new timeseries without recreating the buffers, or only check
+ *	that it would be accepted
+ */
+bool CBoundaryCell::replaceTimeseries(std::string sSource, bool bApply)
+{
+	if (this->pBufferTimeseries == NULL)
+		return false;
 
-	// Cell relation data for the boundary
-	this->pBufferRelations = new COCLBuffer(
-		"Bdy_" + this->sName + "_Rels",
-		pProgram,
-		true,
-		true,
-		sizeof( cl_ulong ) * this->uiRelationCount,
-		true
-	);
-	// This is a bit of a mess... but it works...
-	CDomainCartesian* pDomainCart = static_cast<CDomainCartesian*>(this->pDomain);
-	cl_ulong* pCells = this->pBufferRelations->getHostBlock<cl_ulong*>();
-	for (unsigned int i = 0; i < this->uiRelationCount; ++i)
-		pCells[i] = pDomainCart->getCellID( this->pRelations[i].uiCellX, this->pRelations[i].uiCellY );
-	this->pBufferRelations->createBuffer();
-	this->pBufferRelations->queueWriteAll();
+	CCSVDataset* pCSVFile = new CCSVDataset(sSource);
+	if (!pCSVFile->readFile() || !pCSVFile->isReady())
+	{
+		model::doError(
+			"Could not read a replacement timeseries for boundary '" + this->sName + "'.",
+			model::errorCodes::kLevelWarning
+		);
+		delete pCSVFile;
+		return false;
+	}
 
-	this->oclKernel = pProgram->getKernel("bdy_Cell");
-	COCLBuffer* aryArgsBdy[] = { 
-		pBufferConfiguration, 
-		pBufferRelations, 
-		pBufferTimeseries, 
-		pBufferTime, 
-		pBufferTimestep, 
-		pBufferTimeHydrological, 
-		NULL,	// Cell states (added later)
-		pBufferBed, 
-		pBufferManning
-	};
+	sTimeseriesCell*	pPrevious		= this->pTimeseries;
+	unsigned int		uiPrevious		= this->uiTimeseriesLength;
+	double				dPrevInterval	= this->dTimeseriesInterval;
+	double				dPrevLength		= this->dTimeseriesLength;
+	double				dPrevVolume		= this->dTotalVolume;
 
-	this->oclKernel->assignArguments(aryArgsBdy);
-	this->oclKernel->setGroupSize(8);
-	this->oclKernel->setGlobalSize( ( this->uiRelationCount / 8 + 1 ) * 8 );
+	this->uiTimeseriesLength = 0;
+	this->importTimeseries(pCSVFile);
+	delete pCSVFile;
+
+	// Entries must fit the buffer allocated when the boundary was prepared
+	bool bValid = ( this->uiTimeseriesLength >= 2 );
+	if (this->uiTimeseriesLength > this->uiTimeseriesCapacity)
+	{
+		model::doError(
+			"Replacement timeseries for boundary '" + this->sName + "' has more than " +
+			toString(this->uiTimeseriesCapacity) + " entries. Raise maxEntries to allow it.",
+			model::errorCodes::kLevelWarning
+		);
+		bValid = false;
+	}
+	if (!bValid || !bApply)
+	{
+		delete[] this->pTimeseries;
+		this->pTimeseries = pPrevious;
+		this->uiTimeseriesLength = uiPrevious;
+		this->dTimeseriesInterval = dPrevInterval;
+		this->dTimeseriesLength = dPrevLength;
+		this->dTotalVolume = dPrevVolume;
+		return bValid;
+	}
+	delete[] pPrevious;
+
+	this->fillBuffers();
+	this->pBufferConfiguration->queueWriteAll();
+	this->pBufferTimeseries->queueWriteAll();
+
+	return true;
 }
 
-// TODO: Only the cell buffer should be passed here...
 void CBoundaryCell::applyBoundary(COCLBuffer* pBufferCell)
 {
 	this->oclKernel->assignArgument( 6, pBufferCell );
@@ -495,3 +643,43 @@ void CBoundaryCell::cleanBoundary()
 	// TODO: Is this needed? Most stuff is cleaned in the destructor
 }
 
+/*
+ *	Cells written by the boundary kernel, so independent boundaries can run together
+ */
+bool CBoundaryCell::getFootprint(std::vector<cl_ulong>* pCells)
+{
+	CDomainCartesian* pDomainCart = static_cast<CDomainCartesian*>(this->pDomain);
+
+	pCells->clear();
+	pCells->reserve(this->uiRelationCount);
+	for (unsigned int i = 0; i < this->uiRelationCount; ++i)
+		pCells->push_back(pDomainCart->getCellID(this->pRelations[i].uiCellX, this->pRelations[i].uiCellY));
+	std::sort(pCells->begin(), pCells->end());
+
+	return true;
+}
+
+/*
+ *	Earliest time from which an inflow may be imposed. Depth and level
+ *	conditions may add water at any time, and discharges are interpolated
+ *	so they ramp up from the entry before.
+ */
+double CBoundaryCell::getNextActiveTime(double dTime)
+{
+	if (this->ucDepthValue != model::boundaries::depthValues::kValueIgnored)
+		return dTime;
+
+	for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
+	{
+		if (this->pTimeseries[i].dDischargeComponentX == 0.0 &&
+			this->pTimeseries[i].dDischargeComponentY == 0.0)
+			continue;
+
+		// Still ramping down from this entry, or held beyond the last
+		if (i + 1 >= this->uiTimeseriesLength || this->pTimeseries[i + 1].dTime > dTime)
+			return max(dTime, this->pTimeseries[i > 0 ? i - 1 : 0].dTime);
+	}
+
+	return pManager->getSimulationLength();
+}
+
@@ -34,7 +34,11 @@ public:
 	virtual void					applyBoundary(COCLBuffer*);
 	virtual void					streamBoundary(double);
 	virtual void					cleanBoundary();
+	virtual bool					getFootprint( std::vector<cl_ulong>* );
+	virtual double					getNextActiveTime(double);
 	virtual void					importMap(CCSVDataset*, bool = false);
+	virtual void					importMapCells(CBoundaryMap*);
+	virtual bool					replaceTimeseries(std::string, bool = true);
 
 protected:	
 
@@ -73,6 +77,8 @@ protected:
 	void							setDischargeValue( unsigned char a )		{ ucDischargeValue = a; };
 	void							setDepthValue( unsigned char a )			{ ucDepthValue = a; };
 	void							importTimeseries( CCSVDataset* );
+	void							importCells( std::vector<unsigned long>* );
+	void							fillBuffers();
 
 	unsigned char					ucDischargeValue;
 	unsigned char					ucDepthValue;
@@ -85,6 +91,8 @@ protected:
 	sRelationCell*					pRelations;
 	unsigned int					uiTimeseriesLength;
 	unsigned int					uiRelationCount;
+	unsigned int					uiTimeseriesCapacity;
+	unsigned char					ucFloatForm;
 
 	COCLBuffer*						pBufferTimeseries;
 	COCLBuffer*						pBufferRelations;
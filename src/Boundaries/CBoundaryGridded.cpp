@@ -19,6 +19,7 @@
 #include <vector>
 #include <algorithm>
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
 
 #include "CBoundaryMap.h"
 #include "CBoundaryGridded.h"
@@ -45,6 +46,7 @@ CBoundaryGridded::CBoundaryGridded(CDomain* pDomain)
 	this->pBufferConfiguration = NULL;
 	this->pBufferTimeseries = NULL;
 	this->uiTimeseriesLength = 0;
+	this->uiFirstBand = 1;
 
 	this->pDomain = pDomain;
 }
@@ -67,7 +69,8 @@ CBoundaryGridded::~CBoundaryGridded()
 */
 bool CBoundaryGridded::setupFromConfig(XMLElement* pElement, std::string sBoundarySourceDir)
 {
-	char *cBoundaryType, *cBoundaryName, *cBoundaryMask, *cBoundaryInterval, *cBoundaryValue;
+	char *cBoundaryType, *cBoundaryName, *cBoundaryMask, *cBoundaryInterval, *cBoundaryValue,
+		 *cBoundarySource, *cBoundaryVariable, *cBoundaryFirstBand;
 	double dInterval = 0.0;
 
 	Util::toLowercase(&cBoundaryType, pElement->Attribute("type"));
@@ -75,6 +78,9 @@ bool CBoundaryGridded::setupFromConfig(XMLElement* pElement, std::string sBounda
 	Util::toNewString(&cBoundaryMask, pElement->Attribute("mask"));
 	Util::toLowercase(&cBoundaryInterval, pElement->Attribute("interval"));
 	Util::toLowercase(&cBoundaryValue, pElement->Attribute("value"));
+	Util::toNewString(&cBoundarySource, pElement->Attribute("source"));
+	Util::toNewString(&cBoundaryVariable, pElement->Attribute("variable"));
+	Util::toLowercase(&cBoundaryFirstBand, pElement->Attribute("firstBand"));
 
 	// Must have unique name for each boundary (will get autoname by default)
 	this->sName = std::string(cBoundaryName);
@@ -114,6 +120,48 @@ bool CBoundaryGridded::setupFromConfig(XMLElement* pElement, std::string sBounda
 	this->dTimeseriesInterval = dInterval;
 	this->dTimeseriesLength = pManager->getSimulationLength();
 
+	// A single multi-frame file (NetCDF, GRIB, multi-band GeoTIFF...) holding one band per interval
+	if (cBoundarySource != NULL)
+	{
+		CRasterDataset *pRaster = CBoundaryGridded::openFrameSource(
+			sBoundarySourceDir,
+			cBoundarySource,
+			cBoundaryVariable,
+			cBoundaryFirstBand,
+			&this->uiFirstBand
+		);
+		if (pRaster == NULL)
+			return false;
+
+		pTransform = pRaster->createTransformationForDomain(static_cast<CDomainCartesian*>(this->pDomain));
+
+		unsigned long ulEntry = 0;
+		for ( double dTime = 0.0; dTime <= pManager->getSimulationLength(); dTime += dInterval )
+		{
+			if (this->uiFirstBand + ulEntry > pRaster->getBandCount())
+			{
+				model::doError(
+					"Gridded boundary frame missing for " + Util::secondsToTime( dTime ) + " in '" + std::string( cBoundarySource ) + "'",
+					model::errorCodes::kLevelWarning
+				);
+				this->dTimeseriesLength = min( this->dTimeseriesLength, dTime );
+				break;
+			}
+
+			this->pTimeseries[ulEntry] = new CBoundaryGriddedEntry(
+				dTime,
+				pRaster->createArrayForBoundary( pTransform, this->uiFirstBand + ulEntry )
+			);
+			ulEntry++;
+		}
+
+		delete pRaster;
+		this->pTransform = pTransform;
+		this->uiTimeseriesLength = ulEntry;
+
+		return true;
+	}
+
 	// Deal with the gridded files...
 	unsigned long ulEntry = 0;
 	for ( double dTime = 0.0; dTime <= pManager->getSimulationLength(); dTime += dInterval )
@@ -158,6 +206,55 @@ bool CBoundaryGridded::setupFromConfig(XMLElement* pElement, std::string sBounda
 	return true;
 }
 
+/*
+*	Open a multi-frame file once, optionally a named variable (i.e. NetCDF subdataset), and check its first band
+*/
+CRasterDataset* CBoundaryGridded::openFrameSource(
+	std::string sBoundarySourceDir,
+	char* cSource,
+	char* cVariable,
+	char* cFirstBand,
+	unsigned int* uiFirstBand
+	)
+{
+	std::string sFilename = sBoundarySourceDir + std::string(cSource);
+
+	*uiFirstBand = 1;
+	if (cFirstBand != NULL && CXMLDataset::isValidUnsignedInt(cFirstBand))
+		*uiFirstBand = max(1U, boost::lexical_cast<unsigned int>(cFirstBand));
+
+	if (!Util::fileExists(sFilename.c_str()))
+	{
+		model::doError(
+			"Gridded boundary source missing with filename '" + sFilename + "'",
+			model::errorCodes::kLevelWarning
+		);
+		return NULL;
+	}
+
+	if (cVariable != NULL)
+	{
+		std::string sDriver = boost::algorithm::iends_with(sFilename, ".grb") || boost::algorithm::iends_with(sFilename, ".grib") || boost::algorithm::iends_with(sFilename, ".grb2")
+			? "GRIB" : "NETCDF";
+		sFilename = sDriver + ":\"" + sFilename + "\":" + std::string(cVariable);
+	}
+
+	CRasterDataset *pRaster = new CRasterDataset();
+	if (!pRaster->openFileRead(sFilename) || pRaster->getBandCount() < *uiFirstBand)
+	{
+		model::doError(
+			"Could not read frames from gridded boundary source '" + sFilename + "'",
+			model::errorCodes::kLevelWarning
+		);
+		delete pRaster;
+		return NULL;
+	}
+
+	pManager->log->writeLine("Gridded boundary source has " + toString(pRaster->getBandCount()) + " frames, starting at band " + toString(*uiFirstBand) + ".");
+
+	return pRaster;
+}
+
 void CBoundaryGridded::prepareBoundary(
 	COCLDevice* pDevice,
 	COCLProgram* pProgram,
@@ -319,6 +416,29 @@ void CBoundaryGridded::cleanBoundary()
 	// TODO: Is this needed? Most stuff is cleaned in the destructor
 }
 
+/*
+ *	Earliest time from which a frame adds water to any cell
+ */
+double CBoundaryGridded::getNextActiveTime(double dTime)
+{
+	unsigned long ulFrameCells = this->pTransform == NULL ? 0 : this->pTransform->uiColumns * this->pTransform->uiRows;
+
+	// Each frame holds for one interval
+	for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
+	{
+		if (this->pTimeseries[i]->dTime + this->dTimeseriesInterval <= dTime ||
+			this->pTimeseries[i]->dTime >= this->dTimeseriesLength)
+			continue;
+		for (unsigned long j = 0; j < ulFrameCells; ++j)
+		{
+			if (this->pTimeseries[i]->dValues[j] > 0.0)
+				return max(dTime, this->pTimeseries[i]->dTime);
+		}
+	}
+
+	return pManager->getSimulationLength();
+}
+
 /*
  *	Timeseries grid data has its own management class
  */
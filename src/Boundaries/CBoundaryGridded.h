@@ -22,6 +22,9 @@
 #include "../common.h"
 #include "CBoundary.h"
 
+// Class stubs
+class CRasterDataset;
+
 class CBoundaryGridded : public CBoundary
 {
 public:
@@ -34,6 +37,12 @@ public:
 	virtual void					applyBoundary(COCLBuffer*);
 	virtual void					streamBoundary(double);
 	virtual void					cleanBoundary();
+	virtual double					getNextActiveTime(double);
+	virtual unsigned char			getFusableType()					{ return model::boundaries::fusableTypes::kFusableGridded; };
+	virtual COCLBuffer*				getConfigurationBuffer()			{ return pBufferConfiguration; };
+	virtual COCLBuffer*				getTimeseriesBuffer()				{ return pBufferTimeseries; };
+	virtual bool					isHydrological()					{ return true; };
+	static CRasterDataset*			openFrameSource(std::string, char*, char*, char*, unsigned int*);
 
 	struct SBoundaryGridTransform
 	{
@@ -94,6 +103,7 @@ protected:
 	CBoundaryGriddedEntry**			pTimeseries;
 	SBoundaryGridTransform*			pTransform;
 	unsigned int					uiTimeseriesLength;
+	unsigned int					uiFirstBand;
 
 	COCLBuffer*						pBufferTimeseries;
 	COCLBuffer*						pBufferConfiguration;
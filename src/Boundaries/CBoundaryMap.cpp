@@ -19,11 +19,17 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <vector>
+#include <algorithm>
 
+#include "../Datasets/CVectorDataset.h"
 #include "../Datasets/CXMLDataset.h"
 #include "../Domain/CDomain.h"
 #include "../Domain/CDomainManager.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
+#include "../General/CBenchmark.h"
+#include "../OpenCL/Executors/CExecutorControlOpenCL.h"
+#include "../OpenCL/Executors/COCLDevice.h"
+#include "../OpenCL/Executors/COCLKernel.h"
 #include "../common.h"
 #include "CBoundary.h"
 #include "CBoundaryCell.h"
@@ -40,6 +46,8 @@ using std::vector;
  */
 CBoundaryMap::CBoundaryMap(CDomain* pDomain) {
 	this->pDomain = pDomain;
+	for (unsigned char i = 0; i < 4; i++)
+		this->ucBoundaryTreatment[i] = CDomainCartesian::kBoundaryOpen;
 }
 
 /*
@@ -66,14 +74,129 @@ void CBoundaryMap::prepareBoundaries(COCLProgram* pProgram,
 		(it->second)
 			->prepareBoundary(pProgram->getDevice(), pProgram, pBufferBed, pBufferManning, pBufferTime,
 							  pBufferTimeHydrological, pBufferTimestep);
+
+	this->indexConflicts();
 }
 
 /*
- *	Apply the buffers (execute the relevant kernels etc.)
+ *	Work out which boundaries write to the same cells, and so must not run
+ *	at the same time. Boundaries which can't say which cells they write
+ *	conflict with every other.
  */
-void CBoundaryMap::applyBoundaries(COCLBuffer* pCellBuffer) {
-	for (mapBoundaries_t::iterator it = mapBoundaries.begin(); it != mapBoundaries.end(); it++)
-		(it->second)->applyBoundary(pCellBuffer);
+void CBoundaryMap::indexConflicts() {
+	vector<vector<cl_ulong>>	vecFootprints;
+	vector<bool>				vecBounded;
+	unsigned int				uiConflicts = 0;
+
+	vecApplyOrder.clear();
+	vecConflicts.clear();
+
+	for (mapBoundaries_t::iterator it = mapBoundaries.begin(); it != mapBoundaries.end(); it++) {
+		vecApplyOrder.push_back(it->second);
+		vecFootprints.push_back(vector<cl_ulong>());
+		vecBounded.push_back((it->second)->getFootprint(&vecFootprints.back()));
+	}
+
+	vecConflicts.resize(vecApplyOrder.size());
+	for (unsigned int i = 0; i < vecApplyOrder.size(); ++i) {
+		for (unsigned int j = 0; j < i; ++j) {
+			bool bConflict = !vecBounded[i] || !vecBounded[j];
+
+			// Both footprints are sorted
+			vector<cl_ulong>::const_iterator itI = vecFootprints[i].begin(), itJ = vecFootprints[j].begin();
+			while (!bConflict && itI != vecFootprints[i].end() && itJ != vecFootprints[j].end()) {
+				if (*itI < *itJ) {
+					++itI;
+				} else if (*itJ < *itI) {
+					++itJ;
+				} else {
+					bConflict = true;
+				}
+			}
+
+			if (bConflict) {
+				vecConflicts[i].push_back(j);
+				uiConflicts++;
+			}
+		}
+	}
+
+	if (vecApplyOrder.size() > 1)
+		pManager->log->writeLine("Boundary kernels ordered by " + toString(uiConflicts) + " conflict(s) between " +
+								 toString(vecApplyOrder.size()) + " boundaries.");
+}
+
+/*
+ *	Apply the buffers (execute the relevant kernels etc.), hydrological boundaries
+ *	can be left out on the steps where they have nothing to apply
+ */
+unsigned int CBoundaryMap::applyBoundaries(COCLBuffer* pCellBuffer, bool bHydrological) {
+	unsigned int	uiScheduled	= 0;
+	bool			bEvents		= (pManager->getExecutor()->getQueueMode() == model::queueModes::kQueueEvents);
+	vector<bool>	vecPending(vecApplyOrder.size(), false);
+	vector<cl_event> vecEvents(vecApplyOrder.size(), (cl_event)NULL);
+	vector<cl_event> vecWait;
+
+	// Boundaries writing different cells run together. Those that conflict either
+	// wait behind a queue barrier, or wait on the events of just the earlier
+	// boundaries they conflict with.
+	for (unsigned int i = 0; i < vecApplyOrder.size(); ++i) {
+		CBoundary* pBoundary = vecApplyOrder[i];
+		if (pBoundary->isFused() || (!bHydrological && pBoundary->isHydrological()))
+			continue;
+
+		if (bEvents) {
+			vecWait.clear();
+			for (unsigned int j = 0; j < vecConflicts[i].size(); ++j) {
+				if (vecEvents[vecConflicts[i][j]] != NULL)
+					vecWait.push_back(vecEvents[vecConflicts[i][j]]);
+			}
+			if (pBoundary->getKernel() != NULL)
+				pBoundary->getKernel()->setEventDependencies(vecWait.size(), vecWait.empty() ? NULL : &vecWait[0], &vecEvents[i]);
+		} else {
+			for (unsigned int j = 0; j < vecConflicts[i].size(); ++j) {
+				if (!vecPending[vecConflicts[i][j]])
+					continue;
+				pDomain->getDevice()->queueBarrier();
+				std::fill(vecPending.begin(), vecPending.end(), false);
+				break;
+			}
+		}
+
+		pBoundary->applyBoundary(pCellBuffer);
+		vecPending[i] = true;
+		uiScheduled++;
+	}
+
+	// Commands already queued keep hold of the events they wait on
+	for (unsigned int i = 0; i < vecEvents.size(); ++i) {
+		if (vecEvents[i] != NULL)
+			clReleaseEvent(vecEvents[i]);
+	}
+
+	return uiScheduled;
+}
+
+/*
+ *	Hand one boundary of the given type to the scheme, which applies it within its own
+ *	kernel instead. The first by name is chosen so the selection is repeatable.
+ */
+CBoundary* CBoundaryMap::fuseBoundary(unsigned char ucFusableType) {
+	CBoundary* pFused = NULL;
+
+	for (mapBoundaries_t::iterator it = mapBoundaries.begin(); it != mapBoundaries.end(); it++) {
+		if ((it->second)->getFusableType() != ucFusableType)
+			continue;
+		if (pFused == NULL || (it->second)->getName() < pFused->getName())
+			pFused = it->second;
+	}
+
+	if (pFused != NULL) {
+		pFused->setFused(true);
+		pManager->log->writeLine("Boundary '" + pFused->getName() + "' will be applied within the scheme kernel.");
+	}
+
+	return pFused;
 }
 
 /*
@@ -85,6 +208,19 @@ void CBoundaryMap::streamBoundaries(double dTime) {
 	}
 }
 
+/*
+ *	Earliest time from which any boundary may add water to the domain
+ */
+double CBoundaryMap::getNextActiveTime(double dTime) {
+	double dNext = pManager->getSimulationLength();
+	for (mapBoundaries_t::iterator it = mapBoundaries.begin(); it != mapBoundaries.end(); it++) {
+		dNext = std::min(dNext, (it->second)->getNextActiveTime(dTime));
+		if (dNext <= dTime)
+			break;
+	}
+	return dNext;
+}
+
 /*
  *	How many boundaries do we have?
  */
@@ -108,25 +244,79 @@ bool CBoundaryMap::setupFromConfig(XMLElement* pConfiguration) {
 		return true;
 	}
 
-	char *cSourceDir, *cMapFile, *cMapType;
-	std::string sSourceDir, sMapFile;
+	char *cSourceDir, *cMapFile, *cMapType, *cMapLayer, *cMapField;
+	std::string sSourceDir, sMapFile, sMapLayer, sMapField;
 
 	Util::toNewString(&cSourceDir, pBoundariesElement->Attribute("sourceDir"));
 	Util::toNewString(&cMapFile, pBoundariesElement->Attribute("mapFile"));
 	Util::toNewString(&cMapType, pBoundariesElement->Attribute("mapType"));
+	Util::toNewString(&cMapLayer, pBoundariesElement->Attribute("mapLayer"));
+	Util::toNewString(&cMapField, pBoundariesElement->Attribute("mapField"));
 	sSourceDir = (cSourceDir == NULL || strcmp(cSourceDir, "") == 0 ? "./" : (std::string(cSourceDir) + "/"));
 	sMapFile = (cMapFile == NULL ? "" : (sSourceDir + std::string(cMapFile)));
+	sMapLayer = (cMapLayer == NULL ? "" : std::string(cMapLayer));
+	sMapField = (cMapField == NULL ? "name" : std::string(cMapField));
 
 	bool mapUsesCoordinates = cMapType != NULL && strcmp(cMapType, "coordinates") == 0;
+	bool mapUsesVector = cMapType != NULL && strcmp(cMapType, "vector") == 0;
 
-	delete cSourceDir, cMapFile, cMapType;
+	delete[] cSourceDir;
+	delete[] cMapFile;
+	delete[] cMapType;
+	delete[] cMapLayer;
+	delete[] cMapField;
+
+	// ---
+	//  Domain edges
+	// ---
+	pDomainEdgeElement = pBoundariesElement->FirstChildElement("domainEdge");
+
+	while (pDomainEdgeElement != NULL) {
+		char *cEdge, *cTreatment;
+		Util::toLowercase(&cEdge, pDomainEdgeElement->Attribute("edge"));
+		Util::toLowercase(&cTreatment, pDomainEdgeElement->Attribute("treatment"));
+
+		int iEdge = -1, iTreatment = -1;
+		if (cEdge != NULL && strcmp(cEdge, "north") == 0)
+			iEdge = CDomainCartesian::kEdgeN;
+		if (cEdge != NULL && strcmp(cEdge, "east") == 0)
+			iEdge = CDomainCartesian::kEdgeE;
+		if (cEdge != NULL && strcmp(cEdge, "south") == 0)
+			iEdge = CDomainCartesian::kEdgeS;
+		if (cEdge != NULL && strcmp(cEdge, "west") == 0)
+			iEdge = CDomainCartesian::kEdgeW;
+		if (cTreatment != NULL && strcmp(cTreatment, "open") == 0)
+			iTreatment = CDomainCartesian::kBoundaryOpen;
+		if (cTreatment != NULL && strcmp(cTreatment, "closed") == 0)
+			iTreatment = CDomainCartesian::kBoundaryClosed;
+		if (cTreatment != NULL && strcmp(cTreatment, "transmissive") == 0)
+			iTreatment = CDomainCartesian::kBoundaryTransmissive;
+
+		if (iEdge < 0 || iTreatment < 0) {
+			model::doError("Unrecognised domain edge or treatment specified.", model::errorCodes::kLevelWarning);
+		} else {
+			this->ucBoundaryTreatment[iEdge] = static_cast<unsigned char>(iTreatment);
+		}
+
+		delete[] cEdge;
+		delete[] cTreatment;
+		pDomainEdgeElement = pDomainEdgeElement->NextSiblingElement("domainEdge");
+	}
 
 	// ---
 	//  Map file
 	// ---
-	if (sMapFile.length() > 0) {
+	// Parsed once into an index by boundary name, rather than rescanned for every boundary
+	CBenchmark* pSetupTimer = new CBenchmark(true);
+	bool bMapIndexed = false;
+	if (sMapFile.length() > 0 && mapUsesVector) {
+		bMapIndexed = this->indexVectorMap(sMapFile, sMapLayer, sMapField);
+	} else if (sMapFile.length() > 0) {
 		pMapFile = new CCSVDataset(sMapFile);
-		pMapFile->readFile();
+		if (pMapFile->readFile())
+			bMapIndexed = this->indexMap(pMapFile, mapUsesCoordinates);
+		delete pMapFile;
+		pMapFile = NULL;
 	}
 
 	// ---
@@ -157,8 +347,8 @@ bool CBoundaryMap::setupFromConfig(XMLElement* pConfiguration) {
 			if (pNewBoundary == NULL || !pNewBoundary->setupFromConfig(pTimeSeriesElement, sSourceDir)) {
 				model::doError("Encountered an error loading a boundary definition.", model::errorCodes::kLevelWarning);
 			} else {
-				if (pMapFile != NULL)
-					pNewBoundary->importMap(pMapFile, mapUsesCoordinates);
+				if (bMapIndexed)
+					pNewBoundary->importMapCells(this);
 			}
 
 			// Store the new boundary in the unordered map
@@ -223,11 +413,144 @@ bool CBoundaryMap::setupFromConfig(XMLElement* pConfiguration) {
 		delete cBoundaryType;
 	}
 
-	delete pMapFile;
+	pSetupTimer->finish();
+	pManager->log->writeLine("Boundary setup for " + toString(mapBoundaries.size()) + " boundaries took " +
+							 toString(pSetupTimer->getMetrics()->dMilliseconds) + "ms.");
+	delete pSetupTimer;
 
 	return true;
 }
 
+/*
+ *  Parse a map file (x, y[, name]) once into cells indexed by boundary name
+ */
+bool CBoundaryMap::indexMap(CCSVDataset* pCSV, bool bRealCoordinates) {
+	bool bInvalidEntries = false;
+	bool bProcessedHeaders = false;
+
+	this->mapCells.clear();
+
+	if (!pCSV->isReady())
+		return false;
+
+	CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
+
+	if (pDomain->isRemote())
+		return false;
+
+	double dCornerN, dCornerE, dCornerS, dCornerW, dResolution;
+	pDomain->getCellResolution(&dResolution);
+	pDomain->getRealExtent(&dCornerN, &dCornerE, &dCornerS, &dCornerW);
+	double dCols = static_cast<double>(pDomain->getCols());
+	double dRows = static_cast<double>(pDomain->getRows());
+
+	this->mapCells.reserve(pCSV->getLength());
+
+	for (vector<vector<std::string>>::const_iterator it = pCSV->begin(); it != pCSV->end(); it++) {
+		// TODO: Check if there are headers first... first time should be zero
+		if (!bProcessedHeaders) {
+			bProcessedHeaders = true;
+			continue;
+		}
+
+		if (it->size() != 2 && it->size() != 3) {
+			bInvalidEntries = true;
+			continue;
+		}
+
+		char *cEndX, *cEndY;
+		double dX = std::strtod((*it)[0].c_str(), &cEndX);
+		double dY = std::strtod((*it)[1].c_str(), &cEndY);
+		if (cEndX == (*it)[0].c_str() || cEndY == (*it)[1].c_str() || *cEndX != '\0' || *cEndY != '\0') {
+			bInvalidEntries = true;
+			continue;
+		}
+
+		// Indices must be whole numbers
+		if (!bRealCoordinates && (dX != floor(dX) || dY != floor(dY))) {
+			bInvalidEntries = true;
+			continue;
+		}
+
+		if (bRealCoordinates) {
+			dX = floor((dX - dCornerW) / dResolution);
+			dY = floor((dY - dCornerS) / dResolution);
+		}
+
+		// The boundary kernels don't check bounds, so every cell must be in the domain
+		if (dX < 0.0 || dY < 0.0 || dX >= dCols || dY >= dRows) {
+			bInvalidEntries = true;
+			continue;
+		}
+
+		sMapCell pCell;
+		pCell.uiCellX = static_cast<cl_uint>(dX);
+		pCell.uiCellY = static_cast<cl_uint>(dY);
+
+		// Rows without a name apply to every cell boundary
+		this->mapCells.insert(mapCells_t::value_type(it->size() == 3 ? (*it)[2] : std::string(), pCell));
+	}
+
+	if (bInvalidEntries) {
+		model::doError("Some CSV entries were not valid for a boundary map file.", model::errorCodes::kLevelWarning);
+	}
+
+	pManager->log->writeLine("Indexed " + toString(this->mapCells.size()) + " cells from the boundary map file.");
+
+	return true;
+}
+
+/*
+ *  Rasterise a vector map file once into cells indexed by the boundary name held in a field
+ */
+bool CBoundaryMap::indexVectorMap(std::string sFilename, std::string sLayer, std::string sField) {
+	CVectorDataset::mapFeatureCells_t mapFeatureCells;
+
+	this->mapCells.clear();
+
+	CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
+
+	if (pDomain->isRemote())
+		return false;
+
+	CVectorDataset* pVectorFile = new CVectorDataset();
+	if (!pVectorFile->openFileRead(sFilename, sLayer) ||
+		!pVectorFile->rasteriseByFieldForDomain(pDomain, sField, &mapFeatureCells)) {
+		model::doError("Could not read the boundary vector map file.", model::errorCodes::kLevelWarning);
+		delete pVectorFile;
+		return false;
+	}
+	delete pVectorFile;
+
+	unsigned long ulCols = pDomain->getCols();
+	for (CVectorDataset::mapFeatureCells_t::const_iterator it = mapFeatureCells.begin(); it != mapFeatureCells.end(); it++) {
+		for (std::vector<unsigned long>::const_iterator itCell = it->second.begin(); itCell != it->second.end(); itCell++) {
+			sMapCell pCell;
+			pCell.uiCellX = *itCell % ulCols;
+			pCell.uiCellY = *itCell / ulCols;
+			this->mapCells.insert(mapCells_t::value_type(it->first, pCell));
+		}
+	}
+
+	pManager->log->writeLine("Indexed " + toString(this->mapCells.size()) + " cells from the boundary vector map file.");
+
+	return true;
+}
+
+/*
+ *  Cells in the map file for a named boundary
+ */
+CBoundaryMap::mapCellRange_t CBoundaryMap::getMapCells(std::string sName) {
+	return this->mapCells.equal_range(sName);
+}
+
+/*
+ *  Treatment applied to one of the domain edges
+ */
+unsigned char CBoundaryMap::getEdgeTreatment(unsigned char ucEdge) {
+	return this->ucBoundaryTreatment[ucEdge];
+}
+
 /*
  *  Adjust cell bed elevations as necessary etc. around the boundaries
  */
@@ -27,6 +27,7 @@
 #include "../OpenCL/Executors/COCLProgram.h"
 
 using boost::unordered_map;
+using boost::unordered_multimap;
 
 // Class stubs
 class CBoundary;
@@ -46,19 +47,40 @@ public:
 	CBoundary*						getBoundaryByName( std::string );
 
 	void							prepareBoundaries( COCLProgram*, COCLBuffer*, COCLBuffer*, COCLBuffer*, COCLBuffer*, COCLBuffer* );
-	void							applyBoundaries( COCLBuffer* );
+	unsigned int					applyBoundaries( COCLBuffer*, bool = true );
 	void							streamBoundaries( double );
+	double							getNextActiveTime( double );
+	CBoundary*						fuseBoundary( unsigned char );
 
 	unsigned int					getBoundaryCount();
 	void							applyDomainModifications();
+	unsigned char					getEdgeTreatment( unsigned char );
+
+	struct sMapCell
+	{
+		cl_uint			uiCellX;
+		cl_uint			uiCellY;
+	};
+
+	typedef unordered_multimap<std::string, sMapCell> mapCells_t;
+	typedef std::pair<mapCells_t::const_iterator, mapCells_t::const_iterator> mapCellRange_t;
+
+	mapCellRange_t					getMapCells( std::string );
 
 private:	
 	
 	typedef unordered_map<std::string, CBoundary*> mapBoundaries_t;
 
+	bool							indexMap( CCSVDataset*, bool );
+	bool							indexVectorMap( std::string, std::string, std::string );
+	void							indexConflicts();
+
 	CDomain*						pDomain;
 	unsigned char					ucBoundaryTreatment[4];
 	mapBoundaries_t					mapBoundaries;
+	mapCells_t						mapCells;								// Map file cells by boundary name (unnamed rows apply to all)
+	std::vector<CBoundary*>			vecApplyOrder;							// Boundaries in the order their kernels are scheduled
+	std::vector<std::vector<unsigned int>>	vecConflicts;					// Earlier boundaries in the order writing the same cells
 
 };
 
@@ -17,11 +17,13 @@
  *
  */
 #include <vector>
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 
 #include "CBoundaryMap.h"
 #include "CBoundarySimplePipe.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
+#include "../Datasets/CVectorDataset.h"
 #include "../OpenCL/Executors/COCLBuffer.h"
 #include "../OpenCL/Executors/COCLKernel.h"
 #include "../common.h"
@@ -64,7 +66,10 @@ bool CBoundarySimplePipe::setupFromConfig(XMLElement* pElement, std::string sBou
 		 *cBoundaryDiameter,
 		 *cBoundaryInvertStart,
 		 *cBoundaryInvertEnd,
-		 *cBoundaryFlipY;
+		 *cBoundaryFlipY,
+		 *cBoundaryVector,
+		 *cBoundaryVectorLayer,
+		 *cBoundaryVectorField;
 
 	Util::toLowercase(&cBoundaryType,			pElement->Attribute("type"));
 	Util::toNewString(&cBoundaryName,			pElement->Attribute("name"));
@@ -80,9 +85,32 @@ bool CBoundarySimplePipe::setupFromConfig(XMLElement* pElement, std::string sBou
 	Util::toLowercase(&cBoundaryStartY,			pElement->Attribute("startY"));
 	Util::toLowercase(&cBoundaryEndX,			pElement->Attribute("endX"));
 	Util::toLowercase(&cBoundaryEndY,			pElement->Attribute("endY"));
+	Util::toNewString(&cBoundaryVector,			pElement->Attribute("vectorFile"));
+	Util::toNewString(&cBoundaryVectorLayer,	pElement->Attribute("vectorLayer"));
+	Util::toNewString(&cBoundaryVectorField,	pElement->Attribute("vectorField"));
 
 	this->sName				= std::string( cBoundaryName );
-	this->length			= boost::lexical_cast<double>(cBoundaryPipeLength);
+
+	// Pipe alignment from a line feature, optionally only the one whose field matches this boundary's name
+	double dVectorStartX, dVectorStartY, dVectorEndX, dVectorEndY, dVectorLength;
+	bool bVectorLine = false;
+	if (cBoundaryVector != NULL) {
+		CVectorDataset* pVectorFile = new CVectorDataset();
+		bVectorLine = pVectorFile->openFileRead(sBoundarySourceDir + std::string(cBoundaryVector), cBoundaryVectorLayer == NULL ? "" : std::string(cBoundaryVectorLayer)) &&
+					  pVectorFile->getLineEndpoints(cBoundaryVectorField == NULL ? "" : std::string(cBoundaryVectorField), this->sName,
+													&dVectorStartX, &dVectorStartY, &dVectorEndX, &dVectorEndY, &dVectorLength);
+		delete pVectorFile;
+
+		if (!bVectorLine) {
+			model::doError(
+				"Could not find a line for the pipe in the boundary vector file.",
+				model::errorCodes::kLevelModelStop
+			);
+			return false;
+		}
+	}
+
+	this->length			= (bVectorLine && cBoundaryPipeLength == NULL) ? dVectorLength : boost::lexical_cast<double>(cBoundaryPipeLength);
 	this->roughness			= boost::lexical_cast<double>(cBoundaryRoughness);
 	this->diameter			= boost::lexical_cast<double>(cBoundaryDiameter);
 
@@ -125,13 +153,16 @@ bool CBoundarySimplePipe::setupFromConfig(XMLElement* pElement, std::string sBou
 	pDomain->getCellResolution(&dResolution);
 	pDomain->getRealExtent(&dCornerN, &dCornerE, &dCornerS, &dCornerW);
 
-	double startX			= boost::lexical_cast<double>(cBoundaryStartX);
-	double startY			= boost::lexical_cast<double>(cBoundaryStartY);
+	double startX			= bVectorLine ? dVectorStartX : boost::lexical_cast<double>(cBoundaryStartX);
+	double startY			= bVectorLine ? dVectorStartY : boost::lexical_cast<double>(cBoundaryStartY);
 
 	this->startCellX = floor((startX - dCornerW) / dResolution);
 	this->startCellY = floor((startY - dCornerS) / (dResolution * ry));
 
-	if (cBoundaryEndX != NULL && cBoundaryEndY != NULL) {
+	if (bVectorLine) {
+		this->endCellX = floor((dVectorEndX - dCornerW) / dResolution);
+		this->endCellY = floor((dVectorEndY - dCornerS) / (dResolution * ry));
+	} else if (cBoundaryEndX != NULL && cBoundaryEndY != NULL) {
 		double endX = boost::lexical_cast<double>(cBoundaryEndX);
 		double endY = boost::lexical_cast<double>(cBoundaryEndY);
 		this->endCellX = floor((endX - dCornerW) / dResolution);
@@ -284,6 +315,21 @@ void CBoundarySimplePipe::applyBoundary(COCLBuffer* pBufferCell)
 	this->oclKernel->scheduleExecution();
 }
 
+/*
+ *	Cells written by the boundary kernel, i.e. both ends of the pipe
+ */
+bool CBoundarySimplePipe::getFootprint(std::vector<cl_ulong>* pCells)
+{
+	CDomainCartesian* pDomainCart = static_cast<CDomainCartesian*>(this->pDomain);
+
+	pCells->clear();
+	pCells->push_back(pDomainCart->getCellID(this->startCellX, this->startCellY));
+	pCells->push_back(pDomainCart->getCellID(this->endCellX, this->endCellY));
+	std::sort(pCells->begin(), pCells->end());
+
+	return true;
+}
+
 void CBoundarySimplePipe::streamBoundary(double dTime)
 {
 	// ...
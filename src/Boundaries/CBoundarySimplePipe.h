@@ -34,6 +34,7 @@ public:
 	virtual void					applyBoundary(COCLBuffer*);
 	virtual void					streamBoundary(double);
 	virtual void					cleanBoundary();
+	virtual bool					getFootprint( std::vector<cl_ulong>* );
 	virtual void					importMap(CCSVDataset*);
 
 protected:	
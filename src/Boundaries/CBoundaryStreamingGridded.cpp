@@ -45,6 +45,8 @@ CBoundaryStreamingGridded::CBoundaryStreamingGridded(CDomain* pDomain) {
 	this->pBufferConfiguration = NULL;
 	this->pBufferValues = NULL;
 	this->uiTimeseriesLength = 0;
+	this->pFrameSource = NULL;
+	this->uiFirstBand = 1;
 
 	this->pDomain = pDomain;
 }
@@ -54,6 +56,7 @@ CBoundaryStreamingGridded::CBoundaryStreamingGridded(CDomain* pDomain) {
  */
 CBoundaryStreamingGridded::~CBoundaryStreamingGridded() {
 	delete this->buffer;
+	delete this->pFrameSource;
 	delete this->pTransform;
 	delete this->pBufferConfiguration;
 	delete this->pBufferValues;
@@ -63,7 +66,8 @@ CBoundaryStreamingGridded::~CBoundaryStreamingGridded() {
  *	Configure this boundary and load in any related files
  */
 bool CBoundaryStreamingGridded::setupFromConfig(XMLElement* pElement, std::string sBoundarySourceDir) {
-	char *cBoundaryType, *cBoundaryName, *cBoundaryMask, *cBoundaryInterval, *cBoundaryValue;
+	char *cBoundaryType, *cBoundaryName, *cBoundaryMask, *cBoundaryInterval, *cBoundaryValue, *cBoundarySource, *cBoundaryVariable,
+		*cBoundaryFirstBand;
 	double dInterval = 0.0;
 
 	Util::toLowercase(&cBoundaryType, pElement->Attribute("type"));
@@ -71,6 +75,9 @@ bool CBoundaryStreamingGridded::setupFromConfig(XMLElement* pElement, std::strin
 	Util::toNewString(&cBoundaryMask, pElement->Attribute("mask"));
 	Util::toLowercase(&cBoundaryInterval, pElement->Attribute("interval"));
 	Util::toLowercase(&cBoundaryValue, pElement->Attribute("value"));
+	Util::toNewString(&cBoundarySource, pElement->Attribute("source"));
+	Util::toNewString(&cBoundaryVariable, pElement->Attribute("variable"));
+	Util::toLowercase(&cBoundaryFirstBand, pElement->Attribute("firstBand"));
 
 	// Must have unique name for each boundary (will get autoname by default)
 	this->sName = std::string(cBoundaryName);
@@ -104,6 +111,27 @@ bool CBoundaryStreamingGridded::setupFromConfig(XMLElement* pElement, std::strin
 	this->dTimeseriesInterval = dInterval;
 	this->dTimeseriesLength = pManager->getSimulationLength();
 
+	// A single multi-frame file stays open and frames are read by band as the simulation reaches them
+	if (cBoundarySource != NULL) {
+		this->pFrameSource =
+			CBoundaryGridded::openFrameSource(sBoundarySourceDir, cBoundarySource, cBoundaryVariable, cBoundaryFirstBand, &this->uiFirstBand);
+		if (this->pFrameSource == NULL)
+			return false;
+
+		unsigned int uiFrames = this->pFrameSource->getBandCount() - this->uiFirstBand + 1;
+		if (uiFrames < this->uiTimeseriesLength) {
+			model::doError("Gridded boundary frames missing after " + Util::secondsToTime(uiFrames * dInterval) + " in '" +
+							   std::string(cBoundarySource) + "'",
+						   model::errorCodes::kLevelWarning);
+			this->uiTimeseriesLength = uiFrames;
+			this->dTimeseriesLength = min(this->dTimeseriesLength, uiFrames * dInterval);
+		}
+
+		this->pTransform = this->pFrameSource->createTransformationForDomain(static_cast<CDomainCartesian*>(this->pDomain));
+
+		return true;
+	}
+
 	// Deal with the gridded files...
 	unsigned long ulEntry = 0;
 	for (double dTime = 0.0; dTime <= pManager->getSimulationLength(); dTime += dInterval) {
@@ -251,7 +279,7 @@ void CBoundaryStreamingGridded::streamBoundary(double dTime) {
 
 	// ...
 	// TODO: Should we handle all the memory buffer writing in here?...
-	unsigned int t = min(static_cast<unsigned int>(floor(dTime / dTimeseriesInterval)), this->uiTimeseriesLength);
+	unsigned int t = min(static_cast<unsigned int>(floor(dTime / dTimeseriesInterval)), this->uiTimeseriesLength - 1);
 	//__private cl_ulong ulTimestep = (cl_ulong)floor( dLclTime / pConfig.TimeseriesInterval );
 	//if ( ulTimestep >= pConfig.TimeseriesEntries ) ulTimestep = pConfig.TimeseriesEntries;
 	if(this->currentSeriesStep > 0x7FFFFFFF) std::cout << "DEBUG SGB bootstrap css: " << this->currentSeriesStep << " t: " << t << " dTime: " << dTime << " dTimeseriesInterval: " << dTimeseriesInterval << std::endl;
@@ -259,11 +287,16 @@ void CBoundaryStreamingGridded::streamBoundary(double dTime) {
 	std::cout << "DEBUG SGB initiate streaming # css: " << this->currentSeriesStep << " t: " << t << " dTime: " << dTime << " dTimeseriesInterval: " << dTimeseriesInterval  << std::endl;
 	this->currentSeriesStep = t;
 
-	// Load the raster...
-	CRasterDataset* pRaster = new CRasterDataset();
-	pRaster->openFileRead(this->sFilenames[t]);
-	this->buffer = new CBoundaryStreamingGriddedEntry(dTime, pRaster->createArrayForBoundary(pTransform));
-	delete pRaster;
+	// Load the raster, or the next band of the open multi-frame file...
+	delete this->buffer;
+	if (this->pFrameSource != NULL) {
+		this->buffer = new CBoundaryStreamingGriddedEntry(dTime, this->pFrameSource->createArrayForBoundary(pTransform, this->uiFirstBand + t));
+	} else {
+		CRasterDataset* pRaster = new CRasterDataset();
+		pRaster->openFileRead(this->sFilenames[min(t, static_cast<unsigned int>(this->sFilenames.size()) - 1)]);
+		this->buffer = new CBoundaryStreamingGriddedEntry(dTime, pRaster->createArrayForBoundary(pTransform));
+		delete pRaster;
+	}
 
 	if (this->singlePrecision) {
 		std::cout << "DEBUG SGB SINGLE" << std::endl;
@@ -287,8 +320,8 @@ void CBoundaryStreamingGridded::streamBoundary(double dTime) {
 		}
 		if(!debug_check) std::cout << "DEBUG SGB non-zero data check FAILED" << std::endl;
 
+		// Double precision data is still owned by the entry
 		std::memcpy(&((this->pBufferValues->getHostBlock<cl_uchar*>())[0]), pGridData, size);
-		delete[] pGridData;
 	}
 	this->pBufferValues->queueWriteAll();
 }
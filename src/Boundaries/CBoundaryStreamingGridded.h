@@ -35,6 +35,7 @@ class CBoundaryStreamingGridded : public CBoundary {
 	virtual void applyBoundary(COCLBuffer*);
 	virtual void streamBoundary(double);
 	virtual void cleanBoundary();
+	virtual bool isHydrological() { return true; };
 
 	/*
 	struct SBoundaryGridTransform {
@@ -96,6 +97,8 @@ class CBoundaryStreamingGridded : public CBoundary {
 	unsigned int uiTimeseriesLength;
 
 	std::vector<std::string> sFilenames;
+	CRasterDataset* pFrameSource;  // Multi-frame file kept open while streaming
+	unsigned int uiFirstBand;
 
 	// COCLBuffer*				pBufferTimeseries;
 	COCLBuffer* pBufferValues;
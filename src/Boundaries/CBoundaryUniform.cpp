@@ -22,11 +22,13 @@
 #include "CBoundaryMap.h"
 #include "CBoundaryUniform.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
+#include "../Datasets/CXMLDataset.h"
 #include "../OpenCL/Executors/COCLBuffer.h"
 #include "../OpenCL/Executors/COCLKernel.h"
 #include "../common.h"
 
 using std::vector;
+using std::max;
 
 /*
  *  Constructor
@@ -36,6 +38,12 @@ CBoundaryUniform::CBoundaryUniform( CDomain* pDomain )
 	this->ucValue = model::boundaries::uniformValues::kValueLossRate;
 	this->pDomain = pDomain;
 	this->dRatio  = 1.0;
+
+	this->pTimeseries = NULL;
+	this->uiTimeseriesLength = 0;
+	this->uiTimeseriesCapacity = 0;
+	this->pBufferConfiguration = NULL;
+	this->pBufferTimeseries = NULL;
 }
 
 /*
@@ -53,13 +61,14 @@ CBoundaryUniform::~CBoundaryUniform()
 */
 bool CBoundaryUniform::setupFromConfig(XMLElement* pElement, std::string sBoundarySourceDir)
 {
-	char *cBoundaryType, *cBoundaryName, *cBoundarySource, *cBoundaryValue, *cBoundaryRatio;
+	char *cBoundaryType, *cBoundaryName, *cBoundarySource, *cBoundaryValue, *cBoundaryRatio, *cBoundaryCapacity;
 
 	Util::toLowercase(&cBoundaryType, pElement->Attribute("type"));
 	Util::toNewString(&cBoundaryName, pElement->Attribute("name"));
 	Util::toLowercase(&cBoundarySource, pElement->Attribute("source"));
 	Util::toLowercase(&cBoundaryValue, pElement->Attribute("value"));
 	Util::toLowercase(&cBoundaryRatio, pElement->Attribute("effectiveRunoffPercentage"));
+	Util::toNewString(&cBoundaryCapacity, pElement->Attribute("maxEntries"));
 
 	// Must have unique name for each boundary (will get autoname by default)
 	this->sName = std::string(cBoundaryName);
@@ -70,6 +79,19 @@ bool CBoundaryUniform::setupFromConfig(XMLElement* pElement, std::string sBounda
 		pManager->log->writeLine("Effective runoff ratio is set at " + toString(this->dRatio));
 	}
 
+	// Leave room in the device buffer for longer replacement timeseries
+	if (cBoundaryCapacity != NULL) {
+		if (CXMLDataset::isValidUnsignedInt(std::string(cBoundaryCapacity))) {
+			this->uiTimeseriesCapacity = boost::lexical_cast<unsigned int>(cBoundaryCapacity);
+		} else {
+			model::doError(
+				"Maximum timeseries entries must be a whole number.",
+				model::errorCodes::kLevelWarning
+			);
+		}
+		delete[] cBoundaryCapacity;
+	}
+
 	// Volume increase column represents...
 	if (cBoundaryValue == NULL || strcmp(cBoundaryValue, "rain-intensity") == 0) {
 		this->setValue(model::boundaries::uniformValues::kValueRainIntensity);
@@ -201,8 +223,58 @@ void CBoundaryUniform::prepareBoundary(
 		COCLBuffer* pBufferTimestep
 	)
 {
+	this->ucFloatForm = pProgram->getFloatForm();
+	this->uiTimeseriesCapacity = max(this->uiTimeseriesCapacity, this->uiTimeseriesLength);
+
 	// Configuration for the boundary and timeseries data
-	if (pProgram->getFloatForm() == model::floatPrecision::kSingle)
+	this->pBufferConfiguration = new COCLBuffer(
+		"Bdy_" + this->sName + "_Conf",
+		pProgram,
+		true,
+		true,
+		this->ucFloatForm == model::floatPrecision::kSingle ? sizeof(sConfigurationSP) : sizeof(sConfigurationDP),
+		true
+	);
+	this->pBufferTimeseries = new COCLBuffer(
+		"Bdy_" + this->sName + "_Series",
+		pProgram,
+		true,
+		true,
+		(this->ucFloatForm == model::floatPrecision::kSingle ? sizeof(cl_float2) : sizeof(cl_double2)) * this->uiTimeseriesCapacity,
+		true
+	);
+	this->fillBuffers();
+
+	this->pBufferConfiguration->createBuffer();
+	this->pBufferConfiguration->queueWriteAll();
+	this->pBufferTimeseries->createBuffer();
+	this->pBufferTimeseries->queueWriteAll();
+
+	this->oclKernel = pProgram->getKernel("bdy_Uniform");
+	COCLBuffer* aryArgsBdy[] = {
+		pBufferConfiguration,
+		pBufferTimeseries,
+		pBufferTime,
+		pBufferTimestep,
+		pBufferTimeHydrological,
+		NULL,	// Cell states
+		pBufferBed,
+		pBufferManning
+	};
+	this->oclKernel->assignArguments(aryArgsBdy);
+
+	// TODO: Need a more sensible group size!
+	CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
+	this->oclKernel->setGlobalSize(ceil(pDomain->getCols() / 8) * 8, ceil(pDomain->getRows() / 8) * 8);
+	this->oclKernel->setGroupSize(8, 8);
+}
+
+/*
+ *	Copy the configuration and timeseries into the host blocks of the buffers
+ */
+void CBoundaryUniform::fillBuffers()
+{
+	if (this->ucFloatForm == model::floatPrecision::kSingle)
 	{
 		sConfigurationSP pConfiguration;
 
@@ -211,28 +283,12 @@ void CBoundaryUniform::prepareBoundary(
 		pConfiguration.TimeseriesLength = this->dTimeseriesLength;
 		pConfiguration.Definition = (cl_uint)this->ucValue;
 
-		this->pBufferConfiguration = new COCLBuffer(
-			"Bdy_" + this->sName + "_Conf",
-			pProgram,
-			true,
-			true,
-			sizeof(sConfigurationSP),
-			true
-		);
 		std::memcpy(
 			this->pBufferConfiguration->getHostBlock<void*>(),
 			&pConfiguration,
 			sizeof(sConfigurationSP)
 		);
 
-		this->pBufferTimeseries = new COCLBuffer(
-			"Bdy_" + this->sName + "_Series",
-			pProgram,
-			true,
-			true,
-			sizeof(cl_float2)* this->uiTimeseriesLength,
-			true
-		);
 		cl_float2 *pTimeseries = this->pBufferTimeseries->getHostBlock<cl_float2*>();
 		for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
 		{
@@ -247,28 +303,12 @@ void CBoundaryUniform::prepareBoundary(
 		pConfiguration.TimeseriesLength = this->dTimeseriesLength;
 		pConfiguration.Definition = (cl_uint)this->ucValue;
 
-		this->pBufferConfiguration = new COCLBuffer(
-			"Bdy_" + this->sName + "_Conf",
-			pProgram,
-			true,
-			true,
-			sizeof(sConfigurationDP),
-			true
-		);
 		std::memcpy(
 			this->pBufferConfiguration->getHostBlock<void*>(),
 			&pConfiguration,
 			sizeof(sConfigurationDP)
 		);
 
-		this->pBufferTimeseries = new COCLBuffer(
-			"Bdy_" + this->sName + "_Series",
-			pProgram,
-			true,
-			true,
-			sizeof(cl_double2)* this->uiTimeseriesLength,
-			true
-		);
 		cl_double2 *pTimeseries = this->pBufferTimeseries->getHostBlock<cl_double2*>();
 		for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
 		{
@@ -276,29 +316,65 @@ void CBoundaryUniform::prepareBoundary(
 			pTimeseries[i].s[1] = this->pTimeseries[i].dComponent;
 		}
 	}
+}
 
-	this->pBufferConfiguration->createBuffer();
+/*
+ *	Swap in a new timeseries without recreating the buffers, which may
+ *	already be bound into a scheme kernel when the boundary is fused, or only
+ *	check that it would be accepted
+ */
+bool CBoundaryUniform::replaceTimeseries(std::string sSource, bool bApply)
+{
+	if (this->pBufferTimeseries == NULL)
+		return false;
+
+	CCSVDataset* pCSVFile = new CCSVDataset(sSource);
+	if (!pCSVFile->readFile() || !pCSVFile->isReady())
+	{
+		model::doError(
+			"Could not read a replacement timeseries for boundary '" + this->sName + "'.",
+			model::errorCodes::kLevelWarning
+		);
+		delete pCSVFile;
+		return false;
+	}
+
+	sTimeseriesUniform*	pPrevious		= this->pTimeseries;
+	unsigned int		uiPrevious		= this->uiTimeseriesLength;
+	double				dPrevInterval	= this->dTimeseriesInterval;
+	double				dPrevLength		= this->dTimeseriesLength;
+
+	this->uiTimeseriesLength = 0;
+	this->importTimeseries(pCSVFile);
+	delete pCSVFile;
+
+	// Entries must fit the buffer allocated when the boundary was prepared
+	bool bValid = ( this->uiTimeseriesLength >= 2 );
+	if (this->uiTimeseriesLength > this->uiTimeseriesCapacity)
+	{
+		model::doError(
+			"Replacement timeseries for boundary '" + this->sName + "' has more than " +
+			toString(this->uiTimeseriesCapacity) + " entries. Raise maxEntries to allow it.",
+			model::errorCodes::kLevelWarning
+		);
+		bValid = false;
+	}
+	if (!bValid || !bApply)
+	{
+		delete[] this->pTimeseries;
+		this->pTimeseries = pPrevious;
+		this->uiTimeseriesLength = uiPrevious;
+		this->dTimeseriesInterval = dPrevInterval;
+		this->dTimeseriesLength = dPrevLength;
+		return bValid;
+	}
+	delete[] pPrevious;
+
+	this->fillBuffers();
 	this->pBufferConfiguration->queueWriteAll();
-	this->pBufferTimeseries->createBuffer();
 	this->pBufferTimeseries->queueWriteAll();
 
-	this->oclKernel = pProgram->getKernel("bdy_Uniform");
-	COCLBuffer* aryArgsBdy[] = {
-		pBufferConfiguration,
-		pBufferTimeseries,
-		pBufferTime,
-		pBufferTimestep,
-		pBufferTimeHydrological,
-		NULL,	// Cell states
-		pBufferBed,
-		pBufferManning
-	};
-	this->oclKernel->assignArguments(aryArgsBdy);
-
-	// TODO: Need a more sensible group size!
-	CDomainCartesian* pDomain = static_cast<CDomainCartesian*>(this->pDomain);
-	this->oclKernel->setGlobalSize(ceil(pDomain->getCols() / 8) * 8, ceil(pDomain->getRows() / 8) * 8);
-	this->oclKernel->setGroupSize(8, 8);
+	return true;
 }
 
 void CBoundaryUniform::applyBoundary(COCLBuffer* pBufferCell)
@@ -316,3 +392,24 @@ void CBoundaryUniform::cleanBoundary()
 {
 	// ...
 }
+
+/*
+ *	Earliest time from which rainfall will be added (losses never add water)
+ */
+double CBoundaryUniform::getNextActiveTime(double dTime)
+{
+	if (this->ucValue != model::boundaries::uniformValues::kValueRainIntensity)
+		return pManager->getSimulationLength();
+
+	// Each entry holds for one interval
+	for (unsigned int i = 0; i < this->uiTimeseriesLength; ++i)
+	{
+		if (this->pTimeseries[i].dTime + this->dTimeseriesInterval <= dTime ||
+			this->pTimeseries[i].dTime >= this->dTimeseriesLength)
+			continue;
+		if (this->pTimeseries[i].dComponent > 0.0)
+			return max(dTime, this->pTimeseries[i].dTime);
+	}
+
+	return pManager->getSimulationLength();
+}
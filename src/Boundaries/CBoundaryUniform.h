@@ -34,6 +34,12 @@ public:
 	virtual void					applyBoundary(COCLBuffer*);
 	virtual void					streamBoundary(double);
 	virtual void					cleanBoundary();
+	virtual double					getNextActiveTime(double);
+	virtual unsigned char			getFusableType()					{ return model::boundaries::fusableTypes::kFusableUniform; };
+	virtual COCLBuffer*				getConfigurationBuffer()			{ return pBufferConfiguration; };
+	virtual COCLBuffer*				getTimeseriesBuffer()				{ return pBufferTimeseries; };
+	virtual bool					isHydrological()					{ return true; };
+	virtual bool					replaceTimeseries(std::string, bool = true);
 
 protected:
 
@@ -59,6 +65,7 @@ protected:
 
 	void							setValue(unsigned char a)			{ ucValue = a; };
 	void							importTimeseries(CCSVDataset*);
+	void							fillBuffers();
 
 	unsigned char					ucValue;
 
@@ -69,6 +76,8 @@ protected:
 
 	sTimeseriesUniform*				pTimeseries;
 	unsigned int					uiTimeseriesLength;
+	unsigned int					uiTimeseriesCapacity;
+	unsigned char					ucFloatForm;
 
 	COCLBuffer*						pBufferTimeseries;
 	COCLBuffer*						pBufferConfiguration;
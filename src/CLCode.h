@@ -54,6 +54,8 @@ inline std::string getOCLResourceFilename( std::string sID )
 
 	if ( strcmp( cID, "CLSchemeInertial_H" ) == 0 )
 		return sBaseDir + "Schemes/CLSchemeInertial.clh";
+	if ( strcmp( cID, "CLSchemeCellularAutomata_H" ) == 0 )
+		return sBaseDir + "Schemes/CLSchemeCellularAutomata.clh";
 
 	if ( strcmp( cID, "CLSolverHLLC_H" ) == 0 )
 		return sBaseDir + "Solvers/CLSolverHLLC.clh";
@@ -73,6 +75,9 @@ inline std::string getOCLResourceFilename( std::string sID )
 	if ( strcmp( cID, "CLVerifyDataStructure_C" ) == 0 )
 		return sBaseDir + "OpenCL/Executors/CLVerifyDataStructure.clc";
 
+	if ( strcmp( cID, "CLDeviceProbe_C" ) == 0 )
+		return sBaseDir + "OpenCL/Executors/CLDeviceProbe.clc";
+
 	if ( strcmp( cID, "CLFriction_C" ) == 0 )
 		return sBaseDir + "Schemes/CLFriction.clc";
 
@@ -84,6 +89,8 @@ inline std::string getOCLResourceFilename( std::string sID )
 
 	if ( strcmp( cID, "CLSchemeInertial_C" ) == 0 )
 		return sBaseDir + "Schemes/CLSchemeInertial.clc";
+	if ( strcmp( cID, "CLSchemeCellularAutomata_C" ) == 0 )
+		return sBaseDir + "Schemes/CLSchemeCellularAutomata.clc";
 
 	if ( strcmp( cID, "CLSolverHLLC_C" ) == 0 )
 		return sBaseDir + "Solvers/CLSolverHLLC.clc";
@@ -20,6 +20,9 @@
 // Includes
 #include <cmath>
 #include <math.h>
+#include <chrono>
+#include <algorithm>
+#include <boost/filesystem.hpp>
 #include "common.h"
 #include "main.h"
 #include "OpenCL/Executors/CExecutorControlOpenCL.h"
@@ -28,6 +31,10 @@
 #include "Schemes/CScheme.h"
 #include "Datasets/CXMLDataset.h"
 #include "Datasets/CRasterDataset.h"
+#include "Datasets/CVectorDataset.h"
+#include "Domain/Cartesian/CDomainCartesian.h"
+#include "Boundaries/CBoundaryMap.h"
+#include "Boundaries/CBoundary.h"
 #include "MPI/CMPIManager.h"
 
 #include "OpenCL/cl_error.h"
@@ -59,6 +66,8 @@ CModel::CModel(void)
 	this->pProgressCoords.sY = -1;
 
 	this->ulRealTimeStart = 0;
+	this->bSchedulerSignal = false;
+	this->bBranching = false;
 }
 
 /*
@@ -132,6 +141,84 @@ void CModel::setupFromConfig( XMLElement* pXNode )
 
 		pParameter = pParameter->NextSiblingElement( "parameter" );
 	}
+
+	// Intervention scenarios branched from the baseline run
+	XMLElement		*pScenario			= pXNode->FirstChildElement( "scenario" );
+	while ( pScenario != NULL )
+	{
+		sScenario		pNewScenario;
+		XMLElement		*pModification	= pScenario->FirstChildElement( "modification" );
+		char			*cName = NULL, *cTime = NULL, *cSourceDir = NULL;
+		std::string		sSourceDir;
+
+		Util::toNewString( &cName,		pScenario->Attribute( "name" ) );
+		Util::toNewString( &cTime,		pScenario->Attribute( "time" ) );
+		Util::toNewString( &cSourceDir,	pScenario->Attribute( "sourceDir" ) );
+
+		if ( cName == NULL || ( cTime != NULL && !CXMLDataset::isValidFloat( cTime ) ) )
+		{
+			model::doError(
+				"Scenario has no name or an invalid intervention time.",
+				model::errorCodes::kLevelWarning
+			);
+			pScenario = pScenario->NextSiblingElement( "scenario" );
+			continue;
+		}
+
+		pNewScenario.sName	= std::string( cName );
+		pNewScenario.dTime	= ( cTime == NULL ? 0.0 : boost::lexical_cast<double>( cTime ) );
+		sSourceDir			= ( cSourceDir == NULL || strcmp( cSourceDir, "" ) == 0 ? "./" : ( std::string( cSourceDir ) + "/" ) );
+
+		while ( pModification != NULL )
+		{
+			sScenarioModification	pNewModification;
+			char	*cDomain = NULL, *cValue = NULL, *cOperation = NULL, *cAmount = NULL,
+					*cSource = NULL, *cLayer = NULL, *cField = NULL, *cMatch = NULL;
+
+			Util::toNewString( &cDomain,	pModification->Attribute( "domain" ) );
+			Util::toLowercase( &cValue,		pModification->Attribute( "value" ) );
+			Util::toLowercase( &cOperation,	pModification->Attribute( "operation" ) );
+			Util::toNewString( &cAmount,	pModification->Attribute( "amount" ) );
+			Util::toNewString( &cSource,	pModification->Attribute( "source" ) );
+			Util::toNewString( &cLayer,		pModification->Attribute( "layer" ) );
+			Util::toNewString( &cField,		pModification->Attribute( "field" ) );
+			Util::toNewString( &cMatch,		pModification->Attribute( "match" ) );
+
+			pNewModification.ucValue	= 255;
+			if ( cValue != NULL && ( strcmp( cValue, "bedelevation" ) == 0 || strcmp( cValue, "dem" ) == 0 ) )
+				pNewModification.ucValue = model::rasterDatasets::dataValues::kBedElevation;
+			if ( cValue != NULL && strcmp( cValue, "manningcoefficient" ) == 0 )
+				pNewModification.ucValue = model::rasterDatasets::dataValues::kManningCoefficient;
+
+			if ( pNewModification.ucValue == 255 ||
+				 cAmount == NULL || !CXMLDataset::isValidFloat( cAmount ) ||
+				 ( cDomain != NULL && ( !CXMLDataset::isValidUnsignedInt( cDomain ) || boost::lexical_cast<unsigned int>( cDomain ) < 1 ) ) ||
+				 ( cOperation != NULL && strcmp( cOperation, "set" ) != 0 && strcmp( cOperation, "adjust" ) != 0 ) ||
+				 cSource == NULL || cField == NULL || cMatch == NULL )
+			{
+				model::doError(
+					"Invalid modification in scenario: " + pNewScenario.sName,
+					model::errorCodes::kLevelWarning
+				);
+				pModification = pModification->NextSiblingElement( "modification" );
+				continue;
+			}
+
+			pNewModification.uiDomain	= ( cDomain == NULL ? 0 : boost::lexical_cast<unsigned int>( cDomain ) - 1 );
+			pNewModification.bRelative	= ( cOperation != NULL && strcmp( cOperation, "adjust" ) == 0 );
+			pNewModification.dAmount	= boost::lexical_cast<double>( cAmount );
+			pNewModification.sSource	= sSourceDir + std::string( cSource );
+			pNewModification.sLayer		= ( cLayer == NULL ? "" : std::string( cLayer ) );
+			pNewModification.sField		= std::string( cField );
+			pNewModification.sMatch		= std::string( cMatch );
+			pNewScenario.vModifications.push_back( pNewModification );
+
+			pModification = pModification->NextSiblingElement( "modification" );
+		}
+
+		this->vScenarios.push_back( pNewScenario );
+		pScenario = pScenario->NextSiblingElement( "scenario" );
+	}
 }
 
 /*
@@ -243,7 +330,19 @@ bool CModel::runModel( void )
 	this->log->writeLine( "Starting a new simulation..." );
 
 	this->runModelPrepare();
+
+	// Keep the initial state so scenarios can branch from the very start
+	if ( !this->vScenarios.empty() )
+	{
+		for ( unsigned int i = 0; i < domains->getDomainCount(); ++i )
+		{
+			if ( domains->isDomainLocal(i) )
+				domains->getDomain(i)->saveSnapshot( 0.0 );
+		}
+	}
+
 	this->runModelMain();
+	this->runModelScenarios();
 
 	return true;
 }
@@ -895,6 +994,15 @@ void CModel::runModelOutputs() {
 	this->writeOutputs();
 	dLastOutputTime = this->dCurrentTime;
 
+	// Outputs leave the current state in host memory, so retain it for scenarios
+	if ( !this->vScenarios.empty() && !this->bBranching )
+	{
+		for (unsigned int i = 0; i < domains->getDomainCount(); ++i) {
+			if (domains->isDomainLocal(i))
+				domains->getDomain(i)->saveSnapshot( this->dCurrentTime );
+		}
+	}
+
 	for (unsigned int i = 0; i < domains->getDomainCount(); ++i) {
 		if (domains->isDomainLocal(i))
 			domains->getDomain(i)->getScheme()->forceTimeAdvance();
@@ -991,6 +1099,8 @@ void	CModel::runModelSchedule(CBenchmark::sPerformanceMetrics * sTotalMetrics, b
 void	CModel::runModelUI( CBenchmark::sPerformanceMetrics * sTotalMetrics )
 {
 	dProcessingTime = sTotalMetrics->dSeconds;
+	this->getDomainSet()->writePreviews( sTotalMetrics->dSeconds );
+
 	if (sTotalMetrics->dSeconds - dLastProgressUpdate > 0.85)
 	{
 		this->logProgress(sTotalMetrics);
@@ -1050,6 +1160,497 @@ void	CModel::runModelRollback()
 }
 
 
+/*
+ *  Sleep the management thread until a domain finishes its batch, rather than
+ *  repeatedly polling every domain and device for a change in state.
+ */
+void	CModel::runModelWait()
+{
+	bool bAnyRunning = false;
+
+	for (unsigned int i = 0; i < domains->getDomainCount(); ++i)
+	{
+		if (domains->isDomainLocal(i) &&
+			domains->getDomain(i)->getScheme()->isRunning())
+			bAnyRunning = true;
+	}
+
+	std::unique_lock<std::mutex> lock(mScheduler);
+
+	// Nothing in flight, so the only way to progress is to schedule more work
+	if (!bAnyRunning || model::forceAbort)
+	{
+		bSchedulerSignal = false;
+		return;
+	}
+
+	// MPI requests do not raise a signal, so we must still return regularly
+	// to progress them, as well as to keep the progress display up to date
+#ifdef MPI_ON
+	cvScheduler.wait_for(lock, std::chrono::milliseconds(1), [this] { return bSchedulerSignal; });
+#else
+	cvScheduler.wait_for(lock, std::chrono::milliseconds(250), [this] { return bSchedulerSignal; });
+#endif
+	bSchedulerSignal = false;
+}
+
+/*
+ *  Wake the management thread, called by schemes once a batch completes
+ */
+void	CModel::notifyScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(mScheduler);
+		bSchedulerSignal = true;
+	}
+	cvScheduler.notify_one();
+}
+
+/*
+ *  Re-run each intervention scenario from the latest snapshot of the baseline
+ *  run which the changes could not yet have influenced. That is the latest
+ *  snapshot with the intervention in place and the changed cells and their
+ *  neighbours never yet wet. Failing that, the scenario runs on unchanged from
+ *  the last snapshot before the intervention time and is applied there.
+ */
+void	CModel::runModelScenarios()
+{
+	if ( this->vScenarios.empty() || model::forceAbort )
+		return;
+
+	unsigned int				uiDomains		= domains->getDomainCount();
+	double						dSimulationEnd	= this->dSimulationTime;
+	std::vector<std::string>	vTargetDirs( uiDomains );
+
+	for ( unsigned int i = 0; i < uiDomains; ++i )
+	{
+		if ( !domains->isDomainLocal(i) ||
+			 domains->getDomain(i)->getType() != model::domainStructureTypes::kStructureCartesian )
+		{
+			model::doError(
+				"Scenarios can only be branched when every domain is a local Cartesian grid.",
+				model::errorCodes::kLevelWarning
+			);
+			return;
+		}
+		vTargetDirs[i] = domains->getDomain(i)->getTargetDir();
+	}
+
+	this->bBranching = true;
+
+	for ( unsigned int s = 0; s < this->vScenarios.size() && !model::forceAbort; ++s )
+	{
+		sScenario*								pScenario		= &this->vScenarios[s];
+		std::vector<std::vector<unsigned long>>	vCells( pScenario->vModifications.size() );
+		std::vector<std::vector<unsigned long>>	vArea( uiDomains );
+		unsigned int							uiSnapshot		= 0;
+		bool									bInPlace		= false;
+
+		if ( pScenario->dTime >= dSimulationEnd )
+		{
+			model::doError(
+				"Scenario " + pScenario->sName + " starts after the end of the simulation.",
+				model::errorCodes::kLevelWarning
+			);
+			continue;
+		}
+
+		// Cells changed by the scenario, and the neighbours which would respond first
+		for ( unsigned int m = 0; m < pScenario->vModifications.size(); ++m )
+		{
+			sScenarioModification*	pModification	= &pScenario->vModifications[m];
+			CVectorDataset			pVector;
+			std::vector<unsigned long>	vNeighbourhood;
+
+			if ( pModification->uiDomain >= uiDomains ||
+				 !pVector.openFileRead( pModification->sSource, pModification->sLayer ) ||
+				 !pVector.rasteriseForDomain( static_cast<CDomainCartesian*>( domains->getDomain( pModification->uiDomain ) ),
+											  pModification->sField, pModification->sMatch, &vCells[m] ) )
+			{
+				model::doError(
+					"Could not identify the cells for a modification in scenario " + pScenario->sName + ".",
+					model::errorCodes::kLevelWarning
+				);
+				vCells[m].clear();
+				continue;
+			}
+
+			// Rasterised IDs are by row and column, but the cell arrays are padded
+			CDomainCartesian*	pCartesian	= static_cast<CDomainCartesian*>( domains->getDomain( pModification->uiDomain ) );
+			unsigned long		ulCols		= pCartesian->getCols();
+			for ( unsigned long c = 0; c < vCells[m].size(); ++c )
+				vCells[m][c] = pCartesian->getCellID( vCells[m][c] % ulCols, vCells[m][c] / ulCols );
+
+			pCartesian->getNeighbourhood( &vCells[m], &vNeighbourhood );
+			vArea[ pModification->uiDomain ].insert( vArea[ pModification->uiDomain ].end(), vNeighbourhood.begin(), vNeighbourhood.end() );
+		}
+
+		// Wet cells stay recorded in the maximum level, so stop at the first
+		// snapshot where any of the area has held water
+		for ( unsigned int i = 0; i < domains->getDomain(0)->getSnapshotCount(); ++i )
+		{
+			bool bDry = true;
+			for ( unsigned int d = 0; d < uiDomains; ++d )
+			{
+				if ( !domains->getDomain(d)->isDryInSnapshot( i, &vArea[d] ) )
+					bDry = false;
+			}
+			if ( !bDry )
+				break;
+			if ( domains->getDomain(0)->getSnapshotTime(i) >= pScenario->dTime - 1E-5 )
+			{
+				uiSnapshot	= i;
+				bInPlace	= true;
+			}
+		}
+		if ( !bInPlace )
+		{
+			for ( unsigned int i = 0; i < domains->getDomain(0)->getSnapshotCount(); ++i )
+			{
+				if ( domains->getDomain(0)->getSnapshotTime(i) <= pScenario->dTime + 1E-5 )
+					uiSnapshot = i;
+			}
+		}
+
+		double	dBranchTime	= domains->getDomain(0)->getSnapshotTime( uiSnapshot );
+		bInPlace			= bInPlace || pScenario->dTime - dBranchTime <= 1E-5;
+
+		this->log->writeDivide();
+		this->log->writeLine( "Branching scenario " + pScenario->sName + " from the baseline at " + Util::secondsToTime( dBranchTime ) + "." );
+
+		for ( unsigned int d = 0; d < uiDomains; ++d )
+		{
+			domains->getDomain(d)->restoreSnapshot( uiSnapshot );
+			domains->getDomain(d)->setTargetDir( vTargetDirs[d] + pScenario->sName + "/" );
+			boost::filesystem::create_directories( vTargetDirs[d] + pScenario->sName + "/" );
+		}
+
+		if ( bInPlace )
+			this->applyScenario( pScenario, &vCells );
+		this->runModelBranch( dBranchTime );
+		dLastOutputTime = dBranchTime;
+
+		// Run on unchanged until the intervention is made
+		if ( !bInPlace )
+		{
+			this->dSimulationTime = pScenario->dTime;
+			this->runModelMain();
+			this->dSimulationTime = dSimulationEnd;
+
+			for ( unsigned int d = 0; d < uiDomains; ++d )
+			{
+				domains->getDomain(d)->getDevice()->blockUntilFinished();
+				domains->getDomain(d)->getScheme()->readDomainAll();
+				domains->getDomain(d)->getDevice()->blockUntilFinished();
+			}
+
+			this->applyScenario( pScenario, &vCells );
+			this->runModelBranch( pScenario->dTime );
+		}
+
+		this->runModelMain();
+	}
+
+	for ( unsigned int d = 0; d < uiDomains; ++d )
+		domains->getDomain(d)->setTargetDir( vTargetDirs[d] );
+	this->bBranching = false;
+}
+
+/*
+ *  Restart every domain from the state held in host memory at the given
+ *  time, resetting the synchronisation state as for a new simulation
+ */
+void	CModel::runModelBranch( double dTime )
+{
+	for ( unsigned int i = 0; i < domains->getDomainCount(); ++i )
+	{
+		if ( domains->isDomainLocal(i) )
+			domains->getDomain(i)->getScheme()->branchSimulation( dTime );
+	}
+	this->runModelBlockNode();
+
+	bSynchronised		= true;
+	bAllIdle			= true;
+	bRollbackRequired	= false;
+	dCurrentTime		= dTime;
+	dEarliestTime		= dTime;
+	dTargetTime			= dTime;
+	dLastSyncTime		= -1.0;
+}
+
+/*
+ *  Keep the compiled program, device buffers and static data resident and
+ *  run each job dropped into the spool directory from the initial state.
+ *  Jobs are XML files processed in name order, renamed to .running while in
+ *  progress and to .done or .failed afterwards. A file named 'stop' in the
+ *  spool directory ends the service.
+ */
+void	CModel::runService( std::string sSpoolDir )
+{
+	unsigned int				uiDomains	= domains->getDomainCount();
+	std::vector<std::string>	vTargetDirs( uiDomains );
+	boost::filesystem::path		pSpool( sSpoolDir );
+	boost::filesystem::path		pStop		= pSpool / "stop";
+
+	this->log->writeLine( "Verifying the required data before starting the service..." );
+
+	if ( !this->domains || !this->domains->isSetReady() ||
+		 !this->execController || !this->execController->isReady() )
+	{
+		model::doError(
+			"The domain or executor is not ready.",
+			model::errorCodes::kLevelModelStop
+		);
+		return;
+	}
+
+	for ( unsigned int i = 0; i < uiDomains; ++i )
+	{
+		if ( !domains->isDomainLocal(i) ||
+			 domains->getDomain(i)->getType() != model::domainStructureTypes::kStructureCartesian )
+		{
+			model::doError(
+				"The service can only run when every domain is a local Cartesian grid.",
+				model::errorCodes::kLevelModelStop
+			);
+			return;
+		}
+	}
+
+	if ( !boost::filesystem::is_directory( pSpool ) )
+	{
+		model::doError(
+			"The service spool directory does not exist.",
+			model::errorCodes::kLevelModelStop
+		);
+		return;
+	}
+
+	if ( !this->vScenarios.empty() )
+		model::doError(
+			"Scenarios in the configuration are ignored by the service.",
+			model::errorCodes::kLevelWarning
+		);
+
+	this->runModelPrepare();
+
+	// Every job starts from the state the configuration loaded
+	for ( unsigned int i = 0; i < uiDomains; ++i )
+	{
+		domains->getDomain(i)->saveSnapshot( 0.0 );
+		vTargetDirs[i] = domains->getDomain(i)->getTargetDir();
+	}
+
+	this->bBranching = true;
+	this->log->writeDivide();
+	this->log->writeLine( "Service is waiting for jobs in " + pSpool.string() + "." );
+
+	while ( !model::forceAbort )
+	{
+		std::vector<boost::filesystem::path>	vJobs;
+
+		if ( boost::filesystem::exists( pStop ) )
+		{
+			boost::filesystem::remove( pStop );
+			break;
+		}
+
+		for ( boost::filesystem::directory_iterator it( pSpool ); it != boost::filesystem::directory_iterator(); ++it )
+		{
+			if ( boost::filesystem::is_regular_file( it->path() ) && it->path().extension() == ".xml" )
+				vJobs.push_back( it->path() );
+		}
+
+		if ( vJobs.empty() )
+		{
+			std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+			continue;
+		}
+
+		std::sort( vJobs.begin(), vJobs.end() );
+
+		boost::filesystem::path	pRunning	= vJobs.front();
+		pRunning.replace_extension( ".running" );
+		boost::filesystem::rename( vJobs.front(), pRunning );
+
+		bool					bSuccess	= this->runServiceJob( pRunning.string(), sSpoolDir, &vTargetDirs );
+		boost::filesystem::path	pFinished	= pRunning;
+		pFinished.replace_extension( bSuccess ? ".done" : ".failed" );
+		boost::filesystem::rename( pRunning, pFinished );
+	}
+
+	for ( unsigned int d = 0; d < uiDomains; ++d )
+		domains->getDomain(d)->setTargetDir( vTargetDirs[d] );
+	this->bBranching = false;
+
+	this->log->writeLine( "Service has stopped." );
+}
+
+/*
+ *  Run a spooled job, which has the form
+ *    <job name="..." start="0" end="3600" outputFrequency="300" realStart="...">
+ *      <forcing boundary="..." source="rainfall.csv" />
+ *    </job>
+ *  with sources relative to the spool directory. Replaced forcing stays in
+ *  place for later jobs unless they replace it again.
+ */
+bool	CModel::runServiceJob( std::string sJobFile, std::string sSpoolDir, std::vector<std::string>* pTargetDirs )
+{
+	tinyxml2::XMLDocument	pJobDocument;
+	XMLElement				*pJob, *pForcing;
+	char					*cName = NULL, *cStart = NULL, *cEnd = NULL, *cFrequency = NULL, *cRealStart = NULL;
+	double					dStart = 0.0, dEnd = 0.0, dSimulationEnd = this->dSimulationTime, dFrequency = this->dOutputFrequency, dJobFrequency = dFrequency;
+	unsigned long			ulRealStart = 0;
+	bool					bRealStart = false;
+	std::string				sName;
+	bool					bForcingValid = true;
+	std::vector<std::pair<CBoundary*, std::string>>	vForcings;
+
+	pJobDocument.LoadFile( sJobFile.c_str() );
+	pJob = pJobDocument.ErrorID() == 0 ? pJobDocument.FirstChildElement( "job" ) : NULL;
+	if ( pJob == NULL )
+	{
+		model::doError(
+			"Could not parse the service job " + sJobFile + ".",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	Util::toNewString( &cName,		pJob->Attribute( "name" ) );
+	Util::toNewString( &cStart,		pJob->Attribute( "start" ) );
+	Util::toNewString( &cEnd,		pJob->Attribute( "end" ) );
+	Util::toNewString( &cFrequency,	pJob->Attribute( "outputFrequency" ) );
+	Util::toNewString( &cRealStart,	pJob->Attribute( "realStart" ) );
+
+	bool bAttributesValid = ( cName != NULL && cEnd != NULL && CXMLDataset::isValidFloat( cEnd ) &&
+							  ( cStart == NULL || CXMLDataset::isValidFloat( cStart ) ) &&
+							  ( cFrequency == NULL || CXMLDataset::isValidFloat( cFrequency ) ) );
+	if ( bAttributesValid )
+	{
+		sName			= std::string( cName );
+		dStart			= ( cStart == NULL ? 0.0 : boost::lexical_cast<double>( cStart ) );
+		dEnd			= boost::lexical_cast<double>( cEnd );
+		dJobFrequency	= ( cFrequency == NULL ? dFrequency : boost::lexical_cast<double>( cFrequency ) );
+		bRealStart		= ( cRealStart != NULL );
+		if ( bRealStart )
+			ulRealStart = Util::toTimestamp( cRealStart );
+	}
+
+	delete [] cName;
+	delete [] cStart;
+	delete [] cEnd;
+	delete [] cFrequency;
+	delete [] cRealStart;
+
+	if ( !bAttributesValid )
+	{
+		model::doError(
+			"Service job has no name or an invalid start, end or output frequency.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	if ( dEnd <= dStart )
+	{
+		model::doError(
+			"Service job " + sName + " ends before it starts.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	this->log->writeDivide();
+	this->log->writeLine( "Starting service job " + sName + "." );
+
+	// Check every forcing before any is replaced, so a bad job leaves the last one intact
+	pForcing = pJob->FirstChildElement( "forcing" );
+	while ( pForcing != NULL )
+	{
+		char		*cBoundary = NULL, *cSource = NULL;
+		bool		bAccepted = false;
+
+		Util::toNewString( &cBoundary,	pForcing->Attribute( "boundary" ) );
+		Util::toNewString( &cSource,	pForcing->Attribute( "source" ) );
+
+		for ( unsigned int i = 0; i < domains->getDomainCount() && cBoundary != NULL && cSource != NULL; ++i )
+		{
+			CBoundary* pBoundary = domains->getDomain(i)->getBoundaries()->getBoundaryByName( std::string( cBoundary ) );
+			if ( pBoundary != NULL && pBoundary->replaceTimeseries( sSpoolDir + "/" + std::string( cSource ), false ) )
+			{
+				vForcings.push_back( std::make_pair( pBoundary, sSpoolDir + "/" + std::string( cSource ) ) );
+				bAccepted = true;
+			}
+		}
+
+		if ( !bAccepted )
+		{
+			model::doError(
+				"Could not replace the forcing for boundary " + ( cBoundary == NULL ? std::string( "(unnamed)" ) : std::string( cBoundary ) ) + ".",
+				model::errorCodes::kLevelWarning
+			);
+			bForcingValid = false;
+		}
+
+		delete [] cBoundary;
+		delete [] cSource;
+
+		pForcing = pForcing->NextSiblingElement( "forcing" );
+	}
+
+	if ( !bForcingValid )
+		return false;
+
+	// New forcing is written into the existing boundary buffers
+	for ( unsigned int f = 0; f < vForcings.size(); ++f )
+		vForcings[f].first->replaceTimeseries( vForcings[f].second );
+
+	if ( bRealStart )
+		this->ulRealTimeStart = ulRealStart;
+
+	for ( unsigned int d = 0; d < domains->getDomainCount(); ++d )
+	{
+		domains->getDomain(d)->restoreSnapshot( 0 );
+		domains->getDomain(d)->setTargetDir( (*pTargetDirs)[d] + sName + "/" );
+		boost::filesystem::create_directories( (*pTargetDirs)[d] + sName + "/" );
+	}
+
+	this->dSimulationTime	= dEnd;
+	this->dOutputFrequency	= dJobFrequency;
+
+	this->runModelBranch( dStart );
+	dLastOutputTime = dStart;
+	this->runModelMain();
+
+	this->dSimulationTime	= dSimulationEnd;
+	this->dOutputFrequency	= dFrequency;
+
+	this->log->writeLine( "Service job " + sName + " is complete." );
+
+	return !model::forceAbort;
+}
+
+/*
+ *  Apply the changes for a scenario to the host copy of each domain
+ */
+void	CModel::applyScenario( sScenario* pScenario, std::vector<std::vector<unsigned long>>* pCells )
+{
+	for ( unsigned int m = 0; m < pScenario->vModifications.size(); ++m )
+	{
+		sScenarioModification*	pModification	= &pScenario->vModifications[m];
+		if ( (*pCells)[m].empty() )
+			continue;
+
+		domains->getDomain( pModification->uiDomain )->modifyCells(
+			&(*pCells)[m],
+			pModification->ucValue,
+			pModification->bRelative,
+			pModification->dAmount
+		);
+	}
+}
+
 /*
  *  Clean things up after the model is complete or aborted
  */
@@ -1065,6 +1666,12 @@ void	CModel::runModelCleanup()
 
 /*
  *  Run the actual simulation, asking each domain and schemes therein in turn etc.
+ *  The loop sleeps while batches are in flight but still assesses, syncs and
+ *  schedules every domain together on each pass.
+ *
+ *  TODO: Replace the passes with a per-domain task graph (advance, download,
+ *  send, receive and upload halos, write output) run on completion events, so
+ *  independent domains no longer progress in lockstep.
  */
 void	CModel::runModelMain()
 {
@@ -1084,6 +1691,8 @@ void	CModel::runModelMain()
 
 	// Track total processing time
 	dProcessingTime = sTotalMetrics->dSeconds;
+	this->getDomainSet()->writePreviews( sTotalMetrics->dSeconds );
+
 	dVisualisationTime = dProcessingTime;
 
 	// ---------
@@ -1099,6 +1708,9 @@ void	CModel::runModelMain()
 			);
 		#endif
 
+		// Sleep until there is something new to act upon
+		this->runModelWait();
+
 		// Assess the overall state of the simulation at present
 		this->runModelDomainAssess(
 			bSyncReady,
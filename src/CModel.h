@@ -23,6 +23,8 @@
 #include "General/CBenchmark.h"
 #include "Datasets/TinyXML/tinyxml2.h"
 #include <vector>
+#include <mutex>
+#include <condition_variable>
 
 // Some classes we need to know about...
 class CExecutorControl;
@@ -70,6 +72,11 @@ class CModel
 		void					runModelBlockGlobal(void);						// Block all domains until all are done
 		void					runModelBlockNode(void);						// Block further processing on this node only
 		void					runModelCleanup(void);							// Clean up after a simulation completes/aborts
+		void					runModelWait(void);								// Sleep until a domain completes a batch
+		void					runModelScenarios(void);						// Branch each intervention scenario from the baseline run
+		void					runModelBranch(double);							// Restart all domains from host memory at a given time
+		void					runService(std::string);						// Run jobs from a spool directory until told to stop
+		void					notifyScheduler(void);							// Signal that a domain has completed a batch
 
 		void					logDetails();									// Spit some info out to the log
 		double					getSimulationLength();							// Get total length of simulation
@@ -91,8 +98,29 @@ class CModel
 
 	private:
 
+		// Private structures
+		struct sScenarioModification
+		{
+			unsigned int		uiDomain;										// Domain index
+			unsigned char		ucValue;										// Bed elevation or Manning coefficient
+			bool				bRelative;										// Adjust the existing value rather than replace it?
+			double				dAmount;										// New value or adjustment
+			std::string			sSource;										// Vector file of the changed areas
+			std::string			sLayer;											// Layer within the file (first if empty)
+			std::string			sField;											// Attribute field used to select features
+			std::string			sMatch;											// Value of the field to select
+		};
+		struct sScenario
+		{
+			std::string			sName;											// Short name, also the output subdirectory
+			double				dTime;											// Time the intervention is in place from
+			std::vector<sScenarioModification>	vModifications;					// Changes to the domain
+		};
+
 		// Private functions
 		void					visualiserUpdate();								// Update 3D stuff 
+		void					applyScenario( sScenario*, std::vector<std::vector<unsigned long>>* );	// Apply the changes for a scenario to host memory
+		bool					runServiceJob( std::string, std::string, std::vector<std::string>* );	// Run a single spooled job from the initial state
 
 		// Private variables
 		CExecutorControlOpenCL*	execController;									// Handle for the executor controlling class
@@ -117,6 +145,11 @@ class CModel
 		bool					bAllIdle;										//
 		bool					bWaitOnLinks;									//
 		bool					bSynchronised;									//
+		bool					bSchedulerSignal;								// Has a domain completed work since we last waited?
+		bool					bBranching;										// Running a branched scenario rather than the baseline?
+		std::vector<sScenario>	vScenarios;										// Intervention scenarios to branch from the baseline run
+		std::mutex				mScheduler;										// Guards the scheduler signal
+		std::condition_variable	cvScheduler;									// Wakes the main loop when work completes
 		unsigned char			ucFloatSize;									// Size of single/double precision floats used
 		cursorCoords			pProgressCoords;								// Buffer coords of the progress output
 
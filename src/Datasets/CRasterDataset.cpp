@@ -278,6 +278,14 @@ bool	CRasterDataset::domainToRaster(
 							   ( sqrt( dVelocityX*dVelocityX + dVelocityY*dVelocityY ) / sqrt( 9.81 * dDepth ) ) :
 							   ( pBand->GetNoDataValue() ) );
 				break;
+			case model::rasterDatasets::dataValues::kConcentration:
+				dDepth		 = pDomain->getStateValue( ulCellID,
+									model::domainValueIndices::kValueFreeSurfaceLevel ) -
+							   pDomain->getBedElevation( ulCellID );
+				dRow[ iCol ] = ( dDepth > 1E-8 && pDomain->hasScalarValues() ?
+							   ( pDomain->getScalarValue( ulCellID ) / dDepth ) :
+							   ( pBand->GetNoDataValue() ) );
+				break;
 			}
 		}
 
@@ -302,6 +310,125 @@ bool	CRasterDataset::domainToRaster(
 	return true;
 }
 
+/*
+ *  Write a level of the depth preview pyramid to an 8-bit image, with depths
+ *  scaled so that 1 is dry/closed and 255 is at or above the scale depth
+ */
+bool	CRasterDataset::previewToRaster(
+			const char*			cDriver,
+			std::string			sFilename,
+			CDomainCartesian*	pDomain,
+			cl_float*			fData,
+			unsigned int		uiCols,
+			unsigned int		uiRows,
+			unsigned int		uiStride,
+			double				dScale
+		)
+{
+	GDALDriver*		pDriver;
+	GDALDriver*		pMemoryDriver;
+	GDALDataset*	pDataset;
+	GDALDataset*	pOutput;
+	GDALRasterBand*	pBand;
+	double			adfGeoTransform[6]		= { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	double			dResolution;
+	unsigned char*	ucRow;
+
+	pDriver			= GetGDALDriverManager()->GetDriverByName( cDriver );
+	pMemoryDriver	= GetGDALDriverManager()->GetDriverByName( "MEM" );
+
+	if ( pDriver == NULL || pMemoryDriver == NULL )
+	{
+		model::doError(
+			"Unable to obtain driver for preview output.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	// Image formats such as PNG and WebP only support copying
+	if ( CSLFetchBoolean( pDriver->GetMetadata(), GDAL_DCAP_CREATECOPY, false ) == 0 &&
+		 CSLFetchBoolean( pDriver->GetMetadata(), GDAL_DCAP_CREATE, false ) == 0 )
+	{
+		model::doError(
+			"GDAL format driver does not support file creation.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	pDataset = pMemoryDriver->Create( "", uiCols, uiRows, 1, GDT_Byte, NULL );
+
+	if ( pDataset == NULL )
+	{
+		model::doError(
+			"Could not create preview image in memory.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	pDomain->getRealOffset( &adfGeoTransform[0], &adfGeoTransform[3] );
+	pDomain->getCellResolution( &dResolution );
+
+	adfGeoTransform[3] += dResolution * uiStride * uiRows;	// TL offset instead of BL
+	adfGeoTransform[1]  = +dResolution * uiStride;
+	adfGeoTransform[5]  = -dResolution * uiStride;			// Y resolution has to be negative
+
+	pDataset->SetGeoTransform( adfGeoTransform );
+
+	// Write data (bottom to top for rows)
+	pBand	= pDataset->GetRasterBand( 1 );
+	pBand->SetNoDataValue( 0.0 );
+
+	ucRow	= new unsigned char[ uiCols ];
+	for( unsigned int iRow = 0; iRow < uiRows; ++iRow )
+	{
+		for( unsigned int iCol = 0; iCol < uiCols; ++iCol )
+		{
+			double dDepth = fData[ iRow * uiCols + iCol ];
+
+			if ( dDepth < 0.0 )
+			{
+				ucRow[ iCol ] = 0;
+			} else {
+				ucRow[ iCol ] = 1 + static_cast<unsigned char>( min( 254.0, floor( dDepth / dScale * 254.0 ) ) );
+			}
+		}
+
+		pBand->RasterIO(
+			GF_Write,			// Flag
+			0,				// X offset
+			uiRows - iRow - 1,		// Y offset
+			uiCols,				// X size
+			1,				// Y size
+			ucRow,				// Memory
+			uiCols,				// X buffer size
+			1,				// Y buffer size
+			GDT_Byte,			// Data type
+			0,				// Pixel space
+			0 				// Line space
+		);
+	}
+	delete [] ucRow;
+
+	pOutput = pDriver->CreateCopy( sFilename.c_str(), pDataset, FALSE, NULL, NULL, NULL );
+	GDALClose( (GDALDatasetH)pDataset );
+
+	if ( pOutput == NULL )
+	{
+		model::doError(
+			"Could not create preview image file.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	GDALClose( (GDALDatasetH)pOutput );
+
+	return true;
+}
+
 /*
  *  Read in metadata about the layer (e.g. resolution data)
  */
@@ -489,40 +616,53 @@ CBoundaryGridded::SBoundaryGridTransform* CRasterDataset::createTransformationFo
 }
 
 /*
- *	Create an array for use as a boundary condition
+ *	Create an array for use as a boundary condition from one band (i.e. one frame of a multi-frame file)
  */
-double*		CRasterDataset::createArrayForBoundary( CBoundaryGridded::SBoundaryGridTransform *sTransform )
+double*		CRasterDataset::createArrayForBoundary( CBoundaryGridded::SBoundaryGridTransform *sTransform, unsigned int uiBand )
 {
 	double* dReturn = new double[ sTransform->uiColumns * sTransform->uiRows ];
-	GDALRasterBand *pBand = this->gdDataset->GetRasterBand(1);
+	GDALRasterBand *pBand = this->gdDataset->GetRasterBand( uiBand );
+	int iBlockX, iBlockY;
 
-	double*			dScanLine;
-	for (unsigned long iRow = 0; iRow < sTransform->uiRows; iRow++)
+	// Read in strips of whole block (chunk) rows, so each chunk is only decoded once
+	pBand->GetBlockSize( &iBlockX, &iBlockY );
+	iBlockY = max( 1, iBlockY );
+
+	unsigned long	ulTop		= this->ulRows - sTransform->ulBaseSouth - sTransform->uiRows;
+	unsigned long	ulBottom	= this->ulRows - sTransform->ulBaseSouth;
+	double*			dStrip		= (double*)CPLMalloc( sizeof( double ) * sTransform->uiColumns * iBlockY );
+
+	for ( unsigned long ulStripTop = ulTop; ulStripTop < ulBottom; )
 	{
-		dScanLine = (double*)CPLMalloc(sizeof(double)* sTransform->uiColumns);
+		unsigned long ulStripRows = min( ulBottom, ( ulStripTop / iBlockY + 1 ) * iBlockY ) - ulStripTop;
+
 		pBand->RasterIO(
 			GF_Read,						// Flag
 			sTransform->ulBaseWest,			// X offset
-			( this->ulRows - sTransform->ulBaseSouth - 1 ) - iRow,	// Y offset
+			ulStripTop,						// Y offset
 			sTransform->uiColumns,			// X read size
-			1,								// Y read size
-			dScanLine,						// Target heap
+			ulStripRows,					// Y read size
+			dStrip,							// Target heap
 			sTransform->uiColumns,			// X buffer size
-			1,								// Y buffer size
+			ulStripRows,					// Y buffer size
 			GDT_Float64,					// Data type
 			0,								// Pixel space
 			0								// Line space
 		);
 
-		memcpy(
-			&dReturn[ iRow * sTransform->uiColumns ],
-			dScanLine,
-			sizeof( double ) * sTransform->uiColumns
-		);
+		// Raster rows run north to south, boundary rows south to north
+		for ( unsigned long ulRow = 0; ulRow < ulStripRows; ulRow++ )
+			memcpy(
+				&dReturn[ ( ulBottom - 1 - ( ulStripTop + ulRow ) ) * sTransform->uiColumns ],
+				&dStrip[ ulRow * sTransform->uiColumns ],
+				sizeof( double ) * sTransform->uiColumns
+			);
 
-		CPLFree(dScanLine);
+		ulStripTop += ulStripRows;
 	}
 
+	CPLFree( dStrip );
+
 	return dReturn;
 }
 
@@ -572,6 +712,12 @@ void	CRasterDataset::getValueDetails( unsigned char ucValue, std::string* sValue
 	case model::rasterDatasets::dataValues::kFroudeNumber:
 		*sValueName  = "froude number";
 		break;
+	case model::rasterDatasets::dataValues::kConcentration:
+		*sValueName  = "passive scalar concentration";
+		break;
+	case model::rasterDatasets::dataValues::kDrainageCapacity:
+		*sValueName  = "drainage capacity";
+		break;
 	default:
 		*sValueName  = "unknown value";
 		break;
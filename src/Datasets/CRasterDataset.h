@@ -43,7 +43,9 @@ namespace dataValues { enum dataValues {
 	kMaxDepth			= 9,		// Max depth
 	kMaxFSL				= 10,		// Max FSL
 	kFroudeNumber		= 11,		// Froude number
-	kMaxVelocity		= 12		// Max velocity magnitude
+	kMaxVelocity		= 12,		// Max velocity magnitude
+	kConcentration		= 13,		// Passive scalar concentration
+	kDrainageCapacity	= 14		// Drainage capacity (mm/hr)
 }; };
 };
 };
@@ -70,13 +72,16 @@ class CRasterDataset
 		static void		registerAll();																		// Register types for use, must be called first
 		static void		cleanupAll();																		// Cleanup memory after use. Not perfect... 
 		static bool		domainToRaster( const char*, std::string, CDomainCartesian*, unsigned char );		// Open a file as the dataset for writing
+		static bool		previewToRaster( const char*, std::string, CDomainCartesian*, cl_float*,			// Write a preview level as an 8-bit image
+										 unsigned int, unsigned int, unsigned int, double );
 		bool			openFileRead( std::string );														// Open a file as the dataset for reading
 		void			readMetadata();																		// Read metadata for the dataset
 		void			logDetails();																		// Write details (mainly metdata) to the log
 		bool			applyDimensionsToDomain( CDomainCartesian* );										// Applies the dimensions, offset and scaling to a domain
 		bool			applyDataToDomain( unsigned char, CDomainCartesian* );								// Applies first band of data in the raster to a domain variable
 		CBoundaryGridded::SBoundaryGridTransform* createTransformationForDomain(CDomainCartesian*);			// Create a transformation to match the domain
-		double*			createArrayForBoundary(CBoundaryGridded::SBoundaryGridTransform*);					// Create an array for a boundary condition
+		double*			createArrayForBoundary(CBoundaryGridded::SBoundaryGridTransform*, unsigned int = 1);	// Create an array for a boundary condition from a band
+		unsigned int	getBandCount()			{ return uiBandCount; }										// Number of bands (frames) in the file
 
 	private:
 
@@ -0,0 +1,506 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ *
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Vector dataset handling class
+ * ------------------------------------------
+ *
+ */
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+
+#include "../common.h"
+#include "CVectorDataset.h"
+#include "../General/CBenchmark.h"
+
+using std::min;
+using std::max;
+
+/*
+ *  Default constructor
+ */
+CVectorDataset::CVectorDataset()
+{
+	this->bAvailable = false;
+	this->gdDataset	 = NULL;
+	this->pLayer	 = NULL;
+}
+
+/*
+ *  Destructor
+ */
+CVectorDataset::~CVectorDataset(void)
+{
+	if ( this->gdDataset != NULL )
+		GDALClose( this->gdDataset );
+}
+
+/*
+ *  Open a file as the underlying dataset and select a layer
+ */
+bool	CVectorDataset::openFileRead( std::string sFilename, std::string sLayer )
+{
+	pManager->log->writeLine( "Invoking OGR to open vector dataset." );
+	this->gdDataset = static_cast<GDALDataset*>( GDALOpenEx( sFilename.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, NULL, NULL, NULL ) );
+
+	if ( this->gdDataset == NULL )
+	{
+		model::doError(
+			"Unable to open vector dataset",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	if ( sLayer.length() > 0 )
+	{
+		this->pLayer = this->gdDataset->GetLayerByName( sLayer.c_str() );
+	} else if ( this->gdDataset->GetLayerCount() > 0 ) {
+		this->pLayer = this->gdDataset->GetLayer( 0 );
+	}
+
+	if ( this->pLayer == NULL )
+	{
+		model::doError(
+			"Unable to find the requested layer in vector dataset",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	pManager->log->writeLine( "Opened OGR layer '" + std::string( this->pLayer->GetName() ) + "' with " +
+							  toString( this->pLayer->GetFeatureCount() ) + " features." );
+
+	this->bAvailable = true;
+	return true;
+}
+
+/*
+ *  Cells covered by all features whose field matches a value (or all features if no field)
+ */
+bool	CVectorDataset::rasteriseForDomain(
+			CDomainCartesian*				pDomain,
+			std::string						sField,
+			std::string						sValue,
+			std::vector<unsigned long>*		pCells
+		)
+{
+	std::vector<sShape>							vShapes;
+	std::vector<std::string>					vKeys;
+	std::vector<std::vector<unsigned long>>		vCells;
+
+	pCells->clear();
+
+	if ( !this->readShapes( pDomain, sField, sField.length() > 0 ? sValue : "", &vShapes, &vKeys ) )
+		return false;
+
+	// Every shape is in the same group when filtering on a single value
+	for ( unsigned int i = 0; i < vShapes.size(); i++ )
+		vShapes[i].uiKey = 0;
+
+	CVectorDataset::rasteriseShapes( pDomain, &vShapes, 1, &vCells );
+	pCells->swap( vCells[0] );
+
+	return true;
+}
+
+/*
+ *  Cells covered by features, grouped by the value of a field
+ */
+bool	CVectorDataset::rasteriseByFieldForDomain(
+			CDomainCartesian*				pDomain,
+			std::string						sField,
+			mapFeatureCells_t*				pFeatureCells
+		)
+{
+	std::vector<sShape>							vShapes;
+	std::vector<std::string>					vKeys;
+	std::vector<std::vector<unsigned long>>		vCells;
+
+	pFeatureCells->clear();
+
+	if ( sField.length() < 1 || !this->readShapes( pDomain, sField, "", &vShapes, &vKeys ) )
+		return false;
+
+	CVectorDataset::rasteriseShapes( pDomain, &vShapes, vKeys.size(), &vCells );
+
+	for ( unsigned int i = 0; i < vKeys.size(); i++ )
+		( *pFeatureCells )[ vKeys[i] ].swap( vCells[i] );
+
+	return true;
+}
+
+/*
+ *  Real-world ends and length of the first line feature whose field matches a value
+ */
+bool	CVectorDataset::getLineEndpoints(
+			std::string		sField,
+			std::string		sValue,
+			double*			dStartX,
+			double*			dStartY,
+			double*			dEndX,
+			double*			dEndY,
+			double*			dLength
+		)
+{
+	OGRFeature*	pFeature;
+	bool		bFound = false;
+
+	if ( !this->bAvailable )
+		return false;
+
+	this->pLayer->ResetReading();
+	while ( !bFound && ( pFeature = this->pLayer->GetNextFeature() ) != NULL )
+	{
+		OGRGeometry* pGeometry = pFeature->GetGeometryRef();
+
+		if ( pGeometry != NULL &&
+			 ( sField.length() < 1 || sValue == pFeature->GetFieldAsString( sField.c_str() ) ) )
+		{
+			if ( wkbFlatten( pGeometry->getGeometryType() ) == wkbMultiLineString &&
+				 static_cast<OGRGeometryCollection*>( pGeometry )->getNumGeometries() > 0 )
+				pGeometry = static_cast<OGRGeometryCollection*>( pGeometry )->getGeometryRef( 0 );
+
+			if ( wkbFlatten( pGeometry->getGeometryType() ) == wkbLineString )
+			{
+				OGRLineString* pLine = static_cast<OGRLineString*>( pGeometry );
+				if ( pLine->getNumPoints() > 1 )
+				{
+					*dStartX = pLine->getX( 0 );
+					*dStartY = pLine->getY( 0 );
+					*dEndX	 = pLine->getX( pLine->getNumPoints() - 1 );
+					*dEndY	 = pLine->getY( pLine->getNumPoints() - 1 );
+					*dLength = pLine->get_Length();
+					bFound	 = true;
+				}
+			}
+		}
+
+		OGRFeature::DestroyFeature( pFeature );
+	}
+
+	return bFound;
+}
+
+/*
+ *  Read the features into shapes measured in cells from the domain's lower-left corner
+ */
+bool	CVectorDataset::readShapes(
+			CDomainCartesian*				pDomain,
+			std::string						sField,
+			std::string						sValue,
+			std::vector<sShape>*			pShapes,
+			std::vector<std::string>*		pKeys
+		)
+{
+	boost::unordered_map<std::string, unsigned int>	mapKeys;
+	OGRFeature*										pFeature;
+	double											dCornerN, dCornerE, dCornerS, dCornerW, dResolution;
+	bool											bGrouped = ( sField.length() > 0 && sValue.length() < 1 );
+
+	if ( !this->bAvailable )
+		return false;
+
+	pDomain->getCellResolution( &dResolution );
+	pDomain->getRealExtent( &dCornerN, &dCornerE, &dCornerS, &dCornerW );
+
+	OGRSpatialReference* pReference = this->pLayer->GetSpatialRef();
+	if ( pReference != NULL && pDomain->getProjectionCode() > 0 )
+	{
+		const char* cCode = pReference->GetAuthorityCode( NULL );
+		if ( cCode != NULL && std::strtoul( cCode, NULL, 10 ) != pDomain->getProjectionCode() )
+			model::doError(
+				"Vector layer projection does not match the domain and will not be reprojected.",
+				model::errorCodes::kLevelWarning
+			);
+	}
+
+	if ( !bGrouped )
+		pKeys->push_back( sValue );
+
+	this->pLayer->ResetReading();
+	while ( ( pFeature = this->pLayer->GetNextFeature() ) != NULL )
+	{
+		OGRGeometry*	pGeometry	= pFeature->GetGeometryRef();
+		unsigned int	uiKey		= 0;
+
+		if ( pGeometry == NULL ||
+			 ( !bGrouped && sField.length() > 0 && sValue != pFeature->GetFieldAsString( sField.c_str() ) ) )
+		{
+			OGRFeature::DestroyFeature( pFeature );
+			continue;
+		}
+
+		if ( bGrouped )
+		{
+			std::string sKey = pFeature->GetFieldAsString( sField.c_str() );
+			boost::unordered_map<std::string, unsigned int>::const_iterator itKey = mapKeys.find( sKey );
+			if ( itKey == mapKeys.end() )
+			{
+				uiKey = pKeys->size();
+				mapKeys[ sKey ] = uiKey;
+				pKeys->push_back( sKey );
+			} else {
+				uiKey = itKey->second;
+			}
+		}
+
+		this->addGeometry( pGeometry, uiKey, dCornerW, dCornerS, dResolution, pShapes );
+		OGRFeature::DestroyFeature( pFeature );
+	}
+
+	return true;
+}
+
+/*
+ *  Convert a geometry (or each part of a collection) into shapes
+ */
+void	CVectorDataset::addGeometry(
+			OGRGeometry*			pGeometry,
+			unsigned int			uiKey,
+			double					dCornerW,
+			double					dCornerS,
+			double					dResolution,
+			std::vector<sShape>*	pShapes
+		)
+{
+	sShape	pShape;
+	pShape.uiKey	= uiKey;
+	pShape.dMinY	= HUGE_VAL;
+	pShape.dMaxY	= -HUGE_VAL;
+
+	auto addPart = [&]( OGRLineString* pLine )
+	{
+		std::vector<double> vPart;
+		vPart.reserve( pLine->getNumPoints() * 2 );
+		for ( int i = 0; i < pLine->getNumPoints(); i++ )
+		{
+			double dY = ( pLine->getY( i ) - dCornerS ) / dResolution;
+			vPart.push_back( ( pLine->getX( i ) - dCornerW ) / dResolution );
+			vPart.push_back( dY );
+			pShape.dMinY = min( pShape.dMinY, dY );
+			pShape.dMaxY = max( pShape.dMaxY, dY );
+		}
+		if ( vPart.size() > 0 )
+			pShape.vRings.push_back( vPart );
+	};
+
+	switch ( wkbFlatten( pGeometry->getGeometryType() ) )
+	{
+		case wkbPolygon:
+		{
+			// Exterior and interior rings together, so holes fall out of the even-odd rule
+			OGRPolygon* pPolygon = static_cast<OGRPolygon*>( pGeometry );
+			pShape.bArea = true;
+			if ( pPolygon->getExteriorRing() != NULL )
+				addPart( pPolygon->getExteriorRing() );
+			for ( int i = 0; i < pPolygon->getNumInteriorRings(); i++ )
+				addPart( pPolygon->getInteriorRing( i ) );
+			break;
+		}
+		case wkbLineString:
+			pShape.bArea = false;
+			addPart( static_cast<OGRLineString*>( pGeometry ) );
+			break;
+		case wkbPoint:
+		{
+			OGRPoint* pPoint = static_cast<OGRPoint*>( pGeometry );
+			OGRLineString pLine;
+			pLine.addPoint( pPoint->getX(), pPoint->getY() );
+			pShape.bArea = false;
+			addPart( &pLine );
+			break;
+		}
+		case wkbMultiPolygon:
+		case wkbMultiLineString:
+		case wkbMultiPoint:
+		case wkbGeometryCollection:
+		{
+			OGRGeometryCollection* pCollection = static_cast<OGRGeometryCollection*>( pGeometry );
+			for ( int i = 0; i < pCollection->getNumGeometries(); i++ )
+				this->addGeometry( pCollection->getGeometryRef( i ), uiKey, dCornerW, dCornerS, dResolution, pShapes );
+			return;
+		}
+		default:
+			model::doError(
+				"Ignored a vector feature with an unsupported geometry type.",
+				model::errorCodes::kLevelWarning
+			);
+			return;
+	}
+
+	if ( pShape.vRings.size() > 0 )
+		pShapes->push_back( pShape );
+}
+
+/*
+ *  Rasterise every shape over a band of rows. Polygons take cells whose centre falls inside
+ *  (even-odd on scanlines through the cell centres), lines and points take every cell they touch.
+ */
+void	CVectorDataset::rasteriseRows(
+			const std::vector<sShape>*	pShapes,
+			long						lRowStart,
+			long						lRowEnd,
+			unsigned long				ulCols,
+			vecKeyedCells_t*			pCells
+		)
+{
+	std::vector<double>	vCrossings;
+	long				lCols = static_cast<long>( ulCols );
+
+	for ( std::vector<sShape>::const_iterator itShape = pShapes->begin(); itShape != pShapes->end(); itShape++ )
+	{
+		if ( itShape->dMaxY < lRowStart || itShape->dMinY >= lRowEnd )
+			continue;
+
+		if ( itShape->bArea )
+		{
+			long lFirst = max( lRowStart, static_cast<long>( std::ceil( itShape->dMinY - 0.5 ) ) );
+			long lLast	= min( lRowEnd - 1, static_cast<long>( std::floor( itShape->dMaxY - 0.5 ) ) );
+
+			for ( long lRow = lFirst; lRow <= lLast; lRow++ )
+			{
+				double dCentreY = lRow + 0.5;
+				vCrossings.clear();
+
+				for ( std::vector<std::vector<double>>::const_iterator itRing = itShape->vRings.begin(); itRing != itShape->vRings.end(); itRing++ )
+				{
+					size_t szPoints = itRing->size() / 2;
+					for ( size_t i = 0; i < szPoints; i++ )
+					{
+						size_t j = ( i + 1 ) % szPoints;
+						double dX0 = ( *itRing )[ i * 2 ], dY0 = ( *itRing )[ i * 2 + 1 ];
+						double dX1 = ( *itRing )[ j * 2 ], dY1 = ( *itRing )[ j * 2 + 1 ];
+						if ( ( dY0 <= dCentreY ) != ( dY1 <= dCentreY ) )
+							vCrossings.push_back( dX0 + ( dCentreY - dY0 ) * ( dX1 - dX0 ) / ( dY1 - dY0 ) );
+					}
+				}
+
+				std::sort( vCrossings.begin(), vCrossings.end() );
+				for ( size_t k = 0; k + 1 < vCrossings.size(); k += 2 )
+				{
+					long lFrom	= max( 0L, static_cast<long>( std::ceil( vCrossings[k] - 0.5 ) ) );
+					long lTo	= min( lCols - 1, static_cast<long>( std::ceil( vCrossings[k + 1] - 0.5 ) ) - 1 );
+					for ( long lCol = lFrom; lCol <= lTo; lCol++ )
+						pCells->push_back( std::make_pair( itShape->uiKey, static_cast<unsigned long>( lRow * lCols + lCol ) ) );
+				}
+			}
+		} else {
+			for ( std::vector<std::vector<double>>::const_iterator itPart = itShape->vRings.begin(); itPart != itShape->vRings.end(); itPart++ )
+			{
+				size_t szPoints = itPart->size() / 2;
+				for ( size_t i = 0; i < max( szPoints, static_cast<size_t>( 2 ) ) - 1; i++ )
+				{
+					size_t j = min( i + 1, szPoints - 1 );
+					double dX0 = ( *itPart )[ i * 2 ], dY0 = ( *itPart )[ i * 2 + 1 ];
+					double dX1 = ( *itPart )[ j * 2 ], dY1 = ( *itPart )[ j * 2 + 1 ];
+
+					if ( max( dY0, dY1 ) < lRowStart || min( dY0, dY1 ) >= lRowEnd )
+						continue;
+
+					// Grid traversal along the segment, visiting each cell it passes through
+					long	lCol		= static_cast<long>( std::floor( dX0 ) );
+					long	lRow		= static_cast<long>( std::floor( dY0 ) );
+					long	lSteps		= std::abs( static_cast<long>( std::floor( dX1 ) ) - lCol ) +
+										  std::abs( static_cast<long>( std::floor( dY1 ) ) - lRow );
+					double	dDX			= dX1 - dX0;
+					double	dDY			= dY1 - dY0;
+					long	lStepX		= dDX > 0.0 ? 1 : -1;
+					long	lStepY		= dDY > 0.0 ? 1 : -1;
+					double	dDeltaX		= dDX != 0.0 ? 1.0 / std::fabs( dDX ) : HUGE_VAL;
+					double	dDeltaY		= dDY != 0.0 ? 1.0 / std::fabs( dDY ) : HUGE_VAL;
+					double	dNextX		= dDX != 0.0 ? ( dDX > 0.0 ? lCol + 1 - dX0 : dX0 - lCol ) * dDeltaX : HUGE_VAL;
+					double	dNextY		= dDY != 0.0 ? ( dDY > 0.0 ? lRow + 1 - dY0 : dY0 - lRow ) * dDeltaY : HUGE_VAL;
+
+					for ( long s = 0; s <= lSteps; s++ )
+					{
+						if ( lRow >= lRowStart && lRow < lRowEnd && lCol >= 0 && lCol < lCols )
+							pCells->push_back( std::make_pair( itShape->uiKey, static_cast<unsigned long>( lRow * lCols + lCol ) ) );
+
+						if ( dNextX < dNextY )
+						{
+							dNextX += dDeltaX;
+							lCol   += lStepX;
+						} else {
+							dNextY += dDeltaY;
+							lRow   += lStepY;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Row bands are disjoint, so each band can be ordered independently
+	std::sort( pCells->begin(), pCells->end() );
+	pCells->erase( std::unique( pCells->begin(), pCells->end() ), pCells->end() );
+}
+
+/*
+ *  Split the domain rows into bands rasterised on separate threads, then gather sorted cells per group
+ */
+void	CVectorDataset::rasteriseShapes(
+			CDomainCartesian*							pDomain,
+			const std::vector<sShape>*					pShapes,
+			unsigned int								uiKeys,
+			std::vector<std::vector<unsigned long>>*	pCells
+		)
+{
+	long			lRows		= static_cast<long>( pDomain->getRows() );
+	unsigned long	ulCols		= pDomain->getCols();
+	long			lThreads	= max( 1L, min( static_cast<long>( std::thread::hardware_concurrency() ), lRows / 64 ) );
+	long			lBandSize	= ( lRows + lThreads - 1 ) / lThreads;
+
+	std::vector<vecKeyedCells_t>	vBandCells( lThreads );
+	std::vector<std::thread>		vThreads;
+
+	CBenchmark* pTimer = new CBenchmark( true );
+
+	for ( long t = 0; t < lThreads; t++ )
+		vThreads.push_back( std::thread(
+			&CVectorDataset::rasteriseRows,
+			pShapes,
+			t * lBandSize,
+			min( lRows, ( t + 1 ) * lBandSize ),
+			ulCols,
+			&vBandCells[t]
+		) );
+	for ( long t = 0; t < lThreads; t++ )
+		vThreads[t].join();
+
+	// Bands are in row order and each is sorted, so appending keeps each group sorted
+	pCells->assign( uiKeys, std::vector<unsigned long>() );
+	for ( long t = 0; t < lThreads; t++ )
+		for ( vecKeyedCells_t::const_iterator it = vBandCells[t].begin(); it != vBandCells[t].end(); it++ )
+			( *pCells )[ it->first ].push_back( it->second );
+
+	// Polygons smaller than a cell still take the cell holding their first vertex
+	for ( std::vector<sShape>::const_iterator itShape = pShapes->begin(); itShape != pShapes->end(); itShape++ )
+	{
+		std::vector<unsigned long>* pGroup = &( *pCells )[ itShape->uiKey ];
+		if ( !itShape->bArea || pGroup->size() > 0 || itShape->vRings[0].size() < 2 )
+			continue;
+
+		double dX = itShape->vRings[0][0], dY = itShape->vRings[0][1];
+		if ( dX >= 0.0 && dY >= 0.0 && dX < ulCols && dY < lRows )
+			pGroup->push_back( static_cast<unsigned long>( std::floor( dY ) ) * ulCols + static_cast<unsigned long>( std::floor( dX ) ) );
+	}
+
+	pTimer->finish();
+	pManager->log->writeLine( "Rasterised " + toString( pShapes->size() ) + " vector shapes on " + toString( lThreads ) +
+							  " threads in " + toString( pTimer->getMetrics()->dMilliseconds ) + "ms." );
+	delete pTimer;
+}
@@ -0,0 +1,86 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ *
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Vector dataset handling class
+ * ------------------------------------------
+ *
+ */
+#ifndef HIPIMS_DATASETS_CVECTORDATASET_H_
+#define HIPIMS_DATASETS_CVECTORDATASET_H_
+
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include <boost/unordered_map.hpp>
+#include <vector>
+#include <utility>
+#include "../Domain/Cartesian/CDomainCartesian.h"
+
+/*
+ *  VECTOR DATASET CLASS
+ *  CVectorDataset
+ *
+ *  Provides access for reading polygon and line
+ *  layers (shapefiles, GeoPackages etc.) and
+ *  rasterising them onto a domain. Uses OGR.
+ */
+class CVectorDataset
+{
+
+	public:
+
+		CVectorDataset( void );																				// Constructor
+		~CVectorDataset( void );																			// Destructor
+
+		// Public types
+		typedef boost::unordered_map<std::string, std::vector<unsigned long>> mapFeatureCells_t;
+
+		// Public functions
+		bool			openFileRead( std::string, std::string = "" );										// Open a file and select a layer (first if none named)
+		bool			rasteriseForDomain( CDomainCartesian*, std::string, std::string,					// Sorted cell IDs covered by features matching a field value
+											std::vector<unsigned long>* );
+		bool			rasteriseByFieldForDomain( CDomainCartesian*, std::string, mapFeatureCells_t* );	// Sorted cell IDs covered by features, grouped by a field value
+		bool			getLineEndpoints( std::string, std::string, double*, double*, double*, double*,		// Ends and length of the first line matching a field value
+										  double* );
+
+	private:
+
+		// Private types
+		struct sShape
+		{
+			unsigned int						uiKey;														// Index of the group this shape belongs to
+			bool								bArea;														// Polygon (true) or line (false)
+			double								dMinY;														// Lowest row coordinate of the shape
+			double								dMaxY;														// Highest row coordinate of the shape
+			std::vector<std::vector<double>>	vRings;														// Rings or parts as interleaved X/Y in cell units
+		};
+		typedef std::vector<std::pair<unsigned int, unsigned long>> vecKeyedCells_t;
+
+		// Private functions
+		bool			readShapes( CDomainCartesian*, std::string, std::string, std::vector<sShape>*,		// Read matching features into cell-unit shapes
+									std::vector<std::string>* );
+		void			addGeometry( OGRGeometry*, unsigned int, double, double, double,					// Convert an OGR geometry into shapes
+									 std::vector<sShape>* );
+		static void		rasteriseRows( const std::vector<sShape>*, long, long, unsigned long,				// Scanline rasterise a band of rows
+									   vecKeyedCells_t* );
+		static void		rasteriseShapes( CDomainCartesian*, const std::vector<sShape>*, unsigned int,		// Rasterise all shapes across threads
+										 std::vector<std::vector<unsigned long>>* );
+
+		// Private variables
+		GDALDataset*	gdDataset;																			// Pointer to the dataset
+		OGRLayer*		pLayer;																				// Layer in use
+		bool			bAvailable;																			// Layer successfully open and available?
+
+};
+
+#endif
@@ -17,6 +17,7 @@
  *
  */
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 
 #include "../common.h"
 #include "CDomain.h"
@@ -43,6 +44,27 @@ CDomain::CDomain(void)
 	this->dMinDepth			= 9999.0;
 	this->dMaxDepth			= -9999.0;
 	this->uiRollbackLimit	= 999999999;
+	this->dScalarValues		= NULL;
+	this->fScalarValues		= NULL;
+	this->dDrainageValues	= NULL;
+	this->fDrainageValues	= NULL;
+	this->bDrainageCapacity	= false;
+	this->dCellStates		= NULL;
+	this->dBedElevations	= NULL;
+	this->dManningValues	= NULL;
+	this->fCellStates		= NULL;
+	this->fBedElevations	= NULL;
+	this->fManningValues	= NULL;
+	this->bKeepHostMirrors		= true;
+	this->bHostMirrorsReleased	= false;
+	this->ulStagingCells		= 262144;
+
+	for ( unsigned char i = 0; i < 3; ++i )
+	{
+		this->pStaging[ i ].ulStart		= 0;
+		this->pStaging[ i ].ulLength	= 0;
+		this->pStaging[ i ].bDirty		= false;
+	}
 
 	this->cTargetDir				= NULL;
 	this->cSourceDir				= NULL;
@@ -66,6 +88,15 @@ CDomain::~CDomain(void)
 		delete [] this->dManningValues;
 	}
 
+	if ( this->ucFloatSize == 4 && this->fScalarValues != NULL )
+		delete [] this->fScalarValues;
+	if ( this->ucFloatSize == 8 && this->dScalarValues != NULL )
+		delete [] this->dScalarValues;
+	if ( this->ucFloatSize == 4 && this->fDrainageValues != NULL )
+		delete [] this->fDrainageValues;
+	if ( this->ucFloatSize == 8 && this->dDrainageValues != NULL )
+		delete [] this->dDrainageValues;
+
 	if ( this->pBoundaries != NULL ) delete pBoundaries;
 	if ( this->pScheme != NULL )     delete pScheme;
 
@@ -134,6 +165,41 @@ bool CDomain::configureDomain( XMLElement* pXDomain )
 		std::strcpy( this->cTargetDir, cDataTargetDir );
 	}
 
+	// Host copies of the cell data can be released once on the device
+	char	*cHostMirrors	= NULL;
+	char	*cStagingCells	= NULL;
+	Util::toLowercase( &cHostMirrors,  pXData->Attribute( "hostMirrors" ) );
+	Util::toLowercase( &cStagingCells, pXData->Attribute( "stagingCells" ) );
+
+	if ( cHostMirrors != NULL )
+	{
+		if ( strcmp( cHostMirrors, "false" ) == 0 || strcmp( cHostMirrors, "release" ) == 0 )
+		{
+			this->setHostMirrors( false );
+		}
+		else if ( strcmp( cHostMirrors, "true" ) != 0 && strcmp( cHostMirrors, "keep" ) != 0 )
+		{
+			model::doError(
+				"Invalid host mirror setting given.",
+				model::errorCodes::kLevelWarning
+			);
+		}
+	}
+
+	if ( cStagingCells != NULL )
+	{
+		if ( CXMLDataset::isValidUnsignedInt( std::string( cStagingCells ) ) &&
+			 boost::lexical_cast<unsigned long>( cStagingCells ) > 0 )
+		{
+			this->ulStagingCells = boost::lexical_cast<unsigned long>( cStagingCells );
+		} else {
+			model::doError(
+				"Invalid staging area size given.",
+				model::errorCodes::kLevelWarning
+			);
+		}
+	}
+
 	return true;
 }
 
@@ -156,9 +222,9 @@ void	CDomain::createStoreBuffers(
 		if ( ucFloatSize == sizeof( cl_float ) )
 		{
 			// Single precision
-			this->fCellStates		= new cl_float4[ this->ulCellCount ];
-			this->fBedElevations	= new cl_float[ this->ulCellCount ];
-			this->fManningValues	= new cl_float[ this->ulCellCount ];
+			this->fCellStates		= new cl_float4[ this->getAllocatedCellCount() ];
+			this->fBedElevations	= new cl_float[ this->getAllocatedCellCount() ];
+			this->fManningValues	= new cl_float[ this->getAllocatedCellCount() ];
 			this->dCellStates		= (cl_double4*)( this->fCellStates );
 			this->dBedElevations	= (cl_double*)( this->fBedElevations );
 			this->dManningValues	= (cl_double*)( this->fManningValues );
@@ -168,9 +234,9 @@ void	CDomain::createStoreBuffers(
 			*vArrayManningCoefs	 = static_cast<void*>( this->fManningValues );
 		} else {
 			// Double precision
-			this->dCellStates		= new cl_double4[ this->ulCellCount ];
-			this->dBedElevations	= new cl_double[ this->ulCellCount ];
-			this->dManningValues	= new cl_double[ this->ulCellCount ];
+			this->dCellStates		= new cl_double4[ this->getAllocatedCellCount() ];
+			this->dBedElevations	= new cl_double[ this->getAllocatedCellCount() ];
+			this->dManningValues	= new cl_double[ this->getAllocatedCellCount() ];
 			this->fCellStates		= (cl_float4*)( this->dCellStates );
 			this->fBedElevations	= (cl_float*)( this->dBedElevations );
 			this->fManningValues	= (cl_float*)( this->dManningValues );
@@ -188,17 +254,172 @@ void	CDomain::createStoreBuffers(
 		);
 		return;
 	}
+
+	this->initialiseMemory();
+}
+
+/*
+ *  Free the host copies of the cell states, bed elevations, Manning values and
+ *  any drainage capacities once the scheme holds them on the device. Values
+ *  are then fetched from the device through a small staging area for each
+ *  array when needed (drainage capacities are never read back).
+ */
+void	CDomain::releaseStoreBuffers()
+{
+	if ( this->bHostMirrorsReleased )
+		return;
+
+	if ( this->ucFloatSize == 4 )
+	{
+		delete [] this->fCellStates;
+		delete [] this->fBedElevations;
+		delete [] this->fManningValues;
+		delete [] this->fDrainageValues;
+	} else {
+		delete [] this->dCellStates;
+		delete [] this->dBedElevations;
+		delete [] this->dManningValues;
+		delete [] this->dDrainageValues;
+	}
+
+	this->dCellStates		= NULL;
+	this->dBedElevations	= NULL;
+	this->dManningValues	= NULL;
+	this->dDrainageValues	= NULL;
+	this->fCellStates		= NULL;
+	this->fBedElevations	= NULL;
+	this->fManningValues	= NULL;
+	this->fDrainageValues	= NULL;
+
+	this->bHostMirrorsReleased = true;
+
+	pManager->log->writeLine(
+		"Host copies of the domain data released, staging " + toString( this->ulStagingCells ) + " cells at a time."
+	);
+}
+
+/*
+ *  Fetch a pointer to a cell's data in the staging area for an array, moving
+ *  the area onto the block of cells containing it if necessary
+ */
+void*	CDomain::getStagedCell( unsigned char ucArray, unsigned long ulCellID )
+{
+	sStagingArea*	pArea		= &this->pStaging[ ucArray ];
+	unsigned long	ulCellSize	= this->ucFloatSize * ( ucArray == model::domainArrays::kArrayCellStates ? 4 : 1 );
+
+	if ( ulCellID < pArea->ulStart || ulCellID >= pArea->ulStart + pArea->ulLength )
+	{
+		this->flushStaging( ucArray );
+
+		pArea->ulStart	= ( ulCellID / this->ulStagingCells ) * this->ulStagingCells;
+		pArea->ulLength	= std::min( this->ulStagingCells, this->getAllocatedCellCount() - pArea->ulStart );
+		pArea->vData.resize( this->ulStagingCells * ulCellSize );
+
+		this->pScheme->readDomainRange( ucArray, pArea->ulStart, pArea->ulLength, &pArea->vData[0] );
+	}
+
+	return &pArea->vData[ ( ulCellID - pArea->ulStart ) * ulCellSize ];
+}
+
+/*
+ *  Write one staging area back to the device if anything in it was changed
+ */
+void	CDomain::flushStaging( unsigned char ucArray )
+{
+	sStagingArea*	pArea		= &this->pStaging[ ucArray ];
+
+	if ( pArea->bDirty && pArea->ulLength > 0 )
+		this->pScheme->writeDomainRange( ucArray, pArea->ulStart, pArea->ulLength, &pArea->vData[0] );
+
+	pArea->bDirty = false;
 }
 
 /*
- *  Populate all domain cells with default values
- *  NOTE: Shouldn't be required anymore, C++11 used in COCLBuffer to initialise to zero on allocate
+ *  Write every staging area back to the device if changed
+ */
+void	CDomain::flushStaging()
+{
+	for ( unsigned char i = 0; i < 3; ++i )
+		this->flushStaging( i );
+}
+
+/*
+ *  The device copy of an array has changed, so anything staged is stale
+ */
+void	CDomain::invalidateStaging( unsigned char ucArray )
+{
+	this->pStaging[ ucArray ].ulLength	= 0;
+	this->pStaging[ ucArray ].bDirty	= false;
+}
+
+/*
+ *  Allocates memory for the passive scalar, which must follow the other store buffers
+ */
+void	CDomain::createScalarStoreBuffer(
+			void**			vArrayScalars
+		)
+{
+	try {
+		if ( this->ucFloatSize == sizeof( cl_float ) )
+		{
+			this->fScalarValues		= new cl_float[ this->getAllocatedCellCount() ]();
+			this->dScalarValues		= (cl_double*)( this->fScalarValues );
+			*vArrayScalars			= static_cast<void*>( this->fScalarValues );
+		} else {
+			this->dScalarValues		= new cl_double[ this->getAllocatedCellCount() ]();
+			this->fScalarValues		= (cl_float*)( this->dScalarValues );
+			*vArrayScalars			= static_cast<void*>( this->dScalarValues );
+		}
+	}
+	catch( std::bad_alloc )
+	{
+		model::doError(
+			"Domain memory allocation failure. Probably out of memory.",
+			model::errorCodes::kLevelFatal
+		);
+		return;
+	}
+}
+
+/*
+ *  Allocates memory for the drainage capacities, which must follow the other store buffers.
+ *  Cells without a capacity are left at zero and take no loss.
+ */
+void	CDomain::createDrainageStoreBuffer(
+			void**			vArrayDrainage
+		)
+{
+	try {
+		if ( this->ucFloatSize == sizeof( cl_float ) )
+		{
+			this->fDrainageValues	= new cl_float[ this->getAllocatedCellCount() ]();
+			this->dDrainageValues	= (cl_double*)( this->fDrainageValues );
+			*vArrayDrainage			= static_cast<void*>( this->fDrainageValues );
+		} else {
+			this->dDrainageValues	= new cl_double[ this->getAllocatedCellCount() ]();
+			this->fDrainageValues	= (cl_float*)( this->dDrainageValues );
+			*vArrayDrainage			= static_cast<void*>( this->dDrainageValues );
+		}
+	}
+	catch( std::bad_alloc )
+	{
+		model::doError(
+			"Domain memory allocation failure. Probably out of memory.",
+			model::errorCodes::kLevelFatal
+		);
+		return;
+	}
+}
+
+/*
+ *  Populate all domain cells with default values, including any padding
+ *  which the initial conditions will never reach
  */
 void	CDomain::initialiseMemory()
 {
 	pManager->log->writeLine( "Initialising heap domain data." );
 
-	for( unsigned long i = 0; i < this->ulCellCount; i++ )
+	for( unsigned long i = 0; i < this->getAllocatedCellCount(); i++ )
 	{
 		if ( this->ucFloatSize == 4 )
 		{
@@ -224,6 +445,19 @@ void	CDomain::initialiseMemory()
  */
 void	CDomain::setBedElevation( unsigned long ulCellID, double dElevation )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayBedElevations, ulCellID );
+		if ( this->ucFloatSize == 4 )
+		{
+			*static_cast<cl_float*>( pCell ) = static_cast<float>( dElevation );
+		} else {
+			*static_cast<cl_double*>( pCell ) = dElevation;
+		}
+		this->pStaging[ model::domainArrays::kArrayBedElevations ].bDirty = true;
+		return;
+	}
+
 	if ( this->ucFloatSize == 4 )
 	{
 		this->fBedElevations[ ulCellID ] = static_cast<float>( dElevation );
@@ -237,6 +471,19 @@ void	CDomain::setBedElevation( unsigned long ulCellID, double dElevation )
  */
 void	CDomain::setManningCoefficient( unsigned long ulCellID, double dCoefficient )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayManningCoefficients, ulCellID );
+		if ( this->ucFloatSize == 4 )
+		{
+			*static_cast<cl_float*>( pCell ) = static_cast<float>( dCoefficient );
+		} else {
+			*static_cast<cl_double*>( pCell ) = dCoefficient;
+		}
+		this->pStaging[ model::domainArrays::kArrayManningCoefficients ].bDirty = true;
+		return;
+	}
+
 	if ( this->ucFloatSize == 4 )
 	{
 		this->fManningValues[ ulCellID ] = static_cast<float>( dCoefficient );
@@ -250,6 +497,19 @@ void	CDomain::setManningCoefficient( unsigned long ulCellID, double dCoefficient
  */
 void	CDomain::setStateValue( unsigned long ulCellID, unsigned char ucIndex, double dValue )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayCellStates, ulCellID );
+		if ( this->ucFloatSize == 4 )
+		{
+			static_cast<cl_float4*>( pCell )->s[ ucIndex ] = static_cast<float>( dValue );
+		} else {
+			static_cast<cl_double4*>( pCell )->s[ ucIndex ] = dValue;
+		}
+		this->pStaging[ model::domainArrays::kArrayCellStates ].bDirty = true;
+		return;
+	}
+
 	if ( this->ucFloatSize == 4 )
 	{
 		this->fCellStates[ ulCellID ].s[ ucIndex ] = static_cast<float>( dValue );
@@ -258,11 +518,45 @@ void	CDomain::setStateValue( unsigned long ulCellID, unsigned char ucIndex, doub
 	}
 }
 
+/*
+ *  Sets the passive scalar mass per unit area for a given cell
+ */
+void	CDomain::setScalarValue( unsigned long ulCellID, double dValue )
+{
+	if ( this->ucFloatSize == 4 )
+	{
+		this->fScalarValues[ ulCellID ] = static_cast<float>( dValue );
+	} else {
+		this->dScalarValues[ ulCellID ] = dValue;
+	}
+}
+
+/*
+ *  Sets the drainage capacity for a given cell
+ */
+void	CDomain::setDrainageCapacity( unsigned long ulCellID, double dValue )
+{
+	if ( this->ucFloatSize == 4 )
+	{
+		this->fDrainageValues[ ulCellID ] = static_cast<float>( dValue );
+	} else {
+		this->dDrainageValues[ ulCellID ] = dValue;
+	}
+}
+
 /*
  *  Gets the bed elevation for a given cell
  */
 double	CDomain::getBedElevation( unsigned long ulCellID )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayBedElevations, ulCellID );
+		if ( this->ucFloatSize == 4 )
+			return static_cast<double>( *static_cast<cl_float*>( pCell ) );
+		return *static_cast<cl_double*>( pCell );
+	}
+
 	if ( this->ucFloatSize == 4 )
 		return static_cast<double>( this->fBedElevations[ ulCellID ] );
 	return this->dBedElevations[ ulCellID ];
@@ -273,6 +567,14 @@ double	CDomain::getBedElevation( unsigned long ulCellID )
  */
 double	CDomain::getManningCoefficient( unsigned long ulCellID )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayManningCoefficients, ulCellID );
+		if ( this->ucFloatSize == 4 )
+			return static_cast<double>( *static_cast<cl_float*>( pCell ) );
+		return *static_cast<cl_double*>( pCell );
+	}
+
 	if ( this->ucFloatSize == 4 )
 		return static_cast<double>( this->fManningValues[ ulCellID ] );
 	return this->dManningValues[ ulCellID ];
@@ -283,11 +585,190 @@ double	CDomain::getManningCoefficient( unsigned long ulCellID )
  */
 double	CDomain::getStateValue( unsigned long ulCellID, unsigned char ucIndex )
 {
+	if ( this->bHostMirrorsReleased )
+	{
+		void* pCell = this->getStagedCell( model::domainArrays::kArrayCellStates, ulCellID );
+		if ( this->ucFloatSize == 4 )
+			return static_cast<double>( static_cast<cl_float4*>( pCell )->s[ ucIndex ] );
+		return static_cast<cl_double4*>( pCell )->s[ ucIndex ];
+	}
+
 	if ( this->ucFloatSize == 4 )
 		return static_cast<double>( this->fCellStates[ ulCellID ].s[ ucIndex ] );
 	return this->dCellStates[ ulCellID ].s[ ucIndex ];
 }
 
+/*
+ *  Gets the passive scalar mass per unit area for a given cell
+ */
+double	CDomain::getScalarValue( unsigned long ulCellID )
+{
+	if ( this->ucFloatSize == 4 )
+		return static_cast<double>( this->fScalarValues[ ulCellID ] );
+	return this->dScalarValues[ ulCellID ];
+}
+
+/*
+ *  Gets the drainage capacity for a given cell
+ */
+double	CDomain::getDrainageCapacity( unsigned long ulCellID )
+{
+	if ( this->dDrainageValues == NULL )
+		return 0.0;
+	if ( this->ucFloatSize == 4 )
+		return static_cast<double>( this->fDrainageValues[ ulCellID ] );
+	return this->dDrainageValues[ ulCellID ];
+}
+
+/*
+ *  Retain a copy of the cell states in host memory, which must be current,
+ *  so the simulation can later be branched from this time. The bed and Manning
+ *  values are kept alongside the first snapshot so each branch starts from
+ *  the unmodified domain.
+ */
+void	CDomain::saveSnapshot( double dTime )
+{
+	sSnapshot		pSnapshot;
+	unsigned long	ulCells		= this->getAllocatedCellCount();
+
+	pSnapshot.dTime	= dTime;
+	pSnapshot.vStates.resize( ulCells * ucFloatSize * 4 );
+
+	// Without host copies the snapshot is read straight from the device
+	if ( this->bHostMirrorsReleased )
+	{
+		this->flushStaging();
+		this->pScheme->readDomainRange( model::domainArrays::kArrayCellStates, 0, ulCells, &pSnapshot.vStates[0] );
+	} else {
+		std::memcpy( &pSnapshot.vStates[0], ( ucFloatSize == 4 ? (void*)this->fCellStates : (void*)this->dCellStates ), pSnapshot.vStates.size() );
+	}
+
+	if ( this->hasScalarValues() )
+	{
+		pSnapshot.vScalars.resize( ulCells * ucFloatSize );
+		std::memcpy( &pSnapshot.vScalars[0], ( ucFloatSize == 4 ? (void*)this->fScalarValues : (void*)this->dScalarValues ), pSnapshot.vScalars.size() );
+	}
+
+	if ( this->vSnapshots.empty() )
+	{
+		this->vOriginalBed.resize( ulCells * ucFloatSize );
+		this->vOriginalManning.resize( ulCells * ucFloatSize );
+		if ( this->bHostMirrorsReleased )
+		{
+			this->pScheme->readDomainRange( model::domainArrays::kArrayBedElevations, 0, ulCells, &this->vOriginalBed[0] );
+			this->pScheme->readDomainRange( model::domainArrays::kArrayManningCoefficients, 0, ulCells, &this->vOriginalManning[0] );
+		} else {
+			std::memcpy( &this->vOriginalBed[0], ( ucFloatSize == 4 ? (void*)this->fBedElevations : (void*)this->dBedElevations ), this->vOriginalBed.size() );
+			std::memcpy( &this->vOriginalManning[0], ( ucFloatSize == 4 ? (void*)this->fManningValues : (void*)this->dManningValues ), this->vOriginalManning.size() );
+		}
+	}
+
+	this->vSnapshots.push_back( pSnapshot );
+}
+
+/*
+ *  Return the host copy of the domain to a snapshot, undoing any changes made
+ *  to the bed elevations and Manning coefficients since
+ */
+void	CDomain::restoreSnapshot( unsigned int uiSnapshot )
+{
+	sSnapshot*	pSnapshot	= &this->vSnapshots[ uiSnapshot ];
+
+	// Without host copies the snapshot goes straight back to the device
+	if ( this->bHostMirrorsReleased )
+	{
+		unsigned long	ulCells		= this->getAllocatedCellCount();
+
+		this->pScheme->writeDomainRange( model::domainArrays::kArrayCellStates, 0, ulCells, &pSnapshot->vStates[0] );
+		this->pScheme->writeDomainRange( model::domainArrays::kArrayBedElevations, 0, ulCells, &this->vOriginalBed[0] );
+		this->pScheme->writeDomainRange( model::domainArrays::kArrayManningCoefficients, 0, ulCells, &this->vOriginalManning[0] );
+		for ( unsigned char i = 0; i < 3; ++i )
+			this->invalidateStaging( i );
+		if ( !pSnapshot->vScalars.empty() )
+			std::memcpy( ( ucFloatSize == 4 ? (void*)this->fScalarValues : (void*)this->dScalarValues ), &pSnapshot->vScalars[0], pSnapshot->vScalars.size() );
+		return;
+	}
+
+	std::memcpy( ( ucFloatSize == 4 ? (void*)this->fCellStates : (void*)this->dCellStates ), &pSnapshot->vStates[0], pSnapshot->vStates.size() );
+	if ( !pSnapshot->vScalars.empty() )
+		std::memcpy( ( ucFloatSize == 4 ? (void*)this->fScalarValues : (void*)this->dScalarValues ), &pSnapshot->vScalars[0], pSnapshot->vScalars.size() );
+	std::memcpy( ( ucFloatSize == 4 ? (void*)this->fBedElevations : (void*)this->dBedElevations ), &this->vOriginalBed[0], this->vOriginalBed.size() );
+	std::memcpy( ( ucFloatSize == 4 ? (void*)this->fManningValues : (void*)this->dManningValues ), &this->vOriginalManning[0], this->vOriginalManning.size() );
+}
+
+/*
+ *  Had none of the cells been wet at any point up to the time of a snapshot?
+ *  The maximum free-surface level records every cell that has held water.
+ */
+bool	CDomain::isDryInSnapshot( unsigned int uiSnapshot, std::vector<unsigned long>* pCells )
+{
+	sSnapshot*	pSnapshot	= &this->vSnapshots[ uiSnapshot ];
+
+	for ( unsigned long i = 0; i < pCells->size(); ++i )
+	{
+		unsigned long	ulID	= (*pCells)[ i ];
+		double			dMaxFSL, dBed;
+
+		if ( ucFloatSize == 4 )
+		{
+			dMaxFSL	= reinterpret_cast<cl_float4*>( &pSnapshot->vStates[0] )[ ulID ].s[ model::domainValueIndices::kValueMaxFreeSurfaceLevel ];
+			dBed	= reinterpret_cast<cl_float*>( &this->vOriginalBed[0] )[ ulID ];
+		} else {
+			dMaxFSL	= reinterpret_cast<cl_double4*>( &pSnapshot->vStates[0] )[ ulID ].s[ model::domainValueIndices::kValueMaxFreeSurfaceLevel ];
+			dBed	= reinterpret_cast<cl_double*>( &this->vOriginalBed[0] )[ ulID ];
+		}
+
+		if ( dMaxFSL > -9999.0 && dMaxFSL - dBed > 1E-8 )
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ *  Set or adjust the bed elevation or Manning coefficient for a set of cells.
+ *  Water already in a cell keeps its depth when the bed moves.
+ */
+void	CDomain::modifyCells( std::vector<unsigned long>* pCells, unsigned char ucValue, bool bRelative, double dAmount )
+{
+	for ( unsigned long i = 0; i < pCells->size(); ++i )
+	{
+		unsigned long	ulID	= (*pCells)[ i ];
+		double			dMaxFSL	= this->getStateValue( ulID, model::domainValueIndices::kValueMaxFreeSurfaceLevel );
+
+		if ( dMaxFSL <= -9999.0 )
+			continue;
+
+		if ( ucValue == model::rasterDatasets::dataValues::kManningCoefficient )
+		{
+			this->setManningCoefficient( ulID, ( bRelative ? this->getManningCoefficient( ulID ) : 0.0 ) + dAmount );
+			continue;
+		}
+
+		double	dBed	= this->getBedElevation( ulID );
+		double	dDepth	= std::max( 0.0, this->getStateValue( ulID, model::domainValueIndices::kValueFreeSurfaceLevel ) - dBed );
+		double	dNewBed	= ( bRelative ? dBed : 0.0 ) + dAmount;
+
+		this->setBedElevation( ulID, dNewBed );
+		this->setStateValue( ulID, model::domainValueIndices::kValueFreeSurfaceLevel, dNewBed + dDepth );
+		this->setStateValue(
+			ulID,
+			model::domainValueIndices::kValueMaxFreeSurfaceLevel,
+			( dMaxFSL - dBed <= 1E-8 ? dNewBed + dDepth : std::max( dMaxFSL, dNewBed + dDepth ) )
+		);
+	}
+}
+
+/*
+ *  Set the output target dir
+ */
+void	CDomain::setTargetDir( std::string sTargetDir )
+{
+	delete [] this->cTargetDir;
+	this->cTargetDir = new char[ sTargetDir.length() + 1 ];
+	std::strcpy( this->cTargetDir, sTargetDir.c_str() );
+}
+
 /*
  *  Handle initial conditions input data for a cell (usually from a raster dataset)
  */
@@ -387,12 +868,30 @@ void	CDomain::handleInputData(
 			Util::round( dValue * ( this->getStateValue( ulCellID, model::domainValueIndices::kValueFreeSurfaceLevel ) - this->getBedElevation( ulCellID ) ), ucRounding )
 		);
 		break;
+	case model::rasterDatasets::dataValues::kConcentration:
+		if ( this->hasScalarValues() )
+		{
+			this->setScalarValue(
+				ulCellID,
+				Util::round( dValue * std::max( 0.0, this->getStateValue( ulCellID, model::domainValueIndices::kValueFreeSurfaceLevel ) - this->getBedElevation( ulCellID ) ), ucRounding )
+			);
+		}
+		break;
 	case model::rasterDatasets::dataValues::kManningCoefficient:
 		this->setManningCoefficient(
 			ulCellID,
 			Util::round( dValue, ucRounding )
 		);
 		break;
+	case model::rasterDatasets::dataValues::kDrainageCapacity:
+		if ( this->dDrainageValues != NULL )
+		{
+			this->setDrainageCapacity(
+				ulCellID,
+				Util::round( std::max( 0.0, dValue ), ucRounding )
+			);
+		}
+		break;
 	}
 }
 
@@ -497,6 +996,10 @@ unsigned char	CDomain::getDataValueCode( char* cSourceValue )
 		return model::rasterDatasets::dataValues::kMaxVelocity;
 	if ( strstr( cSourceValue, "froude" ) != NULL )
 		return model::rasterDatasets::dataValues::kFroudeNumber;
+	if ( strstr( cSourceValue, "concentration" ) != NULL )
+		return model::rasterDatasets::dataValues::kConcentration;
+	if ( strstr( cSourceValue, "drainagecapacity" ) != NULL )
+		return model::rasterDatasets::dataValues::kDrainageCapacity;
 
 	return 255;
 }
@@ -32,6 +32,13 @@ namespace domainValueIndices{ enum domainValueIndices {
 	kValueDischargeY						= 3		// Discharge Y
 }; }
 
+// Cell data arrays held on both the host and device
+namespace domainArrays{ enum domainArrays {
+	kArrayCellStates						= 0,	// Cell states (four components)
+	kArrayBedElevations						= 1,	// Bed elevations
+	kArrayManningCoefficients				= 2		// Manning coefficients
+}; }
+
 }
 
 // TODO: Make a CLocation class
@@ -67,16 +74,33 @@ class CDomain : public CDomainBase
 		virtual		void			logDetails() = 0;												// Log details about the domain
 		virtual		void			updateCellStatistics() = 0;										// Update the total number of cells calculation
 		virtual		void			writeOutputs() = 0;												// Write output files to disk
+		virtual		void			writePreview( double )	{};										// Write live preview images if due
 		void						createStoreBuffers( void**, void**, void**, unsigned char );	// Allocates memory and returns pointers to the three arrays
-		void						initialiseMemory();												// Populate cells with default values
+		void						createScalarStoreBuffer( void** );								// Allocates memory for the passive scalar and returns a pointer
+		void						createDrainageStoreBuffer( void** );							// Allocates memory for the drainage capacities and returns a pointer
+		void						releaseStoreBuffers();											// Free the host copies once they're held on the device
+		void						setHostMirrors( bool b )	{ bKeepHostMirrors = b; }			// Keep host copies of the cell data after upload?
+		bool						getHostMirrors()		{ return bKeepHostMirrors; }			// Should host copies of the cell data be kept?
+		bool						isHostMirrorReleased()	{ return bHostMirrorsReleased; }		// Are cell values being staged from the device instead?
+		void						invalidateStaging( unsigned char );								// Discard staged values after the device copy changes
+		void						flushStaging();													// Write staged changes back to the device
+		virtual		void			initialiseMemory();												// Populate cells with default values
+		virtual		unsigned long	getAllocatedCellCount()	{ return ulCellCount; };				// Number of cells held in memory, including any padding
 		void						handleInputData( unsigned long, double, unsigned char, unsigned char );	// Handle input data for varying state/static cell variables 
 		void						setBedElevation( unsigned long, double );						// Sets the bed elevation for a cell
 		void						setManningCoefficient( unsigned long, double );					// Sets the manning coefficient for a cell
 		void						setStateValue( unsigned long, unsigned char, double );			// Sets a state variable
+		void						setScalarValue( unsigned long, double );						// Sets the passive scalar mass per unit area
+		bool						hasScalarValues()		{ return ( dScalarValues != NULL ); }	// Is a passive scalar being transported?
+		void						setDrainageCapacity( unsigned long, double );					// Sets the drainage capacity for a cell (mm/hr)
+		void						setDrainage( bool b )	{ bDrainageCapacity = b; }				// Flag a drainage capacity dataSource for the scheme
+		bool						hasDrainageCapacity()	{ return bDrainageCapacity; }			// Does the domain have a drainage capacity dataSource?
 		bool						isDoublePrecision() { return ( ucFloatSize == 8 ); };				// Are we using double-precision?
 		double						getBedElevation( unsigned long );								// Gets the bed elevation for a cell
 		double						getManningCoefficient( unsigned long );							// Gets the manning coefficient for a cell
 		double						getStateValue( unsigned long, unsigned char );					// Gets a state variable
+		double						getScalarValue( unsigned long );								// Gets the passive scalar mass per unit area
+		double						getDrainageCapacity( unsigned long );							// Gets the drainage capacity for a cell (mm/hr)
 		double						getMaxFSL()				{ return dMaxFSL; }						// Fetch the maximum FSL in the domain
 		double						getMinFSL()				{ return dMinFSL; }						// Fetch the minimum FSL in the domain
 		virtual double				getVolume();													// Calculate the total volume in all the cells
@@ -84,6 +108,14 @@ class CDomain : public CDomainBase
 		unsigned int				getID()					{ return uiID; }						// Get the ID number
 		void						setID( unsigned int i ) { uiID = i; }							// Set the ID number
 		virtual mpiSignalDataProgress getDataProgress();											// Fetch some data on this domain's progress
+		void						saveSnapshot( double );											// Retain a copy of the cell states at a given time
+		void						restoreSnapshot( unsigned int );								// Return to a snapshot, with the original bed and Manning values
+		unsigned int				getSnapshotCount()		{ return static_cast<unsigned int>( vSnapshots.size() ); }	// Number of snapshots retained
+		double						getSnapshotTime( unsigned int i ) { return vSnapshots[ i ].dTime; }	// Time at which a snapshot was taken
+		bool						isDryInSnapshot( unsigned int, std::vector<unsigned long>* );	// Had none of the cells been wet by the time of a snapshot?
+		void						modifyCells( std::vector<unsigned long>*, unsigned char, bool, double );	// Set or adjust the bed elevation or Manning coefficient of cells
+		void						setTargetDir( std::string );									// Set the output target dir
+		std::string					getTargetDir()			{ return ( cTargetDir == NULL ? "" : std::string( cTargetDir ) ); }	// Get the output target dir
 
 		void						setScheme( CScheme* );											// Set the scheme running for this domain
 		CScheme*					getScheme();													// Get the scheme running for this domain
@@ -96,6 +128,21 @@ class CDomain : public CDomainBase
 
 	protected:
 
+		// Private structures
+		struct sSnapshot
+		{
+			double				dTime;																// Simulation time of the snapshot
+			std::vector<char>	vStates;															// Raw copy of the cell states
+			std::vector<char>	vScalars;															// Raw copy of the passive scalar, if any
+		};
+		struct sStagingArea
+		{
+			unsigned long		ulStart;															// First cell held
+			unsigned long		ulLength;															// Number of cells held (none if invalid)
+			bool				bDirty;																// Changed on the host since being read?
+			std::vector<char>	vData;																// Raw copy of the cells held
+		};
+
 		// Private variables
 		unsigned char		ucFloatSize;															// Size of floats used for cell data (bytes)
 		char*				cSourceDir;																// Data source dir
@@ -106,6 +153,11 @@ class CDomain : public CDomainBase
 		cl_float4*			fCellStates;															// Heap for cell state date (single)
 		cl_float*			fBedElevations;															// Heap for bed elevations (single)
 		cl_float*			fManningValues;															// Heap for manning values (single)
+		cl_double*			dScalarValues;															// Heap for passive scalar mass per unit area
+		cl_float*			fScalarValues;															// Heap for passive scalar mass per unit area (single)
+		cl_double*			dDrainageValues;														// Heap for drainage capacities
+		cl_float*			fDrainageValues;														// Heap for drainage capacities (single)
+		bool				bDrainageCapacity;														// Drainage capacity dataSource present?
 
 		cl_double			dMinFSL;																// Min and max FSLs in the domain used for rendering
 		cl_double			dMaxFSL;
@@ -117,9 +169,18 @@ class CDomain : public CDomainBase
 		CBoundaryMap*		pBoundaries;															// Boundary map (management)
 		CScheme*			pScheme;																// Scheme we are running for this particular domain
 		COCLDevice*			pDevice;																// Device responsible for running this domain
+		std::vector<sSnapshot>	vSnapshots;															// Cell states retained for branching re-simulation
+		std::vector<char>	vOriginalBed;															// Bed elevations when the first snapshot was taken
+		std::vector<char>	vOriginalManning;														// Manning coefficients when the first snapshot was taken
+		bool				bKeepHostMirrors;														// Keep the host copies after upload?
+		bool				bHostMirrorsReleased;													// Host copies freed, so values are staged from the device
+		unsigned long		ulStagingCells;															// Cells held in each staging area
+		sStagingArea		pStaging[ 3 ];															// Window onto each array when the host copies are released
 
 		// Private functions
 		unsigned char		getDataValueCode( char* );												// Get a raster dataset code from text description
+		void*				getStagedCell( unsigned char, unsigned long );							// Fetch a cell from the device through a staging area
+		void				flushStaging( unsigned char );											// Write one staging area back to the device if changed
 };
 
 #endif
@@ -154,7 +154,9 @@ CDomainLink* CDomainBase::getLinkFrom( unsigned int uiSourceDomainID )
 unsigned long	CDomainBase::getCellID(unsigned long ulX, unsigned long ulY)
 {
 	DomainSummary pSummary = this->getSummary();
-	return (ulY * pSummary.ulColCount) + ulX;
+	if ( pSummary.ulRowPitch == 0 )
+		return (ulY * pSummary.ulColCount) + ulX;
+	return ((ulY + pSummary.ucGhostCells + 1) * pSummary.ulRowPitch) + ulX;
 }
 
 /*
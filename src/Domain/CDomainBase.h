@@ -64,6 +64,8 @@ class CDomainBase
 			double			dResolution;
 			unsigned long	ulRowCount;
 			unsigned long	ulColCount;
+			unsigned long	ulRowPitch;
+			unsigned char	ucGhostCells;
 			unsigned char	ucFloatPrecision;
 		};
 
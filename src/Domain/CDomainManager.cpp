@@ -16,6 +16,9 @@
  * ------------------------------------------
  *
  */
+#include <algorithm>
+#include <cmath>
+
 #include "../common.h"
 #include "CDomainManager.h"
 #include "CDomainBase.h"
@@ -37,6 +40,9 @@ CDomainManager::CDomainManager(void)
 {
 	this->ucSyncMethod = model::syncMethod::kSyncForecast;
 	this->uiSyncSpareIterations = 3;
+	this->dSyncLagSafety = 0.0;
+	this->uiIndexCols = 0;
+	this->uiIndexRows = 0;
 }
 
 /*
@@ -60,6 +66,7 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 	char			*cParameterValue	= NULL;
 	char			*cSyncMethodName    = NULL;
 	char			*cSyncSpareIterations = NULL;
+	char			*cSyncLagSafety		= NULL;
 
 	// Have we defined a synchronisation method for multi-domains?
 	Util::toLowercase(&cSyncMethodName, pXNode->Attribute("syncMethod"));
@@ -99,6 +106,25 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 		}
 	}
 
+	// Should timestep synchronisation reduce the global timestep one batch behind?
+	Util::toLowercase(&cSyncLagSafety, pXNode->Attribute("syncLagSafety"));
+	if (cSyncLagSafety != NULL)
+	{
+		if ( CXMLDataset::isValidFloat(cSyncLagSafety) &&
+			 boost::lexical_cast<double>(cSyncLagSafety) > 0.0 &&
+			 boost::lexical_cast<double>(cSyncLagSafety) <= 1.0 )
+		{
+			this->setSyncLagSafety(boost::lexical_cast<double>(cSyncLagSafety));
+		}
+		else
+		{
+			model::doError(
+				"Invalid synchronisation lag safety factor given.",
+				model::errorCodes::kLevelWarning
+			);
+		}
+	}
+
 	// TODO: Ditch <parameter> for the domainSet?
 	/*
 	while ( pParameter != NULL )
@@ -170,6 +196,7 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 	XMLElement*		pXDomain			= pXNode->FirstChildElement( "domain" );
 	char			*cDomainType		= NULL;
 	char			*cDomainDevice		= NULL;
+	unsigned int	uiAutoDevice		= 0;
 
 	while ( pXDomain != NULL )
 	{
@@ -190,6 +217,41 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 				);
 				return false;
 			}
+			else if (strcmp(cDomainDevice, "auto") == 0)
+			{
+#ifdef MPI_ON
+				model::doError(
+					"Automatic device assignment is not available across MPI.",
+					model::errorCodes::kLevelModelStop
+				);
+				return false;
+#else
+				// Spread the domains over the fastest devices first
+				COCLDevice* pAutoDevice = pManager->getExecutor()->getRankedDevice(uiAutoDevice++);
+				if (pAutoDevice == NULL)
+				{
+					model::doError(
+						"No suitable devices could be found for running this model.",
+						model::errorCodes::kLevelModelStop
+					);
+					return false;
+				}
+
+				pManager->log->writeLine("Creating a new Cartesian-structured domain.");
+				pDomainNew = CDomainBase::createDomain(model::domainStructureTypes::kStructureCartesian);
+				pManager->log->writeLine("Assigning domain automatically to device #" + toString(pAutoDevice->getDeviceID()) + ".");
+				static_cast<CDomain*>(pDomainNew)->setDevice(pAutoDevice);
+
+				if (!pDomainNew->configureDomain(pXDomain))
+					return false;
+
+				pDomainNew->setID( getDomainCount() );
+				domains.push_back( pDomainNew );
+
+				pXDomain = pXDomain->NextSiblingElement( "domain" );
+				continue;
+#endif
+			}
 			else {
 				if (!CXMLDataset::isValidUnsignedInt(std::string(cDomainDevice)))
 				{
@@ -257,6 +319,7 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 
 	// Generate links
 	this->generateLinks();
+	this->generateIndex();
 
 	// Spit out some details
 	this->logDetails();
@@ -275,6 +338,16 @@ bool CDomainManager::setupFromConfig( XMLElement* pXNode )
 				);
 				return false;
 			}
+
+			// Links only exchange the hydrodynamic state, so a scalar would stop at the boundary
+			if (!domains[i]->isRemote() && static_cast<CDomain*>(domains[i])->hasScalarValues())
+			{
+				model::doError(
+					"Scalar transport is not available with linked domains.",
+					model::errorCodes::kLevelModelStop
+				);
+				return false;
+			}
 		}
 	}
 
@@ -322,10 +395,27 @@ CDomain*	CDomainManager::getDomain(unsigned int uiID)
 }
 
 /*
- *  Fetch a specific domain by a point therein
+ *  Fetch a specific domain by a point therein, preferring the finest where nested
  */
 CDomain*	CDomainManager::getDomain(double dX, double dY)
 {
+	if ( this->vIndexBuckets.empty() ||
+		 dX < pIndexExtent.W || dX > pIndexExtent.E ||
+		 dY < pIndexExtent.S || dY > pIndexExtent.N )
+		return NULL;
+
+	unsigned int uiCol = std::min( this->uiIndexCols - 1, static_cast<unsigned int>( ( dX - pIndexExtent.W ) / ( pIndexExtent.E - pIndexExtent.W ) * this->uiIndexCols ) );
+	unsigned int uiRow = std::min( this->uiIndexRows - 1, static_cast<unsigned int>( ( dY - pIndexExtent.S ) / ( pIndexExtent.N - pIndexExtent.S ) * this->uiIndexRows ) );
+	std::vector<unsigned int>* pBucket = &this->vIndexBuckets[ uiRow * this->uiIndexCols + uiCol ];
+
+	for ( unsigned int i = 0; i < pBucket->size(); i++ )
+	{
+		Bounds* pBounds = &this->vIndexBounds[ (*pBucket)[i] ];
+		if ( dX >= pBounds->W && dX <= pBounds->E &&
+			 dY >= pBounds->S && dY <= pBounds->N )
+			return this->getDomain( (*pBucket)[i] );
+	}
+
 	return NULL;
 }
 
@@ -343,14 +433,77 @@ unsigned int	CDomainManager::getDomainCount()
 CDomainManager::Bounds		CDomainManager::getTotalExtent()
 {
 	CDomainManager::Bounds	b;
-	// TODO: Calculate the total extent
-	b.N = NULL;
-	b.E = NULL;
-	b.S = NULL;
-	b.W = NULL;
+	b.N = 0.0;
+	b.E = 0.0;
+	b.S = 0.0;
+	b.W = 0.0;
+
+	for ( unsigned int i = 0; i < domains.size(); i++ )
+	{
+		CDomainBase::DomainSummary pSummary = domains[i]->getSummary();
+		b.N = ( i == 0 ? pSummary.dEdgeNorth : std::max( b.N, pSummary.dEdgeNorth ) );
+		b.E = ( i == 0 ? pSummary.dEdgeEast  : std::max( b.E, pSummary.dEdgeEast ) );
+		b.S = ( i == 0 ? pSummary.dEdgeSouth : std::min( b.S, pSummary.dEdgeSouth ) );
+		b.W = ( i == 0 ? pSummary.dEdgeWest  : std::min( b.W, pSummary.dEdgeWest ) );
+	}
+
 	return b;
 }
 
+/*
+ *  Bucket the domains on a regular grid over their total extent, so a lookup by
+ *  coordinate only tests the few domains near the point. Each bucket lists the
+ *  finest domains first so a nest is found before the domain containing it.
+ */
+void	CDomainManager::generateIndex()
+{
+	this->vIndexBuckets.clear();
+	this->vIndexBounds.clear();
+
+	if ( domains.size() < 1 )
+		return;
+
+	// Roughly one bucket for each domain
+	this->pIndexExtent	= this->getTotalExtent();
+	this->uiIndexCols	= static_cast<unsigned int>( ceil( sqrt( static_cast<double>( domains.size() ) ) ) );
+	this->uiIndexRows	= this->uiIndexCols;
+	this->vIndexBuckets.resize( this->uiIndexCols * this->uiIndexRows );
+
+	std::vector<double>			vResolutions;
+	std::vector<unsigned int>	vOrder;
+	for ( unsigned int i = 0; i < domains.size(); i++ )
+	{
+		CDomainBase::DomainSummary pSummary = domains[i]->getSummary();
+		Bounds pBounds;
+		pBounds.N = pSummary.dEdgeNorth;
+		pBounds.E = pSummary.dEdgeEast;
+		pBounds.S = pSummary.dEdgeSouth;
+		pBounds.W = pSummary.dEdgeWest;
+		this->vIndexBounds.push_back( pBounds );
+		vResolutions.push_back( pSummary.dResolution );
+		vOrder.push_back( i );
+	}
+
+	std::stable_sort( vOrder.begin(), vOrder.end(),
+		[&vResolutions]( unsigned int a, unsigned int b ) { return vResolutions[a] < vResolutions[b]; } );
+
+	double dCellWidth	= ( pIndexExtent.E - pIndexExtent.W ) / this->uiIndexCols;
+	double dCellHeight	= ( pIndexExtent.N - pIndexExtent.S ) / this->uiIndexRows;
+
+	for ( unsigned int i = 0; i < vOrder.size(); i++ )
+	{
+		Bounds* pBounds = &this->vIndexBounds[ vOrder[i] ];
+		unsigned int uiColStart	= ( dCellWidth  > 0.0 ? std::min( this->uiIndexCols - 1, static_cast<unsigned int>( ( pBounds->W - pIndexExtent.W ) / dCellWidth ) ) : 0 );
+		unsigned int uiColEnd	= ( dCellWidth  > 0.0 ? std::min( this->uiIndexCols - 1, static_cast<unsigned int>( ( pBounds->E - pIndexExtent.W ) / dCellWidth ) ) : 0 );
+		unsigned int uiRowStart	= ( dCellHeight > 0.0 ? std::min( this->uiIndexRows - 1, static_cast<unsigned int>( ( pBounds->S - pIndexExtent.S ) / dCellHeight ) ) : 0 );
+		unsigned int uiRowEnd	= ( dCellHeight > 0.0 ? std::min( this->uiIndexRows - 1, static_cast<unsigned int>( ( pBounds->N - pIndexExtent.S ) / dCellHeight ) ) : 0 );
+
+		for ( unsigned int uiRow = uiRowStart; uiRow <= uiRowEnd; uiRow++ )
+			for ( unsigned int uiCol = uiColStart; uiCol <= uiColEnd; uiCol++ )
+				this->vIndexBuckets[ uiRow * this->uiIndexCols + uiCol ].push_back( vOrder[i] );
+	}
+}
+
 /*
  *  Write all of the domain data to disk
  */
@@ -365,6 +518,20 @@ void	CDomainManager::writeOutputs()
 	}
 }
 
+/*
+ *  Write live preview images for each local domain if they're due
+ */
+void	CDomainManager::writePreviews( double dRealTime )
+{
+	for( unsigned int i = 0; i < domains.size(); i++ )
+	{
+		if (!domains[i]->isRemote())
+		{
+			getDomain(i)->writePreview( dRealTime );
+		}
+	}
+}
+
 /*
 *	Fetch the current sync method being employed
 */
@@ -397,6 +564,24 @@ void CDomainManager::setSyncBatchSpares(unsigned int uiSpare)
 	this->uiSyncSpareIterations = uiSpare;
 }
 
+/*
+*	Fetch the safety factor for a lagged timestep reduction (zero if not lagged)
+*/
+double CDomainManager::getSyncLagSafety()
+{
+	if (this->ucSyncMethod != model::syncMethod::kSyncTimestep)
+		return 0.0;
+	return this->dSyncLagSafety;
+}
+
+/*
+*	Set the safety factor applied to the lagged global timestep
+*/
+void CDomainManager::setSyncLagSafety(double dSafety)
+{
+	this->dSyncLagSafety = dSafety;
+}
+
 /*
  *  Are all the domains contiguous?
  */
@@ -434,6 +619,18 @@ void	CDomainManager::generateLinks()
 		domains[i]->clearLinks();
 	}
 
+	// A nested domain only links with the finest of the domains containing it
+	std::vector<int> vNestParent( domains.size(), -1 );
+	for (unsigned int i = 0; i < domains.size(); i++)
+	{
+		for (unsigned int j = 0; j < domains.size(); j++)
+		{
+			if (i != j && CDomainLink::canNest(domains[j], domains[i]) &&
+				(vNestParent[i] < 0 || domains[j]->getSummary().dResolution < domains[vNestParent[i]]->getSummary().dResolution))
+				vNestParent[i] = j;
+		}
+	}
+
 	for (unsigned int i = 0; i < domains.size(); i++)
 	{
 		for (unsigned int j = 0; j < domains.size(); j++)
@@ -441,6 +638,10 @@ void	CDomainManager::generateLinks()
 			// Must overlap and meet our various constraints
 			if (i != j && CDomainLink::canLink(domains[i], domains[j]))
 			{
+				if (domains[i]->getSummary().dResolution != domains[j]->getSummary().dResolution &&
+					vNestParent[i] != static_cast<int>(j) && vNestParent[j] != static_cast<int>(i))
+					continue;
+
 				// Make a new link...
 				CDomainLink* pNewLink = new CDomainLink(domains[i], domains[j]);
 				domains[i]->addLink(pNewLink);
@@ -471,7 +672,11 @@ void	CDomainManager::logDetails()
 			pManager->log->writeLine("    Forecast method: Aiming for " + toString(this->uiSyncSpareIterations) + " spare row(s)", true, wColour);
 		}
 		if (this->getSyncMethod() == model::syncMethod::kSyncTimestep)
+		{
 			pManager->log->writeLine("  Synchronisation:   Explicit timestep exchange", true, wColour);
+			if (this->getSyncLagSafety() > 0.0)
+				pManager->log->writeLine("    Lagged method:   Reduced per batch with safety factor " + toString(this->dSyncLagSafety), true, wColour);
+		}
 	}
 
 	pManager->log->writeLine("", false, wColour);
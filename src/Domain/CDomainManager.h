@@ -55,6 +55,7 @@ class CDomainManager
 		// Public functions
 		bool					setupFromConfig( XMLElement* );										// Set up the domain set
 		void					writeOutputs();														// Output each domain to disk if required
+		void					writePreviews( double );											// Write live previews for each domain if due
 		bool					isDomainLocal(unsigned int);										// Is this domain local to this node?
 		CDomainBase*			getDomainBase(unsigned int);										// Fetch a domain base by ID
 		CDomain*				getDomain( unsigned int );											// Fetch a domain by ID
@@ -67,6 +68,8 @@ class CDomainManager
 		unsigned char			getSyncMethod();													// Fetch sync method
 		void					setSyncBatchSpares(unsigned int);									// Set batch spares to aim for
 		unsigned int			getSyncBatchSpares();												// Fetch batch spares to aim for
+		void					setSyncLagSafety(double);											// Set lagged timestep safety factor
+		double					getSyncLagSafety();													// Fetch lagged timestep safety factor (zero if not lagged)
 		bool					isSetContiguous();													// Are all of the domains contiguous
 		bool					isSetReady();														// Is the set of domains ready?
 		void					logDetails();														// Spit out some information
@@ -78,10 +81,17 @@ class CDomainManager
 		std::vector<CDomainBase*> domains;															// Vector of all the domains we hold
 		unsigned char			ucSyncMethod;														// Method of domain synchronisation
 		unsigned int			uiSyncSpareIterations;												// Aim for # spare iterations when synchronising
+		double					dSyncLagSafety;														// Safety factor on a global timestep reduced a batch behind
+		std::vector< std::vector<unsigned int> > vIndexBuckets;										// Domains overlapping each cell of the spatial index, finest first
+		std::vector<Bounds>		vIndexBounds;														// Extent of each domain in the spatial index
+		Bounds					pIndexExtent;														// Extent covered by the spatial index
+		unsigned int			uiIndexCols;														// Columns in the spatial index
+		unsigned int			uiIndexRows;														// Rows in the spatial index
 
 		// Private functions
 		CDomainBase*			createNewDomain( unsigned char );									// Add a new domain
 		CDomainBase*			createNewDomain( unsigned char, XMLElement* );						// Add a new domain and configure it
+		void					generateIndex();													// Bucket the domains for lookups by coordinate
 
 };
 
@@ -21,6 +21,7 @@
 #include <cstring>
 #include <boost/lexical_cast.hpp>
 #include <math.h>
+#include <algorithm>
 #include "../../common.h"
 #include "../../main.h"
 #include "../../CModel.h"
@@ -29,6 +30,7 @@
 #include "../../Schemes/CScheme.h"
 #include "../../Datasets/CXMLDataset.h"
 #include "../../Datasets/CRasterDataset.h"
+#include "../../General/CTaskGraph.h"
 #include "../../OpenCL/Executors/CExecutorControlOpenCL.h"
 #include "../../Boundaries/CBoundaryMap.h"
 #include "../../MPI/CMPIManager.h"
@@ -51,8 +53,20 @@ CDomainCartesian::CDomainCartesian(void)
 	this->dRealOffset[kAxisY]		= std::numeric_limits<double>::quiet_NaN();
 	this->cUnits[0]					= 0;
 	this->ulProjectionCode			= 0;
+	this->ucGhostCells				= 1;
+	this->ulRowPitch				= 0;
+	this->ulPaddedRows				= 0;
 	this->cTargetDir				= NULL;
 	this->cSourceDir				= NULL;
+
+	this->pPreview.bEnabled			= false;
+	this->pPreview.cFormat			= NULL;
+	this->pPreview.dInterval		= 10.0;
+	this->pPreview.dScale			= 1.0;
+	this->pPreview.dLastPreview		= 0.0;
+	this->pPreview.uiSize			= 1024;
+	this->pPreview.uiLevels			= 1;
+	this->pPreview.uiStride			= 1;
 }
 
 /*
@@ -71,6 +85,7 @@ bool CDomainCartesian::configureDomain( XMLElement* pXDomain )
 	XMLElement* pXData;
 	XMLElement* pXScheme;
 	XMLElement* pXDataSource;
+	XMLElement* pXSpinUp;
 
 	char	*cSourceType = NULL,
 			*cSourceValue = NULL,
@@ -112,13 +127,13 @@ bool CDomainCartesian::configureDomain( XMLElement* pXDomain )
 			pDataset.applyDimensionsToDomain( this );
 		}
 
+		// The scheme needs to know about a drainage capacity before it allocates memory
+		if ( this->getDataValueCode( cSourceValue ) == model::rasterDatasets::dataValues::kDrainageCapacity )
+			this->setDrainage( true );
+
 		pXDataSource = pXDataSource->NextSiblingElement("dataSource");
 	}
 
-	pManager->log->writeLine( "Progressing to load boundary conditions." );
-	if ( !this->getBoundaries()->setupFromConfig( pXDomain ) )
-		return false;
-
 	pXScheme = pXDomain->FirstChildElement( "scheme" );
 	if ( pXScheme == NULL )
 	{
@@ -127,29 +142,54 @@ bool CDomainCartesian::configureDomain( XMLElement* pXDomain )
 			model::errorCodes::kLevelWarning
 		);
 		return false;
-	} else {
+	}
+
+	// Building the program takes as long as reading the rasters on big
+	// models, and neither needs the other
+	CTaskGraph	pStartup( "Domain start-up" );
+	unsigned int uiBoundaries = pStartup.addTask( "Boundary conditions", [this, pXDomain]() {
+		pManager->log->writeLine( "Progressing to load boundary conditions." );
+		return this->getBoundaries()->setupFromConfig( pXDomain );
+	} );
+	unsigned int uiSetup = pStartup.addTask( "Scheme setup", [this, pXScheme]() {
 		pScheme = CScheme::createFromConfig( pXScheme );
 		pScheme->setupFromConfig( pXScheme );
 		pScheme->setDomain( this );
-		pScheme->prepareAll();
 		setScheme( pScheme );
+		return pScheme->prepareSetup();
+	}, { uiBoundaries } );
+	unsigned int uiProgram = pStartup.addTask( "Program build", [this]() {
+		return pScheme->prepareProgram();
+	}, { uiSetup } );
+	unsigned int uiInitial = pStartup.addTask( "Initial conditions", [this, pXData]() {
+		pManager->log->writeLine( "Progressing to load initial conditions." );
+		return this->loadInitialConditions( pXData );
+	}, { uiSetup } );
+	pStartup.addTask( "Kernels and boundary buffers", [this]() {
+		return pScheme->prepareFinish();
+	}, { uiProgram, uiInitial } );
+
+	bool bStarted = pStartup.run();
+	pStartup.logCriticalPath();
+
+	if ( !bStarted || !pScheme->isReady() )
+	{
+		model::doError(
+			"Domain start-up did not complete. Check errors.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+	pManager->log->writeLine( "Numerical scheme reports it is ready." );
 
-		if ( !pScheme->isReady() )
-		{
-			model::doError(
-				"Numerical scheme is not ready. Check errors.",
-				model::errorCodes::kLevelWarning
-			);
+	pXSpinUp = pXDomain->FirstChildElement( "spinUp" );
+	if ( pXSpinUp != NULL )
+	{
+		pManager->log->writeLine( "Progressing to spin up initial conditions on a coarse grid." );
+		if ( !this->spinUpCoarse( pXDomain, pXSpinUp ) )
 			return false;
-		} else {
-			pManager->log->writeLine( "Numerical scheme reports it is ready." );
-		}
 	}
 
-	pManager->log->writeLine( "Progressing to load initial conditions." );
-	if ( !this->loadInitialConditions( pXData ) )
-		return false;
-
 	pManager->log->writeLine( "Progressing to load output file definitions." );
 	if ( !this->loadOutputDefinitions( pXData ) )
 		return false;
@@ -282,6 +322,331 @@ bool	CDomainCartesian::loadInitialConditions( XMLElement* pXData )
 	return true;
 }
 
+/*
+ *  Spin the model up to a steady state on a coarsened copy of this domain, then
+ *  carry the converged state back onto this grid as its initial conditions. The
+ *  coarse cells hold the mean bed, Manning coefficient and depth of the valid
+ *  cells they cover, and each block of cells gets its coarse volume back with
+ *  a flat surface and the coarse velocity, so no water is gained or lost.
+ */
+bool	CDomainCartesian::spinUpCoarse( XMLElement* pXDomain, XMLElement* pXSpinUp )
+{
+	unsigned int	uiFactor		= 4;
+	double			dTolerance		= 1E-4;
+	double			dInterval		= 600.0;
+	double			dMaxDuration	= 86400.0;
+	unsigned char	ucRounding		= 6;
+
+	char	*cFactor = NULL,
+			*cTolerance = NULL,
+			*cInterval = NULL,
+			*cMaxDuration = NULL;
+
+	Util::toNewString( &cFactor,		pXSpinUp->Attribute( "coarsening" ) );
+	Util::toNewString( &cTolerance,		pXSpinUp->Attribute( "tolerance" ) );
+	Util::toNewString( &cInterval,		pXSpinUp->Attribute( "checkInterval" ) );
+	Util::toNewString( &cMaxDuration,	pXSpinUp->Attribute( "maxDuration" ) );
+
+	if ( cFactor != NULL )
+	{
+		if ( !CXMLDataset::isValidUnsignedInt( cFactor ) ||
+			 boost::lexical_cast<unsigned int>( cFactor ) < 2 )
+		{
+			model::doError(
+				"Spin-up coarsening factor must be a whole number of at least 2.",
+				model::errorCodes::kLevelWarning
+			);
+			return false;
+		}
+		uiFactor = boost::lexical_cast<unsigned int>( cFactor );
+	}
+	if ( cTolerance != NULL )
+	{
+		if ( !CXMLDataset::isValidFloat( cTolerance ) ||
+			 boost::lexical_cast<double>( cTolerance ) <= 0.0 )
+		{
+			model::doError(
+				"Spin-up tolerance must be a positive number.",
+				model::errorCodes::kLevelWarning
+			);
+			return false;
+		}
+		dTolerance = boost::lexical_cast<double>( cTolerance );
+	}
+	if ( cInterval != NULL )
+	{
+		if ( !CXMLDataset::isValidFloat( cInterval ) ||
+			 boost::lexical_cast<double>( cInterval ) <= 0.0 )
+		{
+			model::doError(
+				"Spin-up check interval must be a positive number of seconds.",
+				model::errorCodes::kLevelWarning
+			);
+			return false;
+		}
+		dInterval = boost::lexical_cast<double>( cInterval );
+	}
+	if ( cMaxDuration != NULL )
+	{
+		if ( !CXMLDataset::isValidFloat( cMaxDuration ) ||
+			 boost::lexical_cast<double>( cMaxDuration ) <= 0.0 )
+		{
+			model::doError(
+				"Spin-up maximum duration must be a positive number of seconds.",
+				model::errorCodes::kLevelWarning
+			);
+			return false;
+		}
+		dMaxDuration = boost::lexical_cast<double>( cMaxDuration );
+	}
+
+	delete [] cFactor;
+	delete [] cTolerance;
+	delete [] cInterval;
+	delete [] cMaxDuration;
+
+	// Only uniform boundaries apply the same way on the coarse grid, as cell,
+	// gridded and structure boundaries are located on this domain's cells
+	XMLElement*	pXBoundaries	= pXDomain->FirstChildElement( "boundaryConditions" );
+	bool		bLocated		= false;
+
+	if ( pXBoundaries != NULL )
+	{
+		bLocated = ( pXBoundaries->FirstChildElement( "structure" ) != NULL );
+
+		XMLElement*	pXTimeseries = pXBoundaries->FirstChildElement( "timeseries" );
+		while ( pXTimeseries != NULL && !bLocated )
+		{
+			char*	cBoundaryType = NULL;
+			Util::toLowercase( &cBoundaryType, pXTimeseries->Attribute( "type" ) );
+
+			if ( cBoundaryType != NULL &&
+				 strcmp( cBoundaryType, "atmospheric" ) != 0 &&
+				 strcmp( cBoundaryType, "uniform" ) != 0 )
+				bLocated = true;
+
+			delete [] cBoundaryType;
+			pXTimeseries = pXTimeseries->NextSiblingElement( "timeseries" );
+		}
+	}
+
+	if ( bLocated )
+	{
+		model::doError(
+			"Spin-up is only available with uniform boundary conditions.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	// Dimension the coarse domain over the same lower-left corner, rounding
+	// the number of rows and columns up so every cell here is covered
+	unsigned long	ulCoarseCols	= ( this->ulCols + uiFactor - 1 ) / uiFactor;
+	unsigned long	ulCoarseRows	= ( this->ulRows + uiFactor - 1 ) / uiFactor;
+	double			dCoarseRes		= this->dCellResolution * uiFactor;
+
+	// Domain IDs run from zero in the order of the configuration, so the
+	// count of domains there is never used by a real one
+	unsigned int	uiCoarseID		= 0;
+	for ( XMLElement* pXSibling = pXDomain->Parent()->FirstChildElement( "domain" );
+		  pXSibling != NULL;
+		  pXSibling = pXSibling->NextSiblingElement( "domain" ) )
+		uiCoarseID++;
+
+	CDomainCartesian*	pCoarse		= new CDomainCartesian();
+	pCoarse->setID( uiCoarseID );
+	pCoarse->setDevice( this->pDevice );
+	pCoarse->setProjectionCode( this->ulProjectionCode );
+	pCoarse->setUnits( this->cUnits );
+	pCoarse->setCellResolution( dCoarseRes );
+	pCoarse->setRealDimensions( dCoarseRes * ulCoarseCols, dCoarseRes * ulCoarseRows );
+	pCoarse->setRealOffset( this->dRealOffset[ kAxisX ], this->dRealOffset[ kAxisY ] );
+	pCoarse->setRealExtent( this->dRealOffset[ kAxisY ] + dCoarseRes * ulCoarseRows,
+							this->dRealOffset[ kAxisX ] + dCoarseRes * ulCoarseCols,
+							this->dRealOffset[ kAxisY ],
+							this->dRealOffset[ kAxisX ] );
+
+	pManager->log->writeLine( "Spin-up grid is " + toString( ulCoarseCols ) + " x " + toString( ulCoarseRows ) +
+		" cells at a resolution of " + toString( dCoarseRes ) + "." );
+
+	// Same boundary conditions and numerical scheme as this domain
+	if ( !pCoarse->getBoundaries()->setupFromConfig( pXDomain ) )
+	{
+		delete pCoarse;
+		return false;
+	}
+
+	CScheme*	pCoarseScheme	= CScheme::createFromConfig( pXDomain->FirstChildElement( "scheme" ) );
+	pCoarseScheme->setupFromConfig( pXDomain->FirstChildElement( "scheme" ) );
+	pCoarseScheme->setDomain( pCoarse );
+	pCoarse->setDrainage( this->hasDrainageCapacity() );
+	pCoarseScheme->prepareAll();
+	pCoarse->setScheme( pCoarseScheme );
+
+	if ( !pCoarseScheme->isReady() )
+	{
+		model::doError(
+			"Numerical scheme for the spin-up grid is not ready. Check errors.",
+			model::errorCodes::kLevelWarning
+		);
+		delete pCoarse;
+		return false;
+	}
+
+	// Aggregate the initial conditions already loaded here onto the coarse grid
+	for ( unsigned long ulCY = 0; ulCY < ulCoarseRows; ++ulCY )
+	{
+		for ( unsigned long ulCX = 0; ulCX < ulCoarseCols; ++ulCX )
+		{
+			unsigned long	ulCoarseID	= pCoarse->getCellID( ulCX, ulCY );
+			unsigned long	ulValid		= 0;
+			double			dBed = 0.0, dManning = 0.0, dDepth = 0.0, dDischargeX = 0.0, dDischargeY = 0.0, dDrainage = 0.0;
+
+			for ( unsigned long ulY = ulCY * uiFactor; ulY < std::min( ( ulCY + 1 ) * uiFactor, this->ulRows ); ++ulY )
+			{
+				for ( unsigned long ulX = ulCX * uiFactor; ulX < std::min( ( ulCX + 1 ) * uiFactor, this->ulCols ); ++ulX )
+				{
+					unsigned long ulID = this->getCellID( ulX, ulY );
+					if ( this->getBedElevation( ulID ) <= -9999.0 ||
+						 this->getStateValue( ulID, model::domainValueIndices::kValueMaxFreeSurfaceLevel ) <= -9999.0 )
+						continue;
+
+					dBed		+= this->getBedElevation( ulID );
+					dManning	+= this->getManningCoefficient( ulID );
+					dDepth		+= std::max( 0.0, this->getStateValue( ulID, model::domainValueIndices::kValueFreeSurfaceLevel ) - this->getBedElevation( ulID ) );
+					dDischargeX	+= this->getStateValue( ulID, model::domainValueIndices::kValueDischargeX );
+					dDischargeY	+= this->getStateValue( ulID, model::domainValueIndices::kValueDischargeY );
+					dDrainage	+= this->getDrainageCapacity( ulID );
+					ulValid++;
+				}
+			}
+
+			if ( ulValid == 0 )
+			{
+				pCoarse->setStateValue( ulCoarseID, model::domainValueIndices::kValueMaxFreeSurfaceLevel, -9999.0 );
+				continue;
+			}
+
+			pCoarse->handleInputData( ulCoarseID, dBed / ulValid,			model::rasterDatasets::dataValues::kBedElevation,		ucRounding );
+			pCoarse->handleInputData( ulCoarseID, dDepth / ulValid,			model::rasterDatasets::dataValues::kDepth,				ucRounding );
+			pCoarse->handleInputData( ulCoarseID, dManning / ulValid,		model::rasterDatasets::dataValues::kManningCoefficient,	ucRounding );
+			pCoarse->handleInputData( ulCoarseID, dDischargeX / ulValid,	model::rasterDatasets::dataValues::kDischargeX,			ucRounding );
+			pCoarse->handleInputData( ulCoarseID, dDischargeY / ulValid,	model::rasterDatasets::dataValues::kDischargeY,			ucRounding );
+			pCoarse->handleInputData( ulCoarseID, dDrainage / ulValid,		model::rasterDatasets::dataValues::kDrainageCapacity,	ucRounding );
+		}
+	}
+
+	// Run the coarse model in fixed intervals until the volume settles
+	CBenchmark*	pBenchmark		= new CBenchmark( true );
+	double		dLastVolume		= 0.0;
+	double		dVolume			= 0.0;
+	double		dTarget			= 0.0;
+	bool		bConverged		= false;
+
+	pCoarseScheme->prepareSimulation();
+	dLastVolume = pCoarse->getVolume();
+
+	while ( !bConverged && dTarget < dMaxDuration && !model::forceAbort )
+	{
+		dTarget = std::min( dTarget + dInterval, dMaxDuration );
+
+		while ( pCoarseScheme->getCurrentTime() < dTarget - 1E-5 && !model::forceAbort )
+		{
+			pCoarseScheme->runSimulation( dTarget, pBenchmark->getMetrics()->dSeconds );
+			pCoarseScheme->waitUntilIdle();
+		}
+
+		pCoarse->getDevice()->blockUntilFinished();
+		pCoarseScheme->readDomainAll();
+		pCoarse->getDevice()->blockUntilFinished();
+
+		dVolume		= pCoarse->getVolume();
+		bConverged	= ( fabs( dVolume - dLastVolume ) <= dTolerance * std::max( dVolume, dLastVolume ) );
+		dLastVolume	= dVolume;
+
+		pManager->log->writeLine( "Spin-up reached " + Util::secondsToTime( pCoarseScheme->getCurrentTime() ) +
+			" with a volume of " + toString( dVolume ) + " m3." );
+	}
+
+	pCoarseScheme->cleanupSimulation();
+	delete pBenchmark;
+
+	if ( bConverged )
+	{
+		pManager->log->writeLine( "Spin-up converged after " + Util::secondsToTime( dTarget ) + " of simulated time." );
+	} else {
+		model::doError(
+			"Spin-up did not converge in the time allowed. Using the last state reached.",
+			model::errorCodes::kLevelWarning
+		);
+	}
+
+	// Carry the coarse state back, conserving the volume and momentum of each block
+	for ( unsigned long ulCY = 0; ulCY < ulCoarseRows; ++ulCY )
+	{
+		for ( unsigned long ulCX = 0; ulCX < ulCoarseCols; ++ulCX )
+		{
+			unsigned long	ulCoarseID	= pCoarse->getCellID( ulCX, ulCY );
+			if ( pCoarse->getStateValue( ulCoarseID, model::domainValueIndices::kValueMaxFreeSurfaceLevel ) <= -9999.0 )
+				continue;
+
+			double	dCoarseFSL		= pCoarse->getStateValue( ulCoarseID, model::domainValueIndices::kValueFreeSurfaceLevel );
+			double	dCoarseDepth	= std::max( 0.0, dCoarseFSL - pCoarse->getBedElevation( ulCoarseID ) );
+			double	dVelocityX		= 0.0;
+			double	dVelocityY		= 0.0;
+			double	dBlockDepth		= 0.0;
+			double	dScale			= 0.0;
+			unsigned long ulValid	= 0;
+
+			if ( dCoarseDepth > 1E-8 )
+			{
+				dVelocityX = pCoarse->getStateValue( ulCoarseID, model::domainValueIndices::kValueDischargeX ) / dCoarseDepth;
+				dVelocityY = pCoarse->getStateValue( ulCoarseID, model::domainValueIndices::kValueDischargeY ) / dCoarseDepth;
+			}
+
+			for ( unsigned char ucPass = 0; ucPass < 2; ++ucPass )
+			{
+				for ( unsigned long ulY = ulCY * uiFactor; ulY < std::min( ( ulCY + 1 ) * uiFactor, this->ulRows ); ++ulY )
+				{
+					for ( unsigned long ulX = ulCX * uiFactor; ulX < std::min( ( ulCX + 1 ) * uiFactor, this->ulCols ); ++ulX )
+					{
+						unsigned long ulID = this->getCellID( ulX, ulY );
+						if ( this->getBedElevation( ulID ) <= -9999.0 ||
+							 this->getStateValue( ulID, model::domainValueIndices::kValueMaxFreeSurfaceLevel ) <= -9999.0 )
+							continue;
+
+						double dDepth = std::max( 0.0, dCoarseFSL - this->getBedElevation( ulID ) );
+						if ( ucPass == 0 )
+						{
+							dBlockDepth += dDepth;
+							ulValid++;
+						} else {
+							// The coarse surface can sit below every bed in the block
+							// and still hold water, so spread it evenly instead
+							if ( dBlockDepth <= 0.0 )
+							{
+								dDepth = dCoarseDepth;
+								dScale = 1.0;
+							}
+							this->handleInputData( ulID, dDepth * dScale,				model::rasterDatasets::dataValues::kDepth,		ucRounding );
+							this->handleInputData( ulID, dDepth * dScale * dVelocityX,	model::rasterDatasets::dataValues::kDischargeX,	ucRounding );
+							this->handleInputData( ulID, dDepth * dScale * dVelocityY,	model::rasterDatasets::dataValues::kDischargeY,	ucRounding );
+						}
+					}
+				}
+
+				if ( ucPass == 0 && dBlockDepth > 0.0 )
+					dScale = dCoarseDepth * ulValid / dBlockDepth;
+			}
+		}
+	}
+
+	pManager->log->writeLine( "Spin-up state applied to the domain, with a volume of " + toString( this->getVolume() ) + " m3." );
+
+	delete pCoarse;
+	return true;
+}
+
 /*
  *  Load the output definitions for what should be written to disk
  */
@@ -322,6 +687,18 @@ bool	CDomainCartesian::loadOutputDefinitions( XMLElement* pXData )
 			pOutput.ucValue = this->getDataValueCode( cOutputValue );
 
 			addOutput( pOutput );
+		}
+		else if ( strcmp( cOutputType, "preview" ) == 0 )
+		{
+			sDataTargetInfo	pOutput;
+
+			pOutput.cFormat	= cOutputFormat;
+			pOutput.cType   = cOutputType;
+			pOutput.sTarget = std::string( cTargetDir ) + std::string( cOutputFile );
+			pOutput.ucValue = this->getDataValueCode( cOutputValue );
+
+			if ( !this->loadPreviewDefinition( pDataTarget, pOutput ) )
+				return false;
 		} else {
 			// TODO: Allow for timeseries outputs in specific cells etc.
 			model::doError(
@@ -338,6 +715,70 @@ bool	CDomainCartesian::loadOutputDefinitions( XMLElement* pXData )
 	return true;
 }
 
+/*
+ *  Configure the live preview from an output definition
+ */
+bool	CDomainCartesian::loadPreviewDefinition( XMLElement* pDataTarget, sDataTargetInfo pOutput )
+{
+	char	*cInterval	= NULL,
+			*cSize		= NULL,
+			*cScale		= NULL,
+			*cLevels	= NULL;
+
+	if ( pOutput.ucValue != model::rasterDatasets::dataValues::kDepth )
+	{
+		model::doError(
+			"Live previews are only available for depth.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	Util::toLowercase( &cInterval,	pDataTarget->Attribute( "interval" ) );
+	Util::toLowercase( &cSize,		pDataTarget->Attribute( "size" ) );
+	Util::toLowercase( &cScale,		pDataTarget->Attribute( "scale" ) );
+	Util::toLowercase( &cLevels,	pDataTarget->Attribute( "levels" ) );
+
+	if ( ( cInterval != NULL && !CXMLDataset::isValidFloat( cInterval ) ) ||
+		 ( cScale    != NULL && !CXMLDataset::isValidFloat( cScale ) ) ||
+		 ( cSize     != NULL && !CXMLDataset::isValidUnsignedInt( cSize ) ) ||
+		 ( cLevels   != NULL && !CXMLDataset::isValidUnsignedInt( cLevels ) ) )
+	{
+		model::doError(
+			"Invalid interval, size, scale or levels given for the live preview.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	if ( cInterval != NULL ) this->pPreview.dInterval = boost::lexical_cast<double>( cInterval );
+	if ( cScale    != NULL ) this->pPreview.dScale    = boost::lexical_cast<double>( cScale );
+	if ( cSize     != NULL ) this->pPreview.uiSize    = boost::lexical_cast<unsigned int>( cSize );
+	if ( cLevels   != NULL ) this->pPreview.uiLevels  = boost::lexical_cast<unsigned int>( cLevels );
+
+	if ( this->pPreview.uiSize < 1 || this->pPreview.uiLevels < 1 || this->pPreview.dScale <= 0.0 )
+	{
+		model::doError(
+			"Live preview size, scale and levels must be positive.",
+			model::errorCodes::kLevelWarning
+		);
+		return false;
+	}
+
+	// Base level stride so the largest dimension fits the requested size
+	unsigned long ulLargest = std::max( this->ulCols, this->ulRows );
+	this->pPreview.uiStride	= static_cast<unsigned int>( ( ulLargest + this->pPreview.uiSize - 1 ) / this->pPreview.uiSize );
+	this->pPreview.cFormat	= pOutput.cFormat;
+	this->pPreview.sTarget	= pOutput.sTarget;
+	this->pPreview.bEnabled	= true;
+
+	pScheme->preparePreview( this->ulCols, this->ulRows, this->pPreview.uiStride, this->pPreview.uiLevels );
+
+	pManager->log->writeLine( "Live preview of depth will be written every " + toString( this->pPreview.dInterval ) + " seconds." );
+
+	return true;
+}
+
 /*
  *  Read a data source raster or constant using the pre-parsed data held in the structure
  */
@@ -366,37 +807,17 @@ bool	CDomainCartesian::loadInitialConditionSource( sDataSourceInfo pDataSource,
 		}
 		double	dValue = boost::lexical_cast<double>( pDataSource.cFileValue );
 
-		// NOTE: The outer layer of cells are exempt here, as they are not computed
-		// but there may be some circumstances where we want a value here?
+		// Every cell is computed, the edges being handled by the ghost ring
 		for( unsigned long i = 0; i < this->getCols(); i++ )
 		{
 			for( unsigned long j = 0; j < this->getRows(); j++ )
 			{
-				unsigned long ulCellID = this->getCellID( i, j );
-				if (i <= 0 ||
-					j <= 0 ||
-					i >= this->getCols() - 1 ||
-					j >= this->getRows() - 1)
-				{
-					double dEdgeValue = 0.0;
-					if (pDataSource.ucValue == model::rasterDatasets::dataValues::kFreeSurfaceLevel)
-						dEdgeValue = this->getBedElevation( ulCellID );
-					this->handleInputData(
-						ulCellID,
-						dEdgeValue,
-						pDataSource.ucValue,
-						4	// TODO: Allow rounding to be configured for source constants
-					);
-				}
-				else
-				{
-					this->handleInputData(
-						ulCellID,
-						dValue,
-						pDataSource.ucValue,
-						4	// TODO: Allow rounding to be configured for source constants
-					);
-				}
+				this->handleInputData(
+					this->getCellID( i, j ),
+					dValue,
+					pDataSource.ucValue,
+					4	// TODO: Allow rounding to be configured for source constants
+				);
 			}
 		}
 	}
@@ -663,6 +1084,30 @@ void	CDomainCartesian::updateCellStatistics()
 		this->dRealDimensions[ kAxisX ] / this->dCellResolution
 	);
 	this->ulCellCount = this->ulRows * this->ulCols;
+
+	// Minimal layout until the scheme declares its requirements
+	this->setPaddedLayout( this->ucGhostCells, 1, 1 );
+}
+
+/*
+ *  Set the layout of the domain in memory: a ring of ghost cells around the
+ *  domain, with rows widened so the work ranges of the scheme fall within a
+ *  row and each row of real cells starts on a 128-byte boundary. The west
+ *  ghosts of a row sit in the tail padding of the row below it, and a spare
+ *  row either side keeps all neighbour reads within the allocation.
+ */
+void	CDomainCartesian::setPaddedLayout( unsigned char ucGhostCells, unsigned long ulMultipleX, unsigned long ulMultipleY )
+{
+	unsigned long	ulAlignCells	= 128 / sizeof( cl_float4 );
+	unsigned long	ulWidth			= this->ulCols + 2 * ucGhostCells;
+	unsigned long	ulHeight		= this->ulRows + 2 * ucGhostCells;
+
+	ulWidth		= ( ( ulWidth + ulMultipleX - 1 ) / ulMultipleX ) * ulMultipleX;
+	ulHeight	= ( ( ulHeight + ulMultipleY - 1 ) / ulMultipleY ) * ulMultipleY;
+
+	this->ucGhostCells	= ucGhostCells;
+	this->ulRowPitch	= ( ( ulWidth + ulAlignCells - 1 ) / ulAlignCells ) * ulAlignCells;
+	this->ulPaddedRows	= ulHeight + 2;
 }
 
 /*
@@ -686,7 +1131,34 @@ unsigned long	CDomainCartesian::getCols()
  */
 unsigned long	CDomainCartesian::getCellID( unsigned long ulX, unsigned long ulY )
 {
-	return ( ulY * this->getCols() ) + ulX;
+	return ( ulY + this->ucGhostCells + 1 ) * this->ulRowPitch + ulX;
+}
+
+/*
+ *  Get a cell ID from an X and Y index, either of which may be negative
+ *  or beyond the domain to address the ghost ring
+ */
+unsigned long	CDomainCartesian::getGhostCellID( long lX, long lY )
+{
+	return static_cast<unsigned long>(
+		( lY + this->ucGhostCells + 1 ) * static_cast<long>( this->ulRowPitch ) + lX
+	);
+}
+
+/*
+ *  Populate all cells with default values, with everything outside the
+ *  domain disabled so it is never computed
+ */
+void	CDomainCartesian::initialiseMemory()
+{
+	CDomain::initialiseMemory();
+
+	for( unsigned long i = 0; i < this->getAllocatedCellCount(); i++ )
+		this->setStateValue( i, model::domainValueIndices::kValueMaxFreeSurfaceLevel, -9999.0 );
+
+	for( unsigned long ulY = 0; ulY < this->ulRows; ulY++ )
+		for( unsigned long ulX = 0; ulX < this->ulCols; ulX++ )
+			this->setStateValue( this->getCellID( ulX, ulY ), model::domainValueIndices::kValueMaxFreeSurfaceLevel, 0.0 );
 }
 
 /*
@@ -699,6 +1171,30 @@ unsigned long	CDomainCartesian::getCellFromCoordinates( double dX, double dY )
 	return getCellID( ulX, ulY );
 }
 
+/*
+ *  Collect a set of cells and their direct neighbours, which are the first
+ *  cells whose fluxes respond to a change in those cells. The ghost ring
+ *  keeps every neighbour within the allocation.
+ */
+void	CDomainCartesian::getNeighbourhood( std::vector<unsigned long>* pCells, std::vector<unsigned long>* pArea )
+{
+	pArea->clear();
+	pArea->reserve( pCells->size() * 5 );
+
+	for ( unsigned long i = 0; i < pCells->size(); ++i )
+	{
+		unsigned long ulID = (*pCells)[ i ];
+		pArea->push_back( ulID );
+		pArea->push_back( ulID - 1 );
+		pArea->push_back( ulID + 1 );
+		pArea->push_back( ulID - this->ulRowPitch );
+		pArea->push_back( ulID + this->ulRowPitch );
+	}
+
+	std::sort( pArea->begin(), pArea->end() );
+	pArea->erase( std::unique( pArea->begin(), pArea->end() ), pArea->end() );
+}
+
 #ifdef _WINDLL
 /*
  *  Send the topography to the renderer for visualisation purposes
@@ -747,9 +1243,15 @@ double	CDomainCartesian::getVolume()
 {
 	double dVolume = 0.0;
 
-	for( unsigned int i = 0; i < this->ulCellCount; ++i )
+	for( unsigned long ulID = 0; ulID < this->ulCellCount; ++ulID )
 	{
-		if ( this->isDoublePrecision() )
+		unsigned long i = this->getCellID( ulID % this->ulCols, ulID / this->ulCols );
+		if ( this->bHostMirrorsReleased )
+		{
+			dVolume += ( std::max(0.0, this->getStateValue( i, model::domainValueIndices::kValueFreeSurfaceLevel ) - this->getBedElevation( i )) ) *
+					   std::fabs(this->dCellResolution * this->dCellResolution);
+		}
+		else if ( this->isDoublePrecision() )
 		{
 			dVolume += ( std::max(0.0, this->dCellStates[i].s[0] - this->dBedElevations[i]) ) *
 					   std::fabs(this->dCellResolution * this->dCellResolution);
@@ -778,32 +1280,47 @@ void	CDomainCartesian::addOutput( sDataTargetInfo pOutput )
 }
 
 /*
- *  Manipulate the topography to impose boundary conditions
+ *  Populate the ghost cells along one edge from the cells just inside it.
+ *  Closed edges mirror the domain with the normal discharge reversed, while
+ *  open and transmissive edges extend the edge cells outward. Ghosts are
+ *  disabled so they are carried between timesteps but never computed.
  */
 void	CDomainCartesian::imposeBoundaryModification(unsigned char ucDirection, unsigned char ucType)
 {
-	unsigned long ulMinX, ulMaxX, ulMinY, ulMaxY;
+	long	lCols	= static_cast<long>( this->ulCols );
+	long	lRows	= static_cast<long>( this->ulRows );
+	long	lLength	= ( ucDirection == edge::kEdgeN || ucDirection == edge::kEdgeS ) ? lCols : lRows;
+	bool	bClosed	= ( ucType == CDomainCartesian::boundaryTreatment::kBoundaryClosed );
 
-	if (ucDirection == edge::kEdgeE)
-		{ ulMinY = 0; ulMaxY = this->ulRows - 1; ulMinX = this->ulCols - 1; ulMaxX = this->ulCols - 1; };
-	if (ucDirection == edge::kEdgeW)
-		{ ulMinY = 0; ulMaxY = this->ulRows - 1; ulMinX = 0; ulMaxX = 0; };
-	if (ucDirection == edge::kEdgeN)
-		{ ulMinY = this->ulRows - 1; ulMaxY = this->ulRows - 1; ulMinX = 0; ulMaxX = this->ulCols - 1; };
-	if (ucDirection == edge::kEdgeS)
-		{ ulMinY = 0; ulMaxY = 0; ulMinX = 0; ulMaxX = this->ulCols - 1; };
-
-	for (unsigned long x = ulMinX; x <= ulMaxX; x++)
+	for (long i = 0; i < lLength; i++)
 	{
-		for (unsigned long y = ulMinY; y <= ulMaxY; y++)
+		for (long k = 0; k < this->ucGhostCells; k++)
 		{
-			if (ucType == CDomainCartesian::boundaryTreatment::kBoundaryClosed)
-			{
-				this->setBedElevation(
-					this->getCellID( x, y ),
-					9999.9
-				);
-			}
+			long lSource = bClosed ? k : 0;
+			long lGhostX = i, lGhostY = i, lSourceX = i, lSourceY = i;
+
+			if (ucDirection == edge::kEdgeN)
+				{ lGhostY = lRows + k; lSourceY = lRows - 1 - lSource; };
+			if (ucDirection == edge::kEdgeE)
+				{ lGhostX = lCols + k; lSourceX = lCols - 1 - lSource; };
+			if (ucDirection == edge::kEdgeS)
+				{ lGhostY = -1 - k; lSourceY = lSource; };
+			if (ucDirection == edge::kEdgeW)
+				{ lGhostX = -1 - k; lSourceX = lSource; };
+
+			unsigned long ulGhost	= this->getGhostCellID( lGhostX, lGhostY );
+			unsigned long ulSource	= this->getCellID( lSourceX, lSourceY );
+			double dReflectX = ( bClosed && ( ucDirection == edge::kEdgeE || ucDirection == edge::kEdgeW ) ) ? -1.0 : 1.0;
+			double dReflectY = ( bClosed && ( ucDirection == edge::kEdgeN || ucDirection == edge::kEdgeS ) ) ? -1.0 : 1.0;
+
+			this->setBedElevation( ulGhost, this->getBedElevation( ulSource ) );
+			this->setManningCoefficient( ulGhost, this->getManningCoefficient( ulSource ) );
+			this->setStateValue( ulGhost, model::domainValueIndices::kValueFreeSurfaceLevel, this->getStateValue( ulSource, model::domainValueIndices::kValueFreeSurfaceLevel ) );
+			this->setStateValue( ulGhost, model::domainValueIndices::kValueMaxFreeSurfaceLevel, -9999.0 );
+			this->setStateValue( ulGhost, model::domainValueIndices::kValueDischargeX, dReflectX * this->getStateValue( ulSource, model::domainValueIndices::kValueDischargeX ) );
+			this->setStateValue( ulGhost, model::domainValueIndices::kValueDischargeY, dReflectY * this->getStateValue( ulSource, model::domainValueIndices::kValueDischargeY ) );
+			if ( this->hasScalarValues() )
+				this->setScalarValue( ulGhost, this->getScalarValue( ulSource ) );
 		}
 	}
 }
@@ -843,6 +1360,61 @@ void	CDomainCartesian::writeOutputs()
 	pManager->log->writeLine( "Finished domain: [" + std::to_string(getID()) + "], step: [" + std::to_string(pScheme->getCurrentTime()) + "], finished writing results.");
 }
 
+/*
+ *  Write the live preview images once read back, and request the next one
+ *  when the interval (in real time) has elapsed
+ */
+void	CDomainCartesian::writePreview( double dRealTime )
+{
+	if ( !this->pPreview.bEnabled )
+		return;
+
+	if ( pScheme->isPreviewReady() )
+	{
+		std::string		sTime		= toString( floor( pScheme->getCurrentTime() * 100.0 ) / 100.0 );
+		unsigned int	uiStride	= this->pPreview.uiStride;
+		unsigned int	uiCols, uiRows;
+		cl_float*		fLevel;
+
+		for( unsigned int i = 0; ( fLevel = pScheme->getPreviewLevel( i, &uiCols, &uiRows ) ) != NULL; ++i )
+		{
+			// Replaces %t with the time and %l with the level in the filename
+			std::string sFilename = this->pPreview.sTarget;
+			size_t szTimeLocation = sFilename.find( "%t" );
+			if ( szTimeLocation != std::string::npos )
+				sFilename.replace( szTimeLocation, 2, sTime );
+			size_t szLevelLocation = sFilename.find( "%l" );
+			if ( szLevelLocation != std::string::npos )
+				sFilename.replace( szLevelLocation, 2, toString( i ) );
+
+			CRasterDataset::previewToRaster(
+				this->pPreview.cFormat,
+				sFilename,
+				this,
+				fLevel,
+				uiCols,
+				uiRows,
+				uiStride,
+				this->pPreview.dScale
+			);
+
+			// Only the base level unless the filename can tell them apart
+			if ( szLevelLocation == std::string::npos )
+				break;
+
+			uiStride *= 2;
+		}
+
+		pScheme->releasePreview();
+	}
+
+	if ( dRealTime - this->pPreview.dLastPreview >= this->pPreview.dInterval )
+	{
+		pScheme->requestPreview();
+		this->pPreview.dLastPreview = dRealTime;
+	}
+}
+
 /*
  *	Fetch summary information for this domain
  */
@@ -865,6 +1437,8 @@ CDomainBase::DomainSummary CDomainCartesian::getSummary()
 	pSummary.dEdgeWest		= this->dRealExtent[kEdgeW];
 	pSummary.ulColCount		= this->ulCols;
 	pSummary.ulRowCount		= this->ulRows;
+	pSummary.ulRowPitch		= this->ulRowPitch;
+	pSummary.ucGhostCells	= this->ucGhostCells;
 	pSummary.ucFloatPrecision = ( this->isDoublePrecision() ? model::floatPrecision::kDouble : model::floatPrecision::kSingle );
 	pSummary.dResolution	= this->dCellResolution;
 
@@ -50,6 +50,7 @@ class CDomainCartesian : public CDomain
 		void			prepareDomain();										// Create memory structures etc.
 		void			logDetails();											// Log details about the domain
 		void			writeOutputs();											// Write output files to disk
+		void			writePreview( double );									// Write live preview images if due
 		void			syncWithDomain( CDomain* );								// Synchronise with another domain
 		unsigned int	getOverlapSize( CDomain* );								// Get the size of the overlap zone
 		// - Specific to cartesian grids
@@ -69,7 +70,14 @@ class CDomainCartesian : public CDomain
 		unsigned long	getRows();												// Get the number of rows in the domain
 		unsigned long	getCols();												// Get the number of columns in the domain
 		virtual unsigned long	getCellID( unsigned long, unsigned long );		// Get the cell ID using an X and Y index
+		unsigned long	getGhostCellID( long, long );							// Get the cell ID using an X and Y index which may lie in the ghost ring
+		void			setPaddedLayout( unsigned char, unsigned long, unsigned long );	// Set the ghost ring width and row multiples for the layout in memory
+		unsigned char	getGhostCells()									{ return ucGhostCells; }	// Width of the ghost cell ring
+		unsigned long	getRowPitch()									{ return ulRowPitch; }		// Cells between the start of successive rows
+		virtual unsigned long	getAllocatedCellCount()					{ return ulRowPitch * ulPaddedRows; }	// Cells held in memory, including ghosts and padding
+		virtual void	initialiseMemory();										// Populate cells with defaults, disabling those outside the domain
 		unsigned long	getCellFromCoordinates( double, double );				// Get the cell ID using real coords
+		void			getNeighbourhood( std::vector<unsigned long>*, std::vector<unsigned long>* );	// Cells plus their direct neighbours, sorted
 		double			getVolume();											// Calculate the amount of volume in all the cells
 		#ifdef _WINDLL
 		virtual void	sendAllToRenderer();									// Allows the renderer to read off the bed elevations
@@ -92,7 +100,8 @@ class CDomainCartesian : public CDomain
 		enum boundaryTreatment
 		{
 			kBoundaryOpen = 0,
-			kBoundaryClosed = 1
+			kBoundaryClosed = 1,
+			kBoundaryTransmissive = 2
 		};
 
 	private:
@@ -110,6 +119,18 @@ class CDomainCartesian : public CDomain
 			unsigned char	ucValue;
 			std::string		sTarget;
 		};
+		struct	sPreviewInfo
+		{
+			bool			bEnabled;
+			char*			cFormat;
+			std::string		sTarget;
+			double			dInterval;
+			double			dScale;
+			double			dLastPreview;
+			unsigned int	uiSize;
+			unsigned int	uiLevels;
+			unsigned int	uiStride;
+		};
 
 		// Private variables
 		double			dRealDimensions[2];
@@ -118,13 +139,19 @@ class CDomainCartesian : public CDomain
 		double			dCellResolution;
 		unsigned long	ulRows;
 		unsigned long	ulCols;
+		unsigned char	ucGhostCells;												// Width of the ghost cell ring around the domain
+		unsigned long	ulRowPitch;													// Cells between the start of successive rows
+		unsigned long	ulPaddedRows;												// Rows held in memory, including ghosts and spares
 		unsigned long	ulProjectionCode;
 		char			cUnits[2];
 		std::vector<sDataTargetInfo>	pOutputs;									// Structure of details about the outputs
+		sPreviewInfo	pPreview;													// Details about the live preview
 
 		// Private functions
 		void			addOutput( sDataTargetInfo );								// Adds a new output 
+		bool			loadPreviewDefinition( XMLElement*, sDataTargetInfo );		// Configure the live preview
 		bool			loadInitialConditionSource( sDataSourceInfo, char* );		// Load a constant/raster condition to the domain
+		bool			spinUpCoarse( XMLElement*, XMLElement* );					// Spin up the initial conditions on a coarsened copy of the domain
 		void			updateCellStatistics();										// Update the number of rows, cols, etc.
 
 };
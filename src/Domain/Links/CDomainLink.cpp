@@ -23,6 +23,8 @@
 
 #include "../../common.h"
 #include "../../MPI/CMPIManager.h"
+#include "../../OpenCL/Executors/COCLDevice.h"
+#include "../../OpenCL/Executors/COCLProgram.h"
 #include "CDomainLink.h"
 #include "../Cartesian/CDomainCartesian.h"	// TEMP: Remove me!
 #include "../CDomainManager.h"				// TEMP: Remove me!
@@ -30,6 +32,9 @@
 using std::min;
 using std::max;
 
+// Width of the band exchanged along the edge of a nested domain, in cells of the coarser domain
+static const unsigned int kNestBandCells = 4;
+
 /*
  *  Constructor
  */
@@ -49,6 +54,24 @@ CDomainLink::CDomainLink( CDomainBase* pTarget, CDomainBase *pSource )
 	this->bSent 		= true;
 	this->uiSmallestOverlap = 999999999;
 
+	// Nested links only have kernels once the schemes are ready
+	this->bNested		= false;
+	this->bRestriction	= false;
+	this->uiRatio		= 1;
+	this->ucFloatPrecision	= model::floatPrecision::kDouble;
+	this->dTargetCellArea	= 0.0;
+	this->dVolumeExchanged	= 0.0;
+	this->bBalancePending	= false;
+	this->oclBufferSourceConfiguration	= NULL;
+	this->oclBufferSourceCells			= NULL;
+	this->oclBufferSourceZone			= NULL;
+	this->oclBufferTargetConfiguration	= NULL;
+	this->oclBufferTargetCells			= NULL;
+	this->oclBufferTargetZone			= NULL;
+	this->oclBufferTargetBalance		= NULL;
+	this->oclKernelGather				= NULL;
+	this->oclKernelScatter				= NULL;
+
 	pManager->log->writeLine("Generating link definitions between domains #" + toString(this->uiTargetDomainID + 1) 
 		+ " and #" + toString(this->uiSourceDomainID + 1));
 
@@ -60,6 +83,16 @@ CDomainLink::CDomainLink( CDomainBase* pTarget, CDomainBase *pSource )
  */
 CDomainLink::~CDomainLink(void)
 {
+	delete oclKernelGather;
+	delete oclKernelScatter;
+	delete oclBufferSourceConfiguration;
+	delete oclBufferSourceCells;
+	delete oclBufferSourceZone;
+	delete oclBufferTargetConfiguration;
+	delete oclBufferTargetCells;
+	delete oclBufferTargetZone;
+	delete oclBufferTargetBalance;
+
 	for (unsigned int i = 0; i < linkDefs.size(); i++)
 	{
 		delete[] linkDefs[i].vStateData;
@@ -110,13 +143,11 @@ bool CDomainLink::canLink(CDomainBase* pA, CDomainBase* pB)
                 return false;
         }
 
-	// Are the two resolutions the same?
-	// TODO: Add support for mixed-resolution syncing at a later date
+	// Are the two resolutions the same? If not, one must be nested inside the other
 	if ( pSumA.dResolution != pSumB.dResolution )
 	{
-                //pManager->log->writeLine("[DEBUG] Cannot link mismatched resolutions.");
-                return false;
-        }
+		return canNest(pA, pB) || canNest(pB, pA);
+	}
 
 	// Are the two domains aligned (or at least roughly aligned)...
 	// Limit the misalignment to 1/10 of the resolution, but even this would cause problems
@@ -135,6 +166,47 @@ bool CDomainLink::canLink(CDomainBase* pA, CDomainBase* pB)
 	return true;
 }
 
+/*
+ *	Return whether or not the second domain is nested inside the first, so the
+ *	two can be coupled by restriction and prolongation along its edge.
+ */
+bool CDomainLink::canNest(CDomainBase* pOuter, CDomainBase* pInner)
+{
+	CDomainBase::DomainSummary pSumOuter = pOuter->getSummary();
+	CDomainBase::DomainSummary pSumInner = pInner->getSummary();
+
+	if ( pSumInner.dResolution >= pSumOuter.dResolution )
+		return false;
+
+	// Each coarse cell must hold a whole number of fine cells
+	double dRatio = pSumOuter.dResolution / pSumInner.dResolution;
+	if ( fabs( dRatio - floor( dRatio + 0.5 ) ) > 1E-6 )
+		return false;
+	unsigned int uiRatio = static_cast<unsigned int>( floor( dRatio + 0.5 ) );
+
+	// Must sit entirely within the coarser domain
+	double dTolerance = 0.1 * pSumInner.dResolution;
+	if ( pSumInner.dEdgeWest  < pSumOuter.dEdgeWest  - dTolerance ||
+		 pSumInner.dEdgeEast  > pSumOuter.dEdgeEast  + dTolerance ||
+		 pSumInner.dEdgeSouth < pSumOuter.dEdgeSouth - dTolerance ||
+		 pSumInner.dEdgeNorth > pSumOuter.dEdgeNorth + dTolerance )
+		return false;
+
+	// ...and the edges must fall on the coarser grid, otherwise volume cannot be conserved
+	if ( fabs( remainder( pSumInner.dEdgeWest - pSumOuter.dEdgeWest, pSumOuter.dResolution ) ) > dTolerance ||
+		 fabs( remainder( pSumInner.dEdgeSouth - pSumOuter.dEdgeSouth, pSumOuter.dResolution ) ) > dTolerance ||
+		 pSumInner.ulColCount % uiRatio != 0 ||
+		 pSumInner.ulRowCount % uiRatio != 0 )
+		return false;
+
+	// Need room for the band on every side with something left in the middle
+	if ( pSumInner.ulColCount / uiRatio <= 2 * kNestBandCells ||
+		 pSumInner.ulRowCount / uiRatio <= 2 * kNestBandCells )
+		return false;
+
+	return true;
+}
+
 /*
  *	Import data received through MPI
  */
@@ -173,6 +245,21 @@ void	CDomainLink::pullFromBuffer(double dCurrentTime, COCLBuffer* pBuffer)
 
 	if ( this->dValidityTime < dCurrentTime )
 	{
+		// Nested links are resampled into a compact zone on the device first
+		if ( this->bNested )
+		{
+			if ( this->oclKernelGather == NULL )
+				return;
+
+			this->oclKernelGather->assignArgument( 2, pBuffer );
+			this->oclKernelGather->scheduleExecution();
+			this->oclKernelGather->getProgram()->getDevice()->queueBarrier();
+			this->oclBufferSourceZone->queueReadAll();
+
+			this->dValidityTime = dCurrentTime;
+			this->bSent = false;
+			return;
+		}
 	
 		for (unsigned int i = 0; i < this->linkDefs.size(); i++)
 		{
@@ -256,6 +343,26 @@ void	CDomainLink::pushToBuffer(COCLBuffer* pBuffer)
 	// TODO: Remove this later...
 	if (this->dValidityTime < 0.0) return;
 
+	if ( this->bNested )
+	{
+		if ( this->oclKernelScatter == NULL )
+			return;
+
+		// The domain's batch has finished by the time it syncs again, so the
+		// balance read back after the last scatter is complete
+		if ( this->bBalancePending )
+			this->logBalance();
+
+		this->oclBufferTargetZone->queueWriteAll();
+		this->oclKernelScatter->getProgram()->getDevice()->queueBarrier();
+		this->oclKernelScatter->assignArgument( 4, pBuffer );
+		this->oclKernelScatter->scheduleExecution();
+		this->oclKernelScatter->getProgram()->getDevice()->queueBarrier();
+		this->oclBufferTargetBalance->queueReadAll();
+		this->bBalancePending = true;
+		return;
+	}
+
 	for (unsigned int i = 0; i < this->linkDefs.size(); i++)
 	{
 #ifdef DEBUG_MPI
@@ -288,6 +395,13 @@ void	CDomainLink::generateDefinitions(CDomainBase* pTarget, CDomainBase *pSource
 	CDomainBase::DomainSummary pSumTgt = pTarget->getSummary();
 	CDomainBase::DomainSummary pSumSrc = pSource->getSummary();
 
+	if ( pSumTgt.dResolution != pSumSrc.dResolution )
+	{
+		this->generateNestedDefinitions( pTarget, pSource );
+		this->allocateDefinitions( pSumTgt.ucFloatPrecision );
+		return;
+	}
+
 	// Get the size of our cell state vector
 	unsigned char ucStateVectorSize = (pSumTgt.ucFloatPrecision == model::floatPrecision::kSingle ?
 		sizeof(cl_float4) : sizeof(cl_double4)
@@ -340,8 +454,11 @@ void	CDomainLink::generateDefinitions(CDomainBase* pTarget, CDomainBase *pSource
 
 	for (unsigned int i = 0; i <= ulRowHighTgt - ulRowBaseTgt; i++)
 	{
-		// Can we extend the last?
-		if ( pDefinition.ulSize > 0 && pTarget->getCellID(0, ulRowBaseTgt + i) == pDefinition.ulTargetEndCellID + 1 )
+		// Can we extend the last? Rows are padded, so the gap between rows (ghost
+		// cells and padding) is carried along when it matches in both domains
+		if ( pDefinition.ulSize > 0 &&
+			 pTarget->getCellID(0, ulRowBaseTgt + i) - pDefinition.ulTargetEndCellID ==
+			 pSource->getCellID(0, ulRowBaseSrc + i) - pDefinition.ulSourceEndCellID )
 		{
 			pDefinition.ulSourceEndCellID = pSource->getCellID(pSumSrc.ulColCount - 1, ulRowBaseSrc + i);
 			pDefinition.ulTargetEndCellID = pTarget->getCellID(pSumTgt.ulColCount - 1, ulRowBaseTgt + i);
@@ -366,9 +483,17 @@ void	CDomainLink::generateDefinitions(CDomainBase* pTarget, CDomainBase *pSource
 	if ( pDefinition.ulSize > 0 )
 		linkDefs.push_back( pDefinition );
 
+	this->allocateDefinitions( pSumTgt.ucFloatPrecision );
+}
+
+/*
+ *	Allocate the host memory for each of the link definitions
+ */
+void	CDomainLink::allocateDefinitions(unsigned char ucFloatPrecision)
+{
 	for (unsigned int i = 0; i < linkDefs.size(); i++)
 	{
-		if ( pSumTgt.ucFloatPrecision == model::floatPrecision::kSingle )
+		if ( ucFloatPrecision == model::floatPrecision::kSingle )
 		{
 			linkDefs[i].vStateData  = new cl_float4[ linkDefs[i].ulSourceEndCellID - linkDefs[i].ulSourceStartCellID + 1 ];
 			linkDefs[i].ulOffsetSource = linkDefs[i].ulSourceStartCellID * sizeof(cl_float4);
@@ -380,3 +505,182 @@ void	CDomainLink::generateDefinitions(CDomainBase* pTarget, CDomainBase *pSource
 		}
 	}
 }
+
+/*
+ *	Identify the cells exchanged between a nested domain and the coarser domain containing it.
+ *	The finer domain takes a band along its edge from the coarser one (prolongation), while
+ *	the coarser domain takes the average of the finer cells inside that band (restriction).
+ *	Both sides walk the same list of zone elements, so the data is held in one block.
+ */
+void	CDomainLink::generateNestedDefinitions(CDomainBase* pTarget, CDomainBase *pSource)
+{
+	CDomainBase::DomainSummary pSumTgt = pTarget->getSummary();
+	CDomainBase::DomainSummary pSumSrc = pSource->getSummary();
+
+	this->bNested		= true;
+	this->bRestriction	= pSumTgt.dResolution > pSumSrc.dResolution;
+	this->ucFloatPrecision	= pSumTgt.ucFloatPrecision;
+	this->dTargetCellArea	= pSumTgt.dResolution * pSumTgt.dResolution;
+
+	CDomainBase*				pFine		= ( this->bRestriction ? pSource : pTarget );
+	CDomainBase*				pCoarse		= ( this->bRestriction ? pTarget : pSource );
+	CDomainBase::DomainSummary	pSumFine	= ( this->bRestriction ? pSumSrc : pSumTgt );
+	CDomainBase::DomainSummary	pSumCoarse	= ( this->bRestriction ? pSumTgt : pSumSrc );
+
+	this->uiRatio = static_cast<unsigned int>( floor( pSumCoarse.dResolution / pSumFine.dResolution + 0.5 ) );
+
+	unsigned long ulColOffset	= static_cast<unsigned long>( floor( ( pSumFine.dEdgeWest - pSumCoarse.dEdgeWest ) / pSumCoarse.dResolution + 0.5 ) );
+	unsigned long ulRowOffset	= static_cast<unsigned long>( floor( ( pSumFine.dEdgeSouth - pSumCoarse.dEdgeSouth ) / pSumCoarse.dResolution + 0.5 ) );
+	unsigned long ulBlockCols	= pSumFine.ulColCount / this->uiRatio;
+	unsigned long ulBlockRows	= pSumFine.ulRowCount / this->uiRatio;
+
+	for (unsigned long ulBY = 0; ulBY < ulBlockRows; ulBY++)
+	{
+		for (unsigned long ulBX = 0; ulBX < ulBlockCols; ulBX++)
+		{
+			unsigned long ulRing = min( min( ulBX, ulBlockCols - 1 - ulBX ), min( ulBY, ulBlockRows - 1 - ulBY ) );
+			unsigned long ulCoarseID = pCoarse->getCellID( ulColOffset + ulBX, ulRowOffset + ulBY );
+
+			if ( this->bRestriction )
+			{
+				// Coarse cells inside the band, each averaging a block of fine cells
+				if ( ulRing < kNestBandCells )
+					continue;
+				this->vSourceCells.push_back( pFine->getCellID( ulBX * this->uiRatio, ulBY * this->uiRatio ) );
+				this->vTargetCells.push_back( ulCoarseID );
+			} else {
+				// Fine cells within the band, each taking the coarse cell they sit in
+				if ( ulRing >= kNestBandCells )
+					continue;
+				for (unsigned long ulY = ulBY * this->uiRatio; ulY < ( ulBY + 1 ) * this->uiRatio; ulY++)
+				{
+					for (unsigned long ulX = ulBX * this->uiRatio; ulX < ( ulBX + 1 ) * this->uiRatio; ulX++)
+					{
+						this->vSourceCells.push_back( ulCoarseID );
+						this->vTargetCells.push_back( pFine->getCellID( ulX, ulY ) );
+					}
+				}
+			}
+		}
+	}
+
+	// The band is what the target relies on between exchanges
+	this->uiSmallestOverlap = kNestBandCells * ( this->bRestriction ? 1 : this->uiRatio );
+
+	LinkDefinition pDefinition;
+	pDefinition.ulSourceStartCellID	= 0;
+	pDefinition.ulSourceEndCellID	= this->vSourceCells.size() - 1;
+	pDefinition.ulTargetStartCellID	= 0;
+	pDefinition.ulTargetEndCellID	= this->vTargetCells.size() - 1;
+	pDefinition.ulSize				= this->vSourceCells.size() * ( pSumTgt.ucFloatPrecision == model::floatPrecision::kSingle ?
+		sizeof(cl_float4) : sizeof(cl_double4) );
+	pDefinition.vStateData			= NULL;
+	linkDefs.push_back( pDefinition );
+
+	pManager->log->writeLine("Nested link covers " + toString(this->vTargetCells.size()) + " cell(s) at a ratio of 1:" + toString(this->uiRatio) +
+		( this->bRestriction ? " (restriction)" : " (prolongation)" ));
+}
+
+/*
+ *	Create the kernel which gathers the zone from the source domain's cell states
+ */
+void	CDomainLink::prepareSource(COCLProgram* pProgram, COCLBuffer* pBufferBed)
+{
+	if ( !this->bNested || this->oclKernelGather != NULL )
+		return;
+
+	std::string sName = "Link #" + toString(this->uiSourceDomainID + 1) + " to #" + toString(this->uiTargetDomainID + 1);
+
+	sLinkConfiguration pConfiguration;
+	pConfiguration.ulElements	= this->vSourceCells.size();
+	pConfiguration.ulBlock		= ( this->bRestriction ? this->uiRatio : 1 );
+
+	oclBufferSourceConfiguration = new COCLBuffer( sName + " source conf", pProgram, true, true, sizeof( sLinkConfiguration ), true );
+	memcpy( oclBufferSourceConfiguration->getHostBlock<void*>(), &pConfiguration, sizeof( sLinkConfiguration ) );
+	oclBufferSourceConfiguration->createBuffer();
+
+	oclBufferSourceCells = new COCLBuffer( sName + " source cells", pProgram, true, true );
+	oclBufferSourceCells->setPointer( &this->vSourceCells[0], this->vSourceCells.size() * sizeof( cl_ulong ) );
+	oclBufferSourceCells->createBuffer();
+
+	oclBufferSourceZone = new COCLBuffer( sName + " source zone", pProgram, false, true );
+	oclBufferSourceZone->setPointer( this->linkDefs[0].vStateData, this->linkDefs[0].ulSize );
+	oclBufferSourceZone->createBuffer();
+
+	oclKernelGather = pProgram->getKernel( "dom_LinkGather" );
+	oclKernelGather->setGroupSize( min( static_cast<cl_ulong>( 64 ), static_cast<cl_ulong>( pProgram->getDevice()->clDeviceMaxWorkGroupSize ) ) );
+	oclKernelGather->setGlobalSize( this->vSourceCells.size() );
+	oclKernelGather->assignArgument( 0, oclBufferSourceConfiguration );
+	oclKernelGather->assignArgument( 1, oclBufferSourceCells );
+	oclKernelGather->assignArgument( 3, pBufferBed );
+	oclKernelGather->assignArgument( 4, oclBufferSourceZone );
+}
+
+/*
+ *	Create the kernel which scatters the zone into the target domain's cell states
+ */
+void	CDomainLink::prepareTarget(COCLProgram* pProgram, COCLBuffer* pBufferBed)
+{
+	if ( !this->bNested || this->oclKernelScatter != NULL )
+		return;
+
+	std::string sName = "Link #" + toString(this->uiSourceDomainID + 1) + " to #" + toString(this->uiTargetDomainID + 1);
+
+	sLinkConfiguration pConfiguration;
+	pConfiguration.ulElements	= this->vTargetCells.size();
+	pConfiguration.ulBlock		= ( this->bRestriction ? 1 : this->uiRatio );
+
+	oclBufferTargetConfiguration = new COCLBuffer( sName + " target conf", pProgram, true, true, sizeof( sLinkConfiguration ), true );
+	memcpy( oclBufferTargetConfiguration->getHostBlock<void*>(), &pConfiguration, sizeof( sLinkConfiguration ) );
+	oclBufferTargetConfiguration->createBuffer();
+
+	oclBufferTargetCells = new COCLBuffer( sName + " target cells", pProgram, true, true );
+	oclBufferTargetCells->setPointer( &this->vTargetCells[0], this->vTargetCells.size() * sizeof( cl_ulong ) );
+	oclBufferTargetCells->createBuffer();
+
+	oclBufferTargetZone = new COCLBuffer( sName + " target zone", pProgram, true, true );
+	oclBufferTargetZone->setPointer( this->linkDefs[0].vStateData, this->linkDefs[0].ulSize );
+	oclBufferTargetZone->createBuffer();
+
+	oclKernelScatter = pProgram->getKernel( "dom_LinkScatter" );
+	oclKernelScatter->setGroupSize( min( static_cast<cl_ulong>( 64 ), static_cast<cl_ulong>( pProgram->getDevice()->clDeviceMaxWorkGroupSize ) ) );
+	oclKernelScatter->setGlobalSize( this->vTargetCells.size() );
+	oclKernelScatter->assignArgument( 0, oclBufferTargetConfiguration );
+	oclKernelScatter->assignArgument( 1, oclBufferTargetCells );
+	oclKernelScatter->assignArgument( 2, oclBufferTargetZone );
+	oclKernelScatter->assignArgument( 3, pBufferBed );
+
+	oclBufferTargetBalance = new COCLBuffer( sName + " target balance", pProgram, false, true,
+		this->vTargetCells.size() * ( this->ucFloatPrecision == model::floatPrecision::kSingle ? sizeof( cl_float2 ) : sizeof( cl_double2 ) ), true );
+	oclBufferTargetBalance->createBuffer();
+	oclKernelScatter->assignArgument( 5, oclBufferTargetBalance );
+}
+
+/*
+ *	The band is overwritten rather than fluxed across, so the coarse and fine domains
+ *	don't agree exactly on the volume either side of the nest edge. Total the change in
+ *	depth over the target cells at the last exchange so the drift can be followed.
+ */
+void	CDomainLink::logBalance()
+{
+	double	dChange		= 0.0;
+
+	for (unsigned long i = 0; i < this->vTargetCells.size(); i++)
+	{
+		if ( this->ucFloatPrecision == model::floatPrecision::kSingle )
+		{
+			cl_float2* pBalance = this->oclBufferTargetBalance->getHostBlock<cl_float2*>();
+			dChange += pBalance[i].s[1] - pBalance[i].s[0];
+		} else {
+			cl_double2* pBalance = this->oclBufferTargetBalance->getHostBlock<cl_double2*>();
+			dChange += pBalance[i].s[1] - pBalance[i].s[0];
+		}
+	}
+
+	dChange *= this->dTargetCellArea;
+	this->dVolumeExchanged += dChange;
+	this->bBalancePending = false;
+
+	pManager->log->writeLine("Nested link #" + toString(this->uiSourceDomainID + 1) + " to #" + toString(this->uiTargetDomainID + 1) +
+		" changed the volume by " + toString(dChange) + " m3 (" + toString(this->dVolumeExchanged) + " m3 in total).");
+}
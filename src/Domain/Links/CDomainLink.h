@@ -21,6 +21,7 @@
 
 #include "../../OpenCL/opencl.h"
 #include "../../OpenCL/Executors/COCLBuffer.h"
+#include "../../OpenCL/Executors/COCLKernel.h"
 #include "../CDomainBase.h"
 #include <vector>
 
@@ -29,7 +30,9 @@
  *  CDomainLink
  *
  *  Handles links between two domains, which may or may not reside on the same host system
- *  and may be of differing types.
+ *  and may be of differing types. Domains of the same resolution exchange rows where they
+ *  overlap, while a finer domain nested inside a coarser one exchanges a band along its
+ *  edge, resampled on the devices either side.
  */
 class CDomainLink
 {
@@ -53,6 +56,10 @@ class CDomainLink
 
 		// Public functions
 		static bool			canLink(CDomainBase*, CDomainBase*);									// Can two domains be linked?
+		static bool			canNest(CDomainBase*, CDomainBase*);									// Does the first domain contain the second as a nest?
+		bool				isNested()								{ return bNested; }				// Is this a link between nested resolutions?
+		void				prepareSource(COCLProgram*, COCLBuffer*);								// Prepare the device kernels on the source side of a nest
+		void				prepareTarget(COCLProgram*, COCLBuffer*);								// Prepare the device kernels on the target side of a nest
 		void				pullFromBuffer(double, COCLBuffer*);									// Download data from a memory buffer
 		void				pushToBuffer(COCLBuffer*);												// Push data to memory buffer
 		unsigned int		getSmallestOverlap()					{ return uiSmallestOverlap;  }	// Get the smallest overlap size
@@ -82,6 +89,12 @@ class CDomainLink
 			void*		  vStateData;
 		};
 
+		struct sLinkConfiguration
+		{
+			cl_ulong		ulElements;
+			cl_ulong		ulBlock;
+		};
+
 		// Private variables
 		std::vector<LinkDefinition>		linkDefs;
 		unsigned int					uiSourceDomainID;
@@ -90,9 +103,30 @@ class CDomainLink
 		unsigned int					uiSmallestOverlap;
 		double							dValidityTime;
 		bool							bSent;
+		bool							bNested;
+		bool							bRestriction;
+		unsigned int					uiRatio;
+		unsigned char					ucFloatPrecision;
+		double							dTargetCellArea;
+		double							dVolumeExchanged;
+		bool							bBalancePending;
+		std::vector<cl_ulong>			vSourceCells;
+		std::vector<cl_ulong>			vTargetCells;
+		COCLBuffer*						oclBufferSourceConfiguration;
+		COCLBuffer*						oclBufferSourceCells;
+		COCLBuffer*						oclBufferSourceZone;
+		COCLBuffer*						oclBufferTargetConfiguration;
+		COCLBuffer*						oclBufferTargetCells;
+		COCLBuffer*						oclBufferTargetZone;
+		COCLBuffer*						oclBufferTargetBalance;
+		COCLKernel*						oclKernelGather;
+		COCLKernel*						oclKernelScatter;
 
 		// Private functions
 		void				generateDefinitions(CDomainBase*, CDomainBase*);						// Identify contiguous memory areas for exchange
+		void				generateNestedDefinitions(CDomainBase*, CDomainBase*);					// Identify the cells exchanged along a nest boundary
+		void				allocateDefinitions(unsigned char);										// Allocate host memory for each definition
+		void				logBalance();															// Report the volume the last nested exchange added
 };
 
 #endif
@@ -39,6 +39,8 @@ CDomainRemote::CDomainRemote(void)
 	pSummary.uiLocalDeviceID = 0;
 	pSummary.ulColCount = 0;
 	pSummary.ulRowCount = 0;
+	pSummary.ulRowPitch = 0;
+	pSummary.ucGhostCells = 0;
 }
 
 /*
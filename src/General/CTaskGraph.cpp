@@ -0,0 +1,213 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ *
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Dependency graph of tasks run across threads
+ * ------------------------------------------
+ *
+ */
+
+// Includes
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "../common.h"
+#include "CTaskGraph.h"
+
+/*
+ *  Constructor
+ */
+CTaskGraph::CTaskGraph( std::string sName )
+{
+	this->sName			= sName;
+	this->uiFinished	= 0;
+	this->dStartTime	= 0.0;
+}
+
+/*
+ *  Destructor
+ */
+CTaskGraph::~CTaskGraph(void)
+{
+	// ...
+}
+
+/*
+ *  Add a task, which may only depend on tasks already added
+ */
+unsigned int CTaskGraph::addTask( std::string sTaskName, std::function<bool()> fnWork, std::vector<unsigned int> vDependencies )
+{
+	sTask pTask;
+
+	pTask.sName			= sTaskName;
+	pTask.fnWork		= fnWork;
+	pTask.ucState		= kTaskPending;
+	pTask.dStart		= 0.0;
+	pTask.dEnd			= 0.0;
+
+	for ( unsigned int i = 0; i < vDependencies.size(); ++i )
+	{
+		if ( vDependencies[i] < this->vTasks.size() )
+			pTask.vDependencies.push_back( vDependencies[i] );
+	}
+
+	this->vTasks.push_back( pTask );
+	return static_cast<unsigned int>( this->vTasks.size() - 1 );
+}
+
+/*
+ *  Seconds since the graph started running
+ */
+double CTaskGraph::getElapsed()
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count() - this->dStartTime;
+}
+
+/*
+ *  Run every task, using one thread per task that could run at once up
+ *  to the number given. Tasks depending on a failed task are not run.
+ */
+bool CTaskGraph::run( unsigned int uiThreads )
+{
+	std::vector<std::thread>	vWorkers;
+
+	if ( uiThreads == 0 )
+		uiThreads = std::max( 1U, std::thread::hardware_concurrency() );
+	uiThreads = std::min( uiThreads, static_cast<unsigned int>( this->vTasks.size() ) );
+
+	this->uiFinished	= 0;
+	this->dStartTime	= 0.0;
+	this->dStartTime	= this->getElapsed();
+
+	for ( unsigned int i = 0; i < uiThreads; ++i )
+		vWorkers.push_back( std::thread( &CTaskGraph::runWorker, this ) );
+	for ( unsigned int i = 0; i < uiThreads; ++i )
+		vWorkers[i].join();
+
+	for ( unsigned int i = 0; i < this->vTasks.size(); ++i )
+	{
+		if ( this->vTasks[i].ucState != kTaskComplete )
+			return false;
+	}
+	return true;
+}
+
+/*
+ *  Take the first task whose dependencies are complete until none remain
+ */
+void CTaskGraph::runWorker()
+{
+	std::unique_lock<std::mutex> lock( this->mTasks );
+
+	while ( this->uiFinished < this->vTasks.size() )
+	{
+		sTask*	pReady	= NULL;
+
+		for ( unsigned int i = 0; i < this->vTasks.size() && pReady == NULL; ++i )
+		{
+			sTask*	pTask		= &this->vTasks[i];
+			bool	bWaiting	= false,
+					bBlocked	= false;
+
+			if ( pTask->ucState != kTaskPending )
+				continue;
+
+			for ( unsigned int j = 0; j < pTask->vDependencies.size(); ++j )
+			{
+				unsigned char ucState = this->vTasks[ pTask->vDependencies[j] ].ucState;
+				bWaiting = bWaiting || ucState == kTaskPending || ucState == kTaskRunning;
+				bBlocked = bBlocked || ucState == kTaskFailed;
+			}
+
+			if ( bBlocked )
+			{
+				pTask->ucState = kTaskFailed;
+				this->uiFinished++;
+				this->cvTasks.notify_all();
+			}
+			else if ( !bWaiting )
+			{
+				pReady = pTask;
+			}
+		}
+
+		if ( pReady == NULL )
+		{
+			if ( this->uiFinished < this->vTasks.size() )
+				this->cvTasks.wait( lock );
+			continue;
+		}
+
+		pReady->ucState	= kTaskRunning;
+		pReady->dStart	= this->getElapsed();
+		lock.unlock();
+
+		bool bSuccess	= pReady->fnWork();
+
+		lock.lock();
+		pReady->dEnd	= this->getElapsed();
+		pReady->ucState	= bSuccess ? kTaskComplete : kTaskFailed;
+		this->uiFinished++;
+		this->cvTasks.notify_all();
+	}
+}
+
+/*
+ *  Write the time taken by each task, and the chain of tasks which each
+ *  had to wait on the one before, ending with the last task to finish
+ */
+void CTaskGraph::logCriticalPath()
+{
+	std::vector<unsigned int>	vPath;
+	double						dTotal	= 0.0;
+	int							iTask	= -1;
+
+	for ( unsigned int i = 0; i < this->vTasks.size(); ++i )
+	{
+		if ( this->vTasks[i].ucState == kTaskComplete && this->vTasks[i].dEnd >= dTotal )
+		{
+			dTotal	= this->vTasks[i].dEnd;
+			iTask	= static_cast<int>( i );
+		}
+	}
+
+	pManager->log->writeLine( this->sName + " took " + toString( Util::round( dTotal, 2 ) ) + "s:" );
+	for ( unsigned int i = 0; i < this->vTasks.size(); ++i )
+	{
+		if ( this->vTasks[i].ucState == kTaskComplete )
+			pManager->log->writeLine( "  " + this->vTasks[i].sName + ": " + toString( Util::round( this->vTasks[i].dEnd - this->vTasks[i].dStart, 2 ) ) + "s from " + toString( Util::round( this->vTasks[i].dStart, 2 ) ) + "s" );
+	}
+
+	// Each task started when the latest of its dependencies finished
+	while ( iTask >= 0 )
+	{
+		sTask*	pTask	= &this->vTasks[ iTask ];
+		double	dLatest	= -1.0;
+
+		vPath.push_back( static_cast<unsigned int>( iTask ) );
+		iTask = -1;
+		for ( unsigned int j = 0; j < pTask->vDependencies.size(); ++j )
+		{
+			if ( this->vTasks[ pTask->vDependencies[j] ].dEnd > dLatest )
+			{
+				dLatest	= this->vTasks[ pTask->vDependencies[j] ].dEnd;
+				iTask	= static_cast<int>( pTask->vDependencies[j] );
+			}
+		}
+	}
+
+	std::string sPath = "";
+	for ( unsigned int i = static_cast<unsigned int>( vPath.size() ); i > 0; --i )
+		sPath += this->vTasks[ vPath[ i - 1 ] ].sName + ( i > 1 ? " > " : "" );
+	pManager->log->writeLine( "  Critical path: " + sPath );
+}
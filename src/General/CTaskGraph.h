@@ -0,0 +1,84 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ * 
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Dependency graph of tasks run across threads
+ * ------------------------------------------
+ *
+ */
+#ifndef HIPIMS_GENERAL_CTASKGRAPH_H_
+#define HIPIMS_GENERAL_CTASKGRAPH_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+/*
+ *  TASK GRAPH CLASS
+ *  CTaskGraph
+ *
+ *  Runs tasks on a pool of threads as soon as the tasks
+ *  they depend on are complete, then reports the chain of
+ *  tasks which determined the total time.
+ */
+class CTaskGraph
+{
+
+	public:
+
+		CTaskGraph( std::string );															// Constructor
+		~CTaskGraph( void );																// Destructor
+
+		// Public functions
+		unsigned int			addTask( std::string, std::function<bool()>,				// Add a task depending on earlier tasks
+										 std::vector<unsigned int> = std::vector<unsigned int>() );
+		bool					run( unsigned int = 0 );									// Run every task, false if any failed
+		void					logCriticalPath();											// Write the timings and critical path
+
+	private:
+
+		// Private structures
+		struct sTask
+		{
+			std::string					sName;												// Description for reporting
+			std::function<bool()>		fnWork;												// Work to do, false on failure
+			std::vector<unsigned int>	vDependencies;										// Tasks which must complete first
+			unsigned char				ucState;											// Pending, running, complete or failed
+			double						dStart;												// Seconds from the start of the graph
+			double						dEnd;												// Seconds from the start of the graph
+		};
+		enum taskStates
+		{
+			kTaskPending	= 0,
+			kTaskRunning	= 1,
+			kTaskComplete	= 2,
+			kTaskFailed		= 3
+		};
+
+		// Private functions
+		void					runWorker();												// Take ready tasks until none remain
+		double					getElapsed();												// Seconds since the graph started
+
+		// Private variables
+		std::string				sName;														// Description for reporting
+		std::vector<sTask>		vTasks;														// All the tasks in the order added
+		unsigned int			uiFinished;													// Tasks complete or failed
+		double					dStartTime;													// Clock at the start of the run
+		std::mutex				mTasks;														// Guards the task states
+		std::condition_variable	cvTasks;													// Wakes workers when a task finishes
+
+};
+
+#endif
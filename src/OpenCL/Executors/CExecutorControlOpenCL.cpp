@@ -22,10 +22,22 @@
 #include "../../common.h"
 #include "CExecutorControlOpenCL.h"
 #include "COCLDevice.h"
+#include "COCLProgram.h"
+#include "COCLKernel.h"
+#include "COCLBuffer.h"
 #include "../../Datasets/CXMLDataset.h"
 #include <vector>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <chrono>
 #include <boost/lexical_cast.hpp>
 
+// Size and length of the throughput probe
+#define PROBE_GRID_ROWS			512
+#define PROBE_GRID_COLS			512
+#define PROBE_ITERATIONS		50
+
 /*
  *  Constructor
  */
@@ -33,6 +45,9 @@ CExecutorControlOpenCL::CExecutorControlOpenCL(void)
 {
 	this->clDeviceTotal = 0;
 	this->uiSelectedDeviceID = NULL;
+	this->ucQueueMode = model::queueModes::kQueueBarriers;
+	this->ucDeviceSelection = model::deviceSelection::kSelectFirst;
+	this->bDevicesProbed = false;
 
 	if ( !this->getPlatforms() ) return;
 
@@ -66,6 +81,38 @@ void CExecutorControlOpenCL::setupFromConfig( XMLElement* pXNode )
 			if ( strstr( cParameterValue, "apu" ) != NULL )
 				uiDeviceFilter |= model::filters::devices::devicesAPU;
 		}
+		else if ( strcmp( cParameterName, "queuemode" ) == 0 )
+		{
+			if ( strcmp( cParameterValue, "barriers" ) == 0 || strcmp( cParameterValue, "inorder" ) == 0 )
+			{
+				this->setQueueMode( model::queueModes::kQueueBarriers );
+			}
+			else if ( strcmp( cParameterValue, "events" ) == 0 || strcmp( cParameterValue, "outoforder" ) == 0 )
+			{
+				this->setQueueMode( model::queueModes::kQueueEvents );
+			} else {
+				model::doError(
+					"Invalid queue mode given.",
+					model::errorCodes::kLevelWarning
+				);
+			}
+		}
+		else if ( strcmp( cParameterName, "deviceselection" ) == 0 )
+		{
+			if ( strcmp( cParameterValue, "first" ) == 0 )
+			{
+				this->setDeviceSelection( model::deviceSelection::kSelectFirst );
+			}
+			else if ( strcmp( cParameterValue, "probe" ) == 0 || strcmp( cParameterValue, "throughput" ) == 0 )
+			{
+				this->setDeviceSelection( model::deviceSelection::kSelectProbe );
+			} else {
+				model::doError(
+					"Invalid device selection given.",
+					model::errorCodes::kLevelWarning
+				);
+			}
+		}
 		else
 		{
 			model::doError(
@@ -364,8 +411,6 @@ void	CExecutorControlOpenCL::selectDevice()
 	// Check the number of compute units available.
 	// ...
 
-	// TODO: Implement some system of selecting the best device
-	//		 Until then, just pick the first one.
 	if ( this->pDevices.size() < 1 )
 	{
 		model::doError(
@@ -375,6 +420,15 @@ void	CExecutorControlOpenCL::selectDevice()
 		return;
 	}
 
+	// Pick the fastest device if we've been asked to measure them,
+	// otherwise just the first one.
+	if ( this->ucDeviceSelection == model::deviceSelection::kSelectProbe )
+	{
+		this->probeDevices();
+		this->selectDevice( this->uiDeviceRanking[ 0 ] );
+		return;
+	}
+
 	// Select the device
 	this->selectDevice( 1 );
 }
@@ -400,3 +454,275 @@ void	CExecutorControlOpenCL::selectDevice( unsigned int uiDeviceNo )
 
 	this->uiSelectedDeviceID = uiDeviceNo;
 }
+
+/*
+ *  Fetch the nth fastest device (zero-based), so a set of domains marked
+ *  for automatic assignment can be spread over the best devices first.
+ */
+COCLDevice*	CExecutorControlOpenCL::getRankedDevice( unsigned int uiRank )
+{
+	if ( this->pDevices.size() < 1 )
+		return NULL;
+
+	if ( this->ucDeviceSelection != model::deviceSelection::kSelectProbe )
+		return this->getDevice( uiRank % this->pDevices.size() + 1 );
+
+	this->probeDevices();
+	return this->getDevice( this->uiDeviceRanking[ uiRank % this->uiDeviceRanking.size() ] );
+}
+
+/*
+ *  Filename for the probe results on this host. The float precision isn't
+ *  known until the simulation is configured, so results for both are kept.
+ */
+std::string CExecutorControlOpenCL::getProbeCacheFilename()
+{
+	char	cHostname[ 255 ];
+	Util::getHostname( &cHostname[0] );
+
+	return std::string( model::workingDir ) + "/devices." + std::string( cHostname ) + ".cache";
+}
+
+/*
+ *  Rank the devices by throughput for the configured precision. Results are
+ *  cached per host so the probe only runs once for each device and driver.
+ */
+void CExecutorControlOpenCL::probeDevices()
+{
+	if ( this->bDevicesProbed )
+		return;
+
+	std::string		sPrecision	= ( pManager->getFloatPrecision() == model::floatPrecision::kSingle ? "single" : "double" );
+	std::string		sCacheFile	= this->getProbeCacheFilename();
+	std::string		sLine;
+	std::vector<std::string>	vCacheLines;
+	bool			bCacheChanged = false;
+
+	std::ifstream	ifsCache( sCacheFile );
+	while ( std::getline( ifsCache, sLine ) )
+	{
+		if ( !sLine.empty() )
+			vCacheLines.push_back( sLine );
+	}
+	ifsCache.close();
+
+	pManager->log->writeLine( "Ranking devices by " + sPrecision + "-precision throughput." );
+
+	this->dDeviceThroughput.assign( this->pDevices.size(), 0.0 );
+	this->uiDeviceRanking.clear();
+
+	for ( unsigned int i = 0; i < this->pDevices.size(); i++ )
+	{
+		COCLDevice*	pDevice	= this->pDevices[ i ];
+		std::string	sKey	= sPrecision + "\t" +
+							  std::string( pDevice->clDeviceName ) + "\t" +
+							  std::string( pDevice->clDeviceOpenCLDriver ) + "\t";
+		bool		bCached	= false;
+
+		for ( unsigned int j = 0; j < vCacheLines.size(); j++ )
+		{
+			if ( vCacheLines[ j ].compare( 0, sKey.length(), sKey ) != 0 )
+				continue;
+
+			std::string sThroughput = vCacheLines[ j ].substr( sKey.length() );
+			if ( CXMLDataset::isValidFloat( sThroughput ) )
+			{
+				this->dDeviceThroughput[ i ] = boost::lexical_cast<double>( sThroughput );
+				bCached = true;
+			}
+			break;
+		}
+
+		if ( !bCached )
+		{
+			this->dDeviceThroughput[ i ] = this->probeDevice( pDevice );
+			vCacheLines.push_back( sKey + toString( this->dDeviceThroughput[ i ] ) );
+			bCacheChanged = true;
+		}
+
+		pManager->log->writeLine(
+			"  Device #" + toString( i + 1 ) + " (" + pDevice->getDeviceShortName() + "): " +
+			toString( Util::round( this->dDeviceThroughput[ i ] / 1E6, 1 ) ) + " Mcells/s" +
+			( bCached ? " (cached)" : "" )
+		);
+
+		this->uiDeviceRanking.push_back( i + 1 );
+	}
+
+	// Fastest first, keeping the enumeration order between equals
+	std::stable_sort(
+		this->uiDeviceRanking.begin(),
+		this->uiDeviceRanking.end(),
+		[this]( unsigned int a, unsigned int b ) { return this->dDeviceThroughput[ a - 1 ] > this->dDeviceThroughput[ b - 1 ]; }
+	);
+
+	if ( bCacheChanged )
+	{
+		std::ofstream ofsCache( sCacheFile, std::ios::out | std::ios::trunc );
+		if ( ofsCache.is_open() )
+		{
+			for ( unsigned int j = 0; j < vCacheLines.size(); j++ )
+				ofsCache << vCacheLines[ j ] << std::endl;
+		} else {
+			model::doError(
+				"Could not write the device probe cache to " + sCacheFile,
+				model::errorCodes::kLevelWarning
+			);
+		}
+	}
+
+	this->bDevicesProbed = true;
+}
+
+/*
+ *  Run a flux and timestep reduction pair over a synthetic grid on the
+ *  device, and return the number of cells processed per second. Devices
+ *  which can't run the configured precision or fail to build return zero.
+ */
+double CExecutorControlOpenCL::probeDevice( COCLDevice* pDevice )
+{
+	bool			bSingle		= ( pManager->getFloatPrecision() == model::floatPrecision::kSingle );
+	cl_ulong		ulCellCount	= PROBE_GRID_ROWS * PROBE_GRID_COLS;
+	double			dThroughput	= 0.0;
+
+	if ( !bSingle && !pDevice->isDoubleCompatible() )
+		return 0.0;
+
+	// Group sizes within what the device allows
+	cl_ulong		ulGroup2D		= std::min( static_cast<cl_ulong>( 16 ),
+										static_cast<cl_ulong>( floor( sqrt( static_cast<double>( pDevice->clDeviceMaxWorkGroupSize ) ) ) ) );
+	cl_ulong		ulGroupReduce	= 1;
+	while ( ulGroupReduce * 2 <= std::min( static_cast<size_t>( 256 ), pDevice->clDeviceMaxWorkGroupSize ) )
+		ulGroupReduce *= 2;
+	cl_ulong		ulGroupCount	= 64;
+
+	COCLProgram*	pProgram	= new COCLProgram( this, pDevice );
+	pProgram->setForcedSinglePrecision( bSingle );
+	pProgram->registerConstant( "VERY_SMALL",		"1E-10" );
+	pProgram->registerConstant( "QUITE_SMALL",		"1E-9" );
+	pProgram->registerConstant( "DOMAIN_DIR_N",		"0" );
+	pProgram->registerConstant( "DOMAIN_DIR_E",		"1" );
+	pProgram->registerConstant( "DOMAIN_DIR_S",		"2" );
+	pProgram->registerConstant( "DOMAIN_DIR_W",		"3" );
+	pProgram->registerConstant( "DOMAIN_DELTAX_R",	"1.0" );
+	pProgram->registerConstant( "PROBE_ROWS",		toString( PROBE_GRID_ROWS ) );
+	pProgram->registerConstant( "PROBE_COLS",		toString( PROBE_GRID_COLS ) );
+	pProgram->registerConstant( "PROBE_GROUPSIZE",	toString( ulGroupReduce ) );
+	pProgram->registerConstant( "PROBE_TIMESTEP",	"0.01" );
+	pProgram->appendCodeFromResource( "CLSolverHLLC_H" );
+	pProgram->appendCodeFromResource( "CLSolverHLLC_C" );
+	pProgram->appendCodeFromResource( "CLDeviceProbe_C" );
+
+	if ( !pProgram->compileProgram() )
+	{
+		model::doError(
+			"Could not build the throughput probe for device #" + toString( pDevice->getDeviceID() ) + ".",
+			model::errorCodes::kLevelWarning
+		);
+		delete pProgram;
+		return 0.0;
+	}
+
+	unsigned char	ucFloatSize	= pProgram->getFloatSize();
+	COCLBuffer*		pBufferCellsA	= new COCLBuffer( "Probe cells A", pProgram, false, true, ulCellCount * ucFloatSize * 4, true );
+	COCLBuffer*		pBufferCellsB	= new COCLBuffer( "Probe cells B", pProgram, false, true, ulCellCount * ucFloatSize * 4, true );
+	COCLBuffer*		pBufferBed		= new COCLBuffer( "Probe bed", pProgram, true, true, ulCellCount * ucFloatSize, true );
+	COCLBuffer*		pBufferReduce	= new COCLBuffer( "Probe reduction", pProgram, false, true, ulGroupCount * ucFloatSize, true );
+
+	// A sloping bed with a mound of water partly wetting it, so both the wet
+	// and dry branches of the solver are exercised
+	for ( cl_ulong ulCell = 0; ulCell < ulCellCount; ulCell++ )
+	{
+		double	dX		= static_cast<double>( ulCell % PROBE_GRID_COLS ) / PROBE_GRID_COLS - 0.5;
+		double	dY		= static_cast<double>( ulCell / PROBE_GRID_COLS ) / PROBE_GRID_ROWS - 0.5;
+		double	dBed	= 0.5 * dX;
+		double	dFSL	= std::max( dBed, 0.5 - 2.0 * ( dX * dX + dY * dY ) );
+		double	pState[4]	= { dFSL, dFSL, 0.1 * ( dFSL - dBed ), 0.0 };
+
+		for ( unsigned char c = 0; c < 4; c++ )
+		{
+			if ( bSingle )
+			{
+				pBufferCellsA->getHostBlock<cl_float*>()[ ulCell * 4 + c ] = static_cast<cl_float>( pState[ c ] );
+				pBufferCellsB->getHostBlock<cl_float*>()[ ulCell * 4 + c ] = static_cast<cl_float>( pState[ c ] );
+			} else {
+				pBufferCellsA->getHostBlock<cl_double*>()[ ulCell * 4 + c ] = pState[ c ];
+				pBufferCellsB->getHostBlock<cl_double*>()[ ulCell * 4 + c ] = pState[ c ];
+			}
+		}
+
+		if ( bSingle )
+		{
+			pBufferBed->getHostBlock<cl_float*>()[ ulCell ] = static_cast<cl_float>( dBed );
+		} else {
+			pBufferBed->getHostBlock<cl_double*>()[ ulCell ] = dBed;
+		}
+	}
+
+	pBufferCellsA->createBuffer();
+	pBufferCellsB->createBuffer();
+	pBufferBed->createBuffer();
+	pBufferReduce->createBuffer();
+
+	// Ping-pong between the two cell buffers as the schemes do
+	COCLKernel*		pKernelFluxAB		= pProgram->getKernel( "prb_Flux" );
+	COCLKernel*		pKernelFluxBA		= pProgram->getKernel( "prb_Flux" );
+	COCLKernel*		pKernelReduceA		= pProgram->getKernel( "prb_Timestep" );
+	COCLKernel*		pKernelReduceB		= pProgram->getKernel( "prb_Timestep" );
+
+	COCLBuffer*		aryArgsFluxAB[]		= { pBufferCellsA, pBufferBed, pBufferCellsB };
+	COCLBuffer*		aryArgsFluxBA[]		= { pBufferCellsB, pBufferBed, pBufferCellsA };
+	COCLBuffer*		aryArgsReduceA[]	= { pBufferCellsA, pBufferBed, pBufferReduce };
+	COCLBuffer*		aryArgsReduceB[]	= { pBufferCellsB, pBufferBed, pBufferReduce };
+
+	pKernelFluxAB->assignArguments( aryArgsFluxAB );
+	pKernelFluxBA->assignArguments( aryArgsFluxBA );
+	pKernelReduceA->assignArguments( aryArgsReduceA );
+	pKernelReduceB->assignArguments( aryArgsReduceB );
+
+	pKernelFluxAB->setGroupSize( ulGroup2D, ulGroup2D );
+	pKernelFluxAB->setGlobalSize( PROBE_GRID_COLS, PROBE_GRID_ROWS );
+	pKernelFluxBA->setGroupSize( ulGroup2D, ulGroup2D );
+	pKernelFluxBA->setGlobalSize( PROBE_GRID_COLS, PROBE_GRID_ROWS );
+	pKernelReduceA->setGroupSize( ulGroupReduce );
+	pKernelReduceA->setGlobalSize( ulGroupReduce * ulGroupCount );
+	pKernelReduceB->setGroupSize( ulGroupReduce );
+	pKernelReduceB->setGlobalSize( ulGroupReduce * ulGroupCount );
+
+	// Warm up once, so transfers and lazy compilation aren't timed
+	pKernelFluxAB->scheduleExecution();
+	pDevice->queueBarrier();
+	pKernelReduceB->scheduleExecution();
+	pDevice->queueBarrier();
+	pKernelFluxBA->scheduleExecution();
+	pDevice->queueBarrier();
+	pKernelReduceA->scheduleExecution();
+	pDevice->blockUntilFinished();
+
+	std::chrono::steady_clock::time_point	tpStart	= std::chrono::steady_clock::now();
+	for ( unsigned int i = 0; i < PROBE_ITERATIONS; i++ )
+	{
+		// The queue is out-of-order, so each kernel must wait for the last
+		( i % 2 == 0 ? pKernelFluxAB : pKernelFluxBA )->scheduleExecution();
+		pDevice->queueBarrier();
+		( i % 2 == 0 ? pKernelReduceB : pKernelReduceA )->scheduleExecution();
+		pDevice->queueBarrier();
+	}
+	pDevice->blockUntilFinished();
+	double	dSeconds	= std::chrono::duration<double>( std::chrono::steady_clock::now() - tpStart ).count();
+
+	if ( dSeconds > 0.0 )
+		dThroughput = static_cast<double>( ulCellCount ) * PROBE_ITERATIONS / dSeconds;
+
+	delete pKernelFluxAB;
+	delete pKernelFluxBA;
+	delete pKernelReduceA;
+	delete pKernelReduceB;
+	delete pBufferCellsA;
+	delete pBufferCellsB;
+	delete pBufferBed;
+	delete pBufferReduce;
+	delete pProgram;
+
+	return dThroughput;
+}
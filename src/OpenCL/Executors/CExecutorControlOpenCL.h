@@ -21,6 +21,7 @@
 #define HIPIMS_OPENCL_EXECUTORS_CEXECUTORCONTROLOPENCL_H_
 
 #include <vector>
+#include <string>
 #include "../../Base/CExecutorControl.h"
 #include "../opencl.h"
 
@@ -30,6 +31,20 @@ typedef std::vector<char*>			OCL_CODE_STACK;
 
 class COCLDevice;
 
+// Ordering of independent kernels within an iteration
+namespace model {
+namespace queueModes { enum queueModes {
+	kQueueBarriers				= 0,				// Queue barriers separate kernels which conflict
+	kQueueEvents				= 1					// Kernels wait only on the events of those they conflict with
+}; }
+
+// How devices are chosen when not numbered explicitly
+namespace deviceSelection { enum deviceSelection {
+	kSelectFirst				= 0,				// Take the first device which passes the filters
+	kSelectProbe				= 1					// Rank the devices by a measured throughput probe
+}; }
+}
+
 /*
  *  [OPENCL IMPLEMENTATION]
  *  EXECUTOR CONTROL CLASS
@@ -57,10 +72,15 @@ class CExecutorControlOpenCL: public CExecutorControl
 		COCLDevice*				getDevice( unsigned int );			// Fetch a device pointer
 		void					selectDevice();						// Automatically select the best device
 		void					selectDevice( unsigned int );		// Manually select the device to use for execution
+		COCLDevice*				getRankedDevice( unsigned int );	// Fetch the nth fastest device (wraps around)
 		OCL_RAW_CODE			getOCLCode( std::string );			// Fetch OpenCL code stored in our resources
 		bool					createDevices( void );				// Creates new classes for each device
 		unsigned int			getDeviceCount( void )		{ return clDeviceTotal; }		// Returns the number of devices in the system
 		unsigned int			getDeviceCurrent( void )	{ return uiSelectedDeviceID; }	// Returns the active device
+		void					setQueueMode( unsigned char a )	{ ucQueueMode = a; }		// Set how independent kernels are ordered
+		unsigned char			getQueueMode( void )		{ return ucQueueMode; }			// Get how independent kernels are ordered
+		void					setDeviceSelection( unsigned char a )	{ ucDeviceSelection = a; }	// Set how devices are chosen
+		unsigned char			getDeviceSelection( void )	{ return ucDeviceSelection; }	// Get how devices are chosen
 
 	private:
 
@@ -83,11 +103,20 @@ class CExecutorControlOpenCL: public CExecutorControl
 		std::vector<COCLDevice*>							// Dynamic array of device controller classes
 								pDevices;				
 		unsigned int			uiSelectedDeviceID;				// The selected device for use in execution
+		unsigned char			ucQueueMode;					// Ordering of independent kernels (barriers or events)
+		unsigned char			ucDeviceSelection;				// How devices are chosen (first or probed)
+		bool					bDevicesProbed;					// Has the throughput probe been run?
+		std::vector<double>		dDeviceThroughput;				// Measured cells per second for each device
+		std::vector<unsigned int>							// Device numbers from fastest to slowest
+								uiDeviceRanking;
 
 		// Private functions
 		char*					getPlatformInfo( unsigned int, cl_platform_info );	// Fetches information about the platform
 		bool					getPlatforms( void );						// Discovers the platforms available
 		void					logPlatforms( void );						// Write platform details to the log
+		void					probeDevices( void );						// Rank the devices by throughput, using the cache if possible
+		double					probeDevice( COCLDevice* );					// Measure cells per second on one device
+		std::string				getProbeCacheFilename( void );				// Per-host file holding earlier probe results
 };
 
 #endif
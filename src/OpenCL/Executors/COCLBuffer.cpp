@@ -19,6 +19,8 @@
 
 // Includes
 #include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <algorithm>
 
 #include "../../common.h"
 #include "../opencl.h"
@@ -51,6 +53,9 @@ COCLBuffer::COCLBuffer(
 	this->clQueue			= pProgram->getDevice()->clQueue;
 	this->pDevice			= pProgram->getDevice();
 	this->clBuffer			= NULL;
+	this->clPinnedBuffer		= NULL;
+	this->pParent			= NULL;
+	this->ulParentOffset		= 0;
 	this->fCallbackRead		= COCLDevice::defaultCallback;
 	this->fCallbackWrite		= COCLDevice::defaultCallback;
 	this->clFlags			= 0;
@@ -68,6 +73,36 @@ COCLBuffer::COCLBuffer(
 		allocateHostBlock( this->ulSize );
 }
 
+/*
+ *  Constructor for a view onto part of another buffer, sharing its host block
+ */
+COCLBuffer::COCLBuffer(
+		std::string		sName,
+		COCLBuffer*		pParent,
+		cl_ulong		ulOffset,
+		cl_ulong		ulSize
+	)
+{
+	this->sName			= sName;
+	this->bReady			= false;
+	this->bInternalBlock		= false;
+	this->pHostBlock		= NULL;
+	this->bExistsOnHost		= pParent->bExistsOnHost;
+	this->bReadOnly			= pParent->bReadOnly;
+	this->ulSize			= ulSize;
+	this->clContext			= pParent->clContext;
+	this->uiDeviceID		= pParent->uiDeviceID;
+	this->clQueue			= pParent->clQueue;
+	this->pDevice			= pParent->pDevice;
+	this->clBuffer			= NULL;
+	this->clPinnedBuffer		= NULL;
+	this->pParent			= pParent;
+	this->ulParentOffset		= ulOffset;
+	this->fCallbackRead		= COCLDevice::defaultCallback;
+	this->fCallbackWrite		= COCLDevice::defaultCallback;
+	this->clFlags			= ( this->bReadOnly ? CL_MEM_READ_ONLY : CL_MEM_READ_WRITE );
+}
+
 /*
  *  Destructor
  */
@@ -76,6 +111,13 @@ COCLBuffer::~COCLBuffer()
 	if ( this->clBuffer != NULL )
 		cl(clReleaseMemObject( this->clBuffer ));
 
+	if ( this->clPinnedBuffer != NULL )
+	{
+		cl(clEnqueueUnmapMemObject( this->clQueue, this->clPinnedBuffer, this->pHostBlock, 0, NULL, NULL ));
+		cl(clFinish( this->clQueue ));
+		cl(clReleaseMemObject( this->clPinnedBuffer ));
+	}
+
 	if ( bInternalBlock && pHostBlock != NULL )
 		delete [] this->pHostBlock;
 }
@@ -87,6 +129,33 @@ bool COCLBuffer::createBuffer()
 {
 	cl_int	iErrorID;
 
+	// Views onto part of a parent buffer share both its device and host memory
+	if ( this->pParent != NULL )
+	{
+		cl_buffer_region clRegion = { static_cast<size_t>( this->ulParentOffset ), static_cast<size_t>( this->ulSize ) };
+
+		this->pHostBlock = static_cast<cl_uchar*>( this->pParent->pHostBlock ) + this->ulParentOffset;
+		this->clBuffer = clCreateSubBuffer(
+			this->pParent->clBuffer,
+			this->clFlags,
+			CL_BUFFER_CREATE_TYPE_REGION,
+			&clRegion,
+			&iErrorID
+		);
+
+		if ( iErrorID != CL_SUCCESS )
+		{
+			model::doError(
+				"Memory sub-buffer creation failed for '" + this->sName + "'. Error " + toString( iErrorID ) + ".",
+				model::errorCodes::kLevelModelStop
+			);
+			return false;
+		}
+
+		this->bReady = true;
+		return true;
+	}
+
 	// If the memory block is going to reside within this class
 	// and it hasn't been allocated, do so now...
 	if ( this->bInternalBlock &&
@@ -148,6 +217,64 @@ bool COCLBuffer::createBufferAndInitialise()
 	return createBuffer();
 }
 
+/*
+ *  Use page-locked memory that stays mapped for the host copy, so transfers need no staging.
+ *  Falls back to an ordinary host block if the device won't provide one.
+ */
+bool COCLBuffer::createPinnedHostBlock()
+{
+	cl_int	iErrorID;
+
+	this->clPinnedBuffer = clCreateBuffer(
+		this->clContext,
+		CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+		static_cast<size_t>( this->ulSize ),
+		NULL,
+		&iErrorID
+	);
+
+	if ( iErrorID == CL_SUCCESS )
+	{
+		void* pMapped = clEnqueueMapBuffer(
+			this->clQueue,
+			this->clPinnedBuffer,
+			CL_TRUE,
+			CL_MAP_READ | CL_MAP_WRITE,
+			0,
+			static_cast<size_t>( this->ulSize ),
+			0,
+			NULL,
+			NULL,
+			&iErrorID
+		);
+
+		if ( iErrorID == CL_SUCCESS )
+		{
+			if ( this->bInternalBlock && this->pHostBlock != NULL )
+			{
+				std::memcpy( pMapped, this->pHostBlock, static_cast<size_t>( this->ulSize ) );
+				delete [] this->pHostBlock;
+			} else {
+				std::memset( pMapped, 0, static_cast<size_t>( this->ulSize ) );
+			}
+
+			this->pHostBlock	 = pMapped;
+			this->bInternalBlock = false;
+			return true;
+		}
+
+		cl(clReleaseMemObject( this->clPinnedBuffer ));
+		this->clPinnedBuffer = NULL;
+	}
+
+	pManager->log->writeLine( "Pinned host memory unavailable for '" + this->sName + "'." );
+
+	if ( this->pHostBlock == NULL )
+		allocateHostBlock( this->ulSize );
+
+	return false;
+}
+
 /*
  *  Set the location of the host-copy of the buffer if it's not within this class instance
  */
@@ -326,3 +453,33 @@ void COCLBuffer::queueWritePartial(cl_ulong ulOffset, size_t ulSize, void* pMemB
 		}
 	}
 }
+
+/*
+ *  Copy the whole of another buffer on the same device into this one, without
+ *  passing through the host
+ */
+void COCLBuffer::queueCopyFrom( COCLBuffer* pSource )
+{
+	pDevice->markBusy();
+
+	cl_int	iReturn = clEnqueueCopyBuffer(
+		this->clQueue,				// Device queue
+		pSource->clBuffer,			// Source buffer
+		clBuffer,					// Target buffer
+		0,							// Source offset
+		0,							// Target offset
+		static_cast<size_t>( std::min( this->ulSize, pSource->ulSize ) ),	// Size
+		NULL,						// No. of events in wait list
+		NULL,						// Wait list
+		NULL						// Event pointer
+	);
+
+	if ( iReturn != CL_SUCCESS )
+	{
+		model::doError(
+			"Unable to copy memory buffer " + pSource->sName + " to "
+			+ this->sName + " (" + toString( iReturn ) + ")",
+			model::errorCodes::kLevelModelStop
+		);
+	}
+}
@@ -28,6 +28,7 @@ class COCLBuffer
 {
 public:
 	COCLBuffer( std::string, COCLProgram*, bool Read_Only = false, bool Exists_On_Host = true, cl_ulong Length_In_Bytes = NULL, bool Allocate_Now = false );
+	COCLBuffer( std::string, COCLBuffer*, cl_ulong Offset_In_Bytes, cl_ulong Length_In_Bytes );
 	~COCLBuffer();
 	std::string		getName()							{ return sName; }
 	cl_mem			getBuffer()							{ return clBuffer; }
@@ -41,12 +42,14 @@ public:
 	blockType		getHostBlock()						{ return static_cast<blockType>( this->pHostBlock ); }
 	bool			createBuffer();
 	bool			createBufferAndInitialise();
+	bool			createPinnedHostBlock();
 	void			setPointer( void*, cl_ulong );
 	void			allocateHostBlock( cl_ulong );
 	void			queueReadAll();
 	void			queueReadPartial( cl_ulong, size_t, void* = NULL );
 	void			queueWriteAll();
 	void			queueWritePartial( cl_ulong, size_t, void* = NULL );
+	void			queueCopyFrom( COCLBuffer* );
 
 protected:
 	cl_uint			uiDeviceID;
@@ -55,6 +58,9 @@ protected:
 	cl_context		clContext;
 	cl_command_queue clQueue;
 	cl_mem			clBuffer;
+	cl_mem			clPinnedBuffer;
+	COCLBuffer*		pParent;
+	cl_ulong		ulParentOffset;
 	void*			pHostBlock;
 	COCLDevice*		pDevice;
 	cl_ulong		ulSize;
@@ -47,6 +47,9 @@ COCLKernel::COCLKernel(
 	this->uiDeviceID		= program->getDevice()->uiDeviceNo;
 	this->clQueue			= program->getDevice()->clQueue;
 	this->fCallback			= COCLDevice::defaultCallback;
+	this->uiWaitEventCount	= 0;
+	this->pWaitEvents		= NULL;
+	this->pCompletionEvent	= NULL;
 	this->szGlobalSize[0] = 1;	 this->szGlobalSize[1] = 1;	  this->szGlobalSize[2] = 1;
 	this->szGroupSize[0] = 1;	 this->szGroupSize[1] = 1;	  this->szGroupSize[2] = 1;
 	this->szGlobalOffset[0] = 0; this->szGlobalOffset[1] = 0; this->szGlobalOffset[2] = 0;
@@ -71,10 +74,19 @@ COCLKernel::~COCLKernel()
  */
 void COCLKernel::scheduleExecution()
 {
+	// Dependencies only ever apply to the next execution
+	cl_uint			uiWaitCount	= this->uiWaitEventCount;
+	const cl_event*	pWaitList	= this->pWaitEvents;
+	cl_event*		pCompletion	= this->pCompletionEvent;
+	this->uiWaitEventCount		= 0;
+	this->pWaitEvents			= NULL;
+	this->pCompletionEvent		= NULL;
+
 	if ( !this->bReady ) return;
 
 	cl_event		clEvent		= NULL;
 	cl_int			iErrorID	= CL_SUCCESS;
+	bool			bCallback	= ( fCallback != NULL && fCallback != COCLDevice::defaultCallback );
 #ifdef DEBUG_OPENCL
 	pManager->log->writeLine("OPENCL KERNEL START: #" + toString( this->uiDeviceID ) + " kernel: " + sName + "\n");
 #endif
@@ -87,9 +99,9 @@ void COCLKernel::scheduleExecution()
 		szGlobalOffset,
 		szGlobalSize,
 		szGroupSize,
-		NULL,
-		NULL,
-		( fCallback != NULL && fCallback != COCLDevice::defaultCallback ? &clEvent : NULL )
+		uiWaitCount,
+		uiWaitCount > 0 ? pWaitList : NULL,
+		( bCallback || pCompletion != NULL ? &clEvent : NULL )
 	);
 
 	if ( iErrorID != CL_SUCCESS )
@@ -103,7 +115,15 @@ void COCLKernel::scheduleExecution()
 		return;
 	}
 
-	if ( fCallback != NULL && fCallback != COCLDevice::defaultCallback )
+	// The caller releases the completion event, the callback its own reference
+	if ( pCompletion != NULL )
+	{
+		*pCompletion = clEvent;
+		if ( bCallback )
+			clRetainEvent( clEvent );
+	}
+
+	if ( bCallback )
 	{
 		iErrorID = clSetEventCallback(
 			clEvent,
@@ -132,6 +152,24 @@ void COCLKernel::scheduleExecution()
 
 }
 
+/*
+ *  Make the next execution wait on a list of events rather than a
+ *  queue barrier, and optionally return an event for its completion
+ */
+void COCLKernel::setEventDependencies(
+		cl_uint				uiWaitCount,
+		const cl_event*		pWaitList,
+		cl_event*			pCompletion
+	)
+{
+	this->uiWaitEventCount	= uiWaitCount;
+	this->pWaitEvents		= pWaitList;
+	this->pCompletionEvent	= pCompletion;
+
+	if ( pCompletion != NULL )
+		*pCompletion = NULL;
+}
+
 /*
  *  Schedule the kernel for execution on the device
  */
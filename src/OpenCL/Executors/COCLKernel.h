@@ -41,6 +41,7 @@ public:
 																	{ fCallback = cb; }
 
 	void			scheduleExecution();
+	void			setEventDependencies( cl_uint, const cl_event*, cl_event* );
 	void			scheduleExecutionAndFlush();
 	bool			assignArguments( COCLBuffer* Buffer_Arguments[] );
 	bool			assignArgument( unsigned char Index, COCLBuffer* Buffer_Argument );
@@ -62,6 +63,9 @@ protected:
 	size_t			szGlobalOffset[3];
 	size_t			szGroupSize[3];
 	cl_uint			uiArgumentCount;
+	cl_uint			uiWaitEventCount;
+	const cl_event*	pWaitEvents;
+	cl_event*		pCompletionEvent;
 	cl_ulong		ulMemPrivate;
 	cl_ulong		ulMemLocal;
 	std::string		sName;
@@ -53,11 +53,23 @@ COCLProgram::~COCLProgram()
 }
 
 /*
- *  Attempt to build the program
+ *  Attempt to create and build the program
  */
 bool COCLProgram::compileProgram(
 		bool	bIncludeStandardElements
 	)
+{
+	return this->createProgram( bIncludeStandardElements ) &&
+		   this->buildProgram();
+}
+
+/*
+ *  Create the program from the code stack, which is cheap compared with
+ *  building it and must follow any constants being registered
+ */
+bool COCLProgram::createProgram(
+		bool	bIncludeStandardElements
+	)
 {
 	cl_int		iErrorID;
 
@@ -79,8 +91,6 @@ bool COCLProgram::compileProgram(
 	// For intel debugging only!
 	//this->sCompileParameters += " -g";
 
-	pManager->log->writeLine( "Compiling a new program for device #" + toString( this->device->getDeviceID() ) + "." );
-
 	// Should we add standard elements to the code stack first?
 	if ( bIncludeStandardElements )
 	{
@@ -102,6 +112,8 @@ bool COCLProgram::compileProgram(
 		&iErrorID
 	);
 
+	delete[] orcCode;
+
 	if ( iErrorID != CL_SUCCESS )
 	{
 		model::doError(
@@ -111,6 +123,22 @@ bool COCLProgram::compileProgram(
 		return false;
 	}
 
+	return true;
+}
+
+/*
+ *  Build a created program, which is the slow part and
+ *  doesn't depend on anything held on the host
+ */
+bool COCLProgram::buildProgram()
+{
+	cl_int		iErrorID;
+
+	if ( this->clProgram == NULL )
+		return false;
+
+	pManager->log->writeLine( "Compiling a new program for device #" + toString( this->device->getDeviceID() ) + "." );
+
 	iErrorID = clBuildProgram(
 		clProgram,																		// Program
 		NULL,																			// Num. devices
@@ -120,6 +148,11 @@ bool COCLProgram::compileProgram(
 		NULL																			// Callback data
 	);
 
+	cl_uint			uiStackLength	= static_cast<cl_uint>( oclCodeStack.size() );
+	OCL_RAW_CODE*	orcCode			= new char* [ uiStackLength ];
+	for ( unsigned int i = 0; i < uiStackLength; i++ )
+		orcCode[ i ] = oclCodeStack[ i ];
+
 	if ( iErrorID != CL_SUCCESS )
 	{
 		model::doError(
@@ -130,6 +163,7 @@ bool COCLProgram::compileProgram(
 		pManager->log->writeLine( this->getCompileLog(), false );
 		pManager->log->writeDivide();
 		pManager->log->writeDebugFile( orcCode, uiStackLength );
+		delete[] orcCode;
 		return false;
 	}
 
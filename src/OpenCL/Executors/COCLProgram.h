@@ -38,6 +38,8 @@ public:
 	cl_context					getContext()							{ return clContext; }
 	bool						isCompiled()							{ return bCompiled; }
 	bool						compileProgram( bool = true );
+	bool						createProgram( bool = true );
+	bool						buildProgram();
 	void						appendCode( OCL_RAW_CODE );
 	void						prependCode( OCL_RAW_CODE );
 	void						appendCodeFromResource( std::string );
@@ -25,6 +25,7 @@
 #include "CSchemeGodunov.h"
 #include "CSchemeMUSCLHancock.h"
 #include "CSchemeInertial.h"
+#include "CSchemeCellularAutomata.h"
 #include "../Domain/CDomain.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
 #include "../Datasets/CXMLDataset.h"
@@ -129,6 +130,9 @@ CScheme* CScheme::createScheme( unsigned char ucType )
 		case model::schemeTypes::kInertialSimplification:
 			return static_cast<CScheme*>( new CSchemeInertial() );
 		break;
+		case model::schemeTypes::kCellularAutomata:
+			return static_cast<CScheme*>( new CSchemeCellularAutomata() );
+		break;
 	}
 
 	return NULL;
@@ -163,6 +167,12 @@ CScheme* CScheme::createFromConfig( XMLElement *pXScheme )
 		pScheme	= CScheme::createScheme(
 			model::schemeTypes::kInertialSimplification
 		);
+	} else if ( strcmp( cSchemeName, "cellular-automata" ) == 0 || strcmp( cSchemeName, "wca2d" ) == 0 )
+	{
+		pManager->log->writeLine( "Weighted cellular automata scheme specified for the domain." );
+		pScheme	= CScheme::createScheme(
+			model::schemeTypes::kCellularAutomata
+		);
 	} else {
 		model::doError(
 			"Unsupported scheme specified for the domain.",
@@ -305,6 +315,18 @@ bool	CScheme::isRunning()
 
 void	CScheme::setRunning(bool running = true)
 {
-	std::unique_lock<std::shared_mutex> lock(mRunning);
-	bRunning = running;
+	{
+		std::unique_lock<std::shared_mutex> lock(mRunning);
+		bRunning = running;
+	}
+	cvRunning.notify_all();
+}
+
+/*
+ *	Block the calling thread until the batch in progress completes
+ */
+void	CScheme::waitUntilIdle()
+{
+	std::shared_lock<std::shared_mutex> lock(mRunning);
+	cvRunning.wait(lock, [this] { return !this->bRunning; });
 }
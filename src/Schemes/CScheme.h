@@ -29,13 +29,15 @@
 
 #include <atomic>
 #include <shared_mutex>
+#include <condition_variable>
 namespace model {
 
 // Model scheme types
 namespace schemeTypes{ enum schemeTypes {
 	kGodunov							= 0,	// Godunov (first-order)
 	kMUSCLHancock						= 1,	// MUSCL-Hancock (second-order)
-	kInertialSimplification				= 2		// Inertial simplification
+	kInertialSimplification				= 2,	// Inertial simplification
+	kCellularAutomata					= 3		// Weighted cellular automata (WCA2D)
 }; }
 
 // Riemann solver types
@@ -88,8 +90,12 @@ class CScheme
 		bool				isReady();																// Is the scheme ready to run?
 		bool				isRunning();															// Is this scheme currently running a batch?
 		void				setRunning(bool);
+		void				waitUntilIdle();														// Sleep until the current batch completes
 		virtual void		logDetails() = 0;														// Write some details about the scheme
 		virtual void		prepareAll() = 0;														// Prepare absolutely everything for a model run
+		virtual bool		prepareSetup() = 0;														// Prepare everything which doesn't need the built program
+		virtual bool		prepareProgram() = 0;													// Build the program
+		virtual bool		prepareFinish() = 0;													// Create kernels and boundaries once built
 		virtual double		proposeSyncPoint( double ) = 0;											// Propose a synchronisation point
 		virtual void		forceTimestep(double) = 0;												// Force a specific timestep
 		void				setQueueMode( unsigned char );											// Set the queue mode
@@ -124,12 +130,20 @@ class CScheme
 		virtual void		runSimulation( double, double ) = 0;									// Run this simulation until the specified time
 		virtual void		cleanupSimulation() = 0;												// Dispose of transient data and clean-up this domain
 		virtual void		rollbackSimulation( double, double ) = 0;								// Roll back cell states to the last successful round
+		virtual void		branchSimulation( double ) = 0;											// Restart from the host copy of the domain at an earlier time
 		virtual void		saveCurrentState() = 0;													// Save current cell states
 		virtual void		forceTimeAdvance() = 0;													// Force time advance (when synced will stall)
 		virtual bool		isSimulationFailure( double ) = 0;										// Check whether we successfully reached a specific time
 		virtual bool		isSimulationSyncReady( double ) = 0;									// Are we ready to synchronise? i.e. have we reached the set sync time?
 		virtual COCLBuffer*	getLastCellSourceBuffer() = 0;											// Get the last source cell state buffer
 		virtual COCLBuffer*	getNextCellSourceBuffer() = 0;											// Get the next source cell state buffer
+		virtual void		readDomainRange( unsigned char, unsigned long, unsigned long, void* ) = 0;	// Read part of a cell data array from the device (blocking)
+		virtual void		writeDomainRange( unsigned char, unsigned long, unsigned long, void* ) = 0;	// Write part of a cell data array to the device (blocking)
+		virtual void		preparePreview( unsigned long, unsigned long, unsigned int, unsigned int ) {}	// Prepare the on-device preview pyramid
+		virtual void		requestPreview()				{}										// Request a preview with the next batch
+		virtual bool		isPreviewReady()				{ return false; }						// Has a requested preview been read back?
+		virtual cl_float*	getPreviewLevel( unsigned int, unsigned int*, unsigned int* ) { return NULL; }	// Fetch a level of the preview pyramid
+		virtual void		releasePreview()				{}										// Finished with the preview data on the host
 
 	protected:
 
@@ -138,6 +152,7 @@ class CScheme
 
 		// Private variables
 		std::shared_mutex		mRunning;
+		std::condition_variable_any	cvRunning;																// Wakes the worker thread when work is scheduled
 		std::atomic<bool>		bRunning;																// Is this simulation currently running?
 		std::atomic<bool>		bThreadRunning;															// Is the worker thread running?
 		std::atomic<bool>		bThreadTerminated;														// Has the worker thread been terminated?
@@ -0,0 +1,261 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ * 
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Weighted cellular automata (WCA2D)
+ * ------------------------------------------
+ *
+ */
+#include "../common.h"
+#include "../Boundaries/CBoundaryMap.h"
+#include "../Domain/CDomain.h"
+#include "../Domain/Cartesian/CDomainCartesian.h"
+#include "CSchemeCellularAutomata.h"
+
+/*
+ *  Constructor
+ */
+CSchemeCellularAutomata::CSchemeCellularAutomata(void)
+{
+	// Scheme is loaded
+	pManager->log->writeLine( "Cellular automata scheme loaded for execution on OpenCL platform." );
+
+	// Default setup values
+	this->bDebugOutput					= false;
+	this->uiDebugCellX					= 100;
+	this->uiDebugCellY					= 100;
+}
+
+/*
+ *  Destructor
+ */
+CSchemeCellularAutomata::~CSchemeCellularAutomata(void)
+{
+	this->releaseResources();
+	pManager->log->writeLine( "The cellular automata scheme was unloaded from memory." );
+}
+
+/*
+ *  Prepare everything which doesn't need the built program
+ */
+bool CSchemeCellularAutomata::prepareSetup()
+{
+	// Clean any pre-existing OpenCL objects
+	this->releaseResources();
+
+	oclModel = new COCLProgram(
+		pManager->getExecutor(),
+		pManager->getExecutor()->getDevice()
+	);
+
+	// Run-time tracking values
+	this->ulCurrentCellsCalculated		= 0;
+	this->dCurrentTimestep				= this->dTimestep;
+	this->dCurrentTime					= 0;
+
+	// Forcing single precision?
+	this->oclModel->setForcedSinglePrecision( pManager->getFloatPrecision() == model::floatPrecision::kSingle );
+
+	// The transition rules carry depth alone
+	if ( this->bScalarTransport )
+	{
+		model::doError(
+			"Scalar transport is only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bScalarTransport = false;
+	}
+	if ( this->bFusedSources )
+	{
+		model::doError(
+			"Fused sources are only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bFusedSources = false;
+	}
+	if ( this->pDomain->hasDrainageCapacity() )
+	{
+		model::doError(
+			"Drainage capacity is only applied by the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+	}
+
+	// The timestep is bound by the discharges rather than wave speeds, so
+	// the reduction can't tell whether the domain is dry
+	if ( this->bDryFastForward )
+	{
+		model::doError(
+			"Dry fast-forward is not available with the cellular automata scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bDryFastForward = false;
+	}
+
+	// OpenCL elements
+	if ( !this->prepare1OExecDimensions() ) 
+	{ 
+		model::doError(
+			"Failed to dimension 1st-order task elements. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	if ( !this->prepare1OConstants() ) 
+	{ 
+		model::doError(
+			"Failed to allocate 1st-order constants. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	if ( !this->prepareCode() ) 
+	{ 
+		model::doError(
+			"Failed to prepare model codebase. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	if ( !this->prepare1OMemory() ) 
+	{ 
+		model::doError(
+			"Failed to create 1st-order memory buffers. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *  Create the kernels and boundaries once the program is built
+ */
+bool CSchemeCellularAutomata::prepareFinish()
+{
+	if ( !this->prepareGeneralKernels() ) 
+	{ 
+		model::doError(
+			"Failed to prepare general kernels. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+	if ( !this->prepareCellularAutomataKernels() ) 
+	{ 
+		model::doError(
+			"Failed to prepare cellular automata kernels. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	if (!this->prepareBoundaries())
+	{
+		model::doError(
+			"Failed to prepare boundaries. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+			);
+		this->releaseResources();
+		return false;
+	}
+
+	this->logDetails();
+	this->bReady = true;
+	return true;
+}
+
+/*
+ *  Log the details and properties of this scheme instance.
+ */
+void CSchemeCellularAutomata::logDetails()
+{
+	pManager->log->writeDivide();
+	unsigned short wColour = model::cli::colourInfoBlock;
+
+	pManager->log->writeLine( "WEIGHTED CELLULAR AUTOMATA SCHEME (WCA2D)", true, wColour );
+	pManager->log->writeLine( "  Timestep mode:      " + (std::string)( this->bDynamicTimestep ? "Dynamic" : "Fixed" ), true, wColour );
+	pManager->log->writeLine( "  Courant number:     " + (std::string)( this->bDynamicTimestep ? toString( this->dCourantNumber ) : "N/A" ), true, wColour );
+	pManager->log->writeLine( "  Initial timestep:   " + Util::secondsToTime( this->dTimestep ), true, wColour );
+	pManager->log->writeLine( "  Data reduction:     " + toString( this->uiTimestepReductionWavefronts ) + " divisions", true, wColour );
+	pManager->log->writeLine( "  Boundaries:         " + toString( this->pDomain->getBoundaries()->getBoundaryCount() ), true, wColour );
+	pManager->log->writeLine( "  Kernel queue mode:  " + (std::string)( this->bAutomaticQueue ? "Automatic" : "Fixed size" ), true, wColour );
+	pManager->log->writeLine( (std::string)( this->bAutomaticQueue ? "  Initial queue:      " : "  Fixed queue:        " ) + toString( this->uiQueueAdditionSize ) + " iteration(s)", true, wColour );
+	pManager->log->writeLine( "  Debug output:       " + (std::string)( this->bDebugOutput ? "Enabled" : "Disabled" ), true, wColour );
+	
+	pManager->log->writeDivide();
+}
+
+/*
+ *  Concatenate together the code for the different elements required
+ */
+bool CSchemeCellularAutomata::prepareCode()
+{
+	bool bReturnState = true;
+
+	oclModel->appendCodeFromResource( "CLDomainCartesian_H" );
+	oclModel->appendCodeFromResource( "CLFriction_H" );
+	oclModel->appendCodeFromResource( "CLDynamicTimestep_H" );
+	oclModel->appendCodeFromResource( "CLSchemeCellularAutomata_H" );
+	oclModel->appendCodeFromResource( "CLBoundaries_H" );
+
+	oclModel->appendCodeFromResource( "CLDomainCartesian_C" );
+	oclModel->appendCodeFromResource( "CLFriction_C" );
+	oclModel->appendCodeFromResource( "CLDynamicTimestep_C" );
+	oclModel->appendCodeFromResource( "CLSchemeCellularAutomata_C" );
+	oclModel->appendCodeFromResource( "CLBoundaries_C" );
+
+	bReturnState = oclModel->createProgram();
+
+	return bReturnState;
+}
+
+/*
+ *  Create kernels using the compiled program. The whole step is a single
+ *  pass, taking the place of the Godunov-type full timestep kernel so the
+ *  cell state buffers alternate in exactly the same way.
+ */
+bool CSchemeCellularAutomata::prepareCellularAutomataKernels()
+{
+	bool						bReturnState		= true;
+
+	oclKernelFullTimestep = oclModel->getKernel( "wca_Timestep" );
+	oclKernelFullTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
+	oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, this->ulNonCachedGlobalSizeY );
+	COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning };	
+	oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
+
+	return bReturnState;
+}
+
+/*
+ *  Release all OpenCL resources consumed using the OpenCL methods
+ */
+void CSchemeCellularAutomata::releaseResources()
+{
+	this->bReady = false;
+
+	pManager->log->writeLine("Releasing scheme resources held for OpenCL.");
+
+	this->release1OResources();
+}
@@ -0,0 +1,54 @@
+/*
+ * ------------------------------------------
+ *
+ *  HIGH-PERFORMANCE INTEGRATED MODELLING SYSTEM (HiPIMS)
+ *  Luke S. Smith and Qiuhua Liang
+ *  luke@smith.ac
+ *
+ *  School of Civil Engineering & Geosciences
+ *  Newcastle University
+ * 
+ * ------------------------------------------
+ *  This code is licensed under GPLv3. See LICENCE
+ *  for more information.
+ * ------------------------------------------
+ *  Weighted cellular automata (WCA2D)
+ * ------------------------------------------
+ *
+ */
+#ifndef HIPIMS_SCHEMES_CSCHEMECELLULARAUTOMATA_H_
+#define HIPIMS_SCHEMES_CSCHEMECELLULARAUTOMATA_H_
+
+#include "CSchemeGodunov.h"
+
+/*
+ *  SCHEME CLASS
+ *  CSchemeCellularAutomata
+ *
+ *  Rapid screening scheme which distributes volume
+ *  between cells by weighted transition rules,
+ *  rather than solving the momentum equations.
+ */
+class CSchemeCellularAutomata : public CSchemeGodunov
+{
+
+	public:
+
+		CSchemeCellularAutomata( void );									// Constructor
+		virtual ~CSchemeCellularAutomata( void );							// Destructor
+
+		// Public functions
+		virtual void		logDetails();									// Write some details about the scheme
+		virtual bool		prepareSetup();									// Prepare everything which doesn't need the built program
+		virtual bool		prepareFinish();								// Create kernels and boundaries once built
+
+	protected:
+
+		// Private functions
+		virtual bool		prepareCode();									// Prepare the code required
+		virtual void		releaseResources();								// Release OpenCL resources consumed
+		bool				prepareCellularAutomataKernels();				// Prepare the kernels required
+
+};
+
+#endif
@@ -60,11 +60,37 @@ CSchemeGodunov::CSchemeGodunov()
 	this->dThresholdQuiteSmall			= this->dThresholdVerySmall * 10;
 	this->bFrictionInFluxKernel			= true;
 	this->bIncludeBoundaries			= false;
+	this->bScalarTransport				= false;
+	this->bFusedSources				= false;
+	this->pFusedUniform				= NULL;
+	this->pFusedGridded				= NULL;
+	this->bFusedDrainage			= false;
+	this->bHydrologicalSubcycling			= false;
+	this->dHydrologicalTimestep			= 0.25;
+	this->uiHydrologicalCountdown			= 1;
+	this->dSyncLagSafety				= 0.0;
+	this->dTimestepLimit				= 0.0;
+	this->dTimeViolated				= -1.0;
+	this->uiLaggedIterationsSinceSync		= 0;
+	this->bLaggedRedoIncomplete			= false;
+	this->bDryFastForward				= false;
+	this->dDryFastForwardDepth			= 1E-3;
+	this->uiQuiescent				= 0;
+	this->bHealthMonitor				= false;
+	this->dHealthCourantFactor			= 0.5;
+	this->dHealthRecoveryWindow			= 300.0;
+	this->dHealthMaxVelocity			= 50.0;
+	this->dHealthRecoverUntil			= -1.0;
+	this->uiHealthRecoveries			= 0;
+	this->dSnapshotTime				= 0.0;
 	this->uiTimestepReductionWavefronts = 200;
 
 	this->ucSolverType				= model::solverTypes::kHLLC;
 	this->ucConfiguration				= model::schemeConfigurations::godunovType::kCacheNone;
 	this->ucCacheConstraints			= model::cacheConstraints::godunovType::kCacheActualSize;
+	this->uiCoarseningFactor			= 4;
+	this->ucGhostCells					= 1;
+	this->bGhostFill					= false;
 
 	this->ulCachedWorkgroupSizeX		= 0;
 	this->ulCachedWorkgroupSizeY		= 0;
@@ -77,6 +103,9 @@ CSchemeGodunov::CSchemeGodunov()
 	this->ulBoundaryRelationCells		= NULL;
 	this->uiBoundaryRelationSeries		= NULL;
 
+	this->bPreviewRequested				= false;
+	this->bPreviewReady					= false;
+
 	// Default null values for OpenCL objects
 	oclModel							= NULL;
 	oclKernelFullTimestep				= NULL;
@@ -84,16 +113,34 @@ CSchemeGodunov::CSchemeGodunov()
 	oclKernelTimestepReduction			= NULL;
 	oclKernelTimeAdvance				= NULL;
 	oclKernelResetCounters				= NULL;
+	oclKernelResetHydrological			= NULL;
 	oclKernelTimestepUpdate				= NULL;
+	oclKernelGhostFill					= NULL;
 	oclBufferCellStates					= NULL;
 	oclBufferCellStatesAlt				= NULL;
+	oclBufferCellStatesSaved			= NULL;
+	oclBufferCellScalars				= NULL;
+	oclBufferCellScalarsAlt				= NULL;
 	oclBufferCellManning				= NULL;
 	oclBufferCellBed					= NULL;
+	oclBufferCellDrainage				= NULL;
+	oclBufferControl					= NULL;
 	oclBufferTimestep					= NULL;
 	oclBufferTimestepReduction			= NULL;
 	oclBufferTime						= NULL;
 	oclBufferTimeTarget					= NULL;
 	oclBufferTimeHydrological			= NULL;
+	oclBufferTimeHydrologicalIdle		= NULL;
+	oclBufferBatchTimesteps				= NULL;
+	oclBufferBatchSuccessful			= NULL;
+	oclBufferBatchSkipped				= NULL;
+	oclBufferTimestepLagged				= NULL;
+	oclBufferTimestepLimit				= NULL;
+	oclBufferTimeViolated				= NULL;
+	oclBufferQuiescent					= NULL;
+	oclBufferHealth						= NULL;
+	oclBufferCourantNumber				= NULL;
+	oclBufferPreview					= NULL;
 
 	if ( this->bDebugOutput )
 		model::doError( "Debug mode is enabled!", model::errorCodes::kLevelWarning );
@@ -273,6 +320,19 @@ void	CSchemeGodunov::setupFromConfig( XMLElement* pXScheme, bool bInheritanceCha
 				}
 			}
 		}
+		else if ( strcmp( cParameterName, "coarseningfactor" ) == 0 )
+		{
+			if ( !CXMLDataset::isValidUnsignedInt( cParameterValue ) ||
+				 boost::lexical_cast<unsigned int>( cParameterValue ) < 1 )
+			{
+				model::doError(
+					"Invalid coarsening factor given.",
+					model::errorCodes::kLevelWarning
+				);
+			} else {
+				this->setCoarseningFactor( boost::lexical_cast<unsigned int>( cParameterValue ) );
+			}
+		}
 		else if ( strcmp( cParameterName, "noncachedgroupsize" ) == 0 )
 		{
 			std::string sParameterValue = std::string( cParameterValue );
@@ -305,6 +365,8 @@ void	CSchemeGodunov::setupFromConfig( XMLElement* pXScheme, bool bInheritanceCha
 					usCache = model::schemeConfigurations::godunovType::kCacheEnabled;
 				if ( strcmp( cParameterValue, "none" ) == 0 || strcmp( cParameterValue, "no" ) == 0 )
 					usCache = model::schemeConfigurations::godunovType::kCacheNone;
+				if ( strcmp( cParameterValue, "coarsened" ) == 0 || strcmp( cParameterValue, "strip" ) == 0 )
+					usCache = model::schemeConfigurations::godunovType::kCacheCoarsened;
 				if ( usCache == 255 )
 				{
 					model::doError(
@@ -315,6 +377,141 @@ void	CSchemeGodunov::setupFromConfig( XMLElement* pXScheme, bool bInheritanceCha
 					this->setCacheMode( usCache );
 				}
 			}
+			else if ( strcmp( cParameterName, "scalartransport" ) == 0 )
+			{
+				unsigned char ucScalar = 255;
+				if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+					ucScalar = 1;
+				if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+					ucScalar = 0;
+				if ( ucScalar == 255 )
+				{
+					model::doError(
+						"Invalid scalar transport state given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setScalarTransport( ucScalar == 1 );
+				}
+			}
+			else if ( strcmp( cParameterName, "fusesources" ) == 0 )
+			{
+				unsigned char ucFused = 255;
+				if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+					ucFused = 1;
+				if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+					ucFused = 0;
+				if ( ucFused == 255 )
+				{
+					model::doError(
+						"Invalid source fusion state given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setFusedSources( ucFused == 1 );
+				}
+			}
+			else if ( strcmp( cParameterName, "hydrologicalsubcycling" ) == 0 )
+			{
+				unsigned char ucSubcycling = 255;
+				if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+					ucSubcycling = 1;
+				if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+					ucSubcycling = 0;
+				if ( ucSubcycling == 255 )
+				{
+					model::doError(
+						"Invalid hydrological sub-cycling state given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setHydrologicalSubcycling( ucSubcycling == 1 );
+				}
+			}
+			else if ( strcmp( cParameterName, "dryfastforward" ) == 0 )
+			{
+				unsigned char ucFastForward = 255;
+				if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+					ucFastForward = 1;
+				if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+					ucFastForward = 0;
+				if ( ucFastForward == 255 )
+				{
+					model::doError(
+						"Invalid dry fast-forward state given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setDryFastForward( ucFastForward == 1 );
+				}
+			}
+			else if ( strcmp( cParameterName, "dryfastforwarddepth" ) == 0 )
+			{
+				if ( !CXMLDataset::isValidFloat( cParameterValue ) )
+				{
+					model::doError(
+						"Invalid dry fast-forward depth given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setDryFastForwardDepth( boost::lexical_cast<double>( cParameterValue ) );
+				}
+			}
+			else if ( strcmp( cParameterName, "healthmonitor" ) == 0 )
+			{
+				unsigned char ucHealthMonitor = 255;
+				if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+					ucHealthMonitor = 1;
+				if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+					ucHealthMonitor = 0;
+				if ( ucHealthMonitor == 255 )
+				{
+					model::doError(
+						"Invalid health monitor state given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setHealthMonitor( ucHealthMonitor == 1 );
+				}
+			}
+			else if ( strcmp( cParameterName, "healthcourantfactor" ) == 0 )
+			{
+				if ( !CXMLDataset::isValidFloat( cParameterValue ) ||
+					 boost::lexical_cast<double>( cParameterValue ) <= 0.0 ||
+					 boost::lexical_cast<double>( cParameterValue ) >= 1.0 )
+				{
+					model::doError(
+						"Invalid health recovery Courant factor given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setHealthRecovery( boost::lexical_cast<double>( cParameterValue ), this->dHealthRecoveryWindow );
+				}
+			}
+			else if ( strcmp( cParameterName, "healthrecoverywindow" ) == 0 )
+			{
+				if ( !CXMLDataset::isValidFloat( cParameterValue ) )
+				{
+					model::doError(
+						"Invalid health recovery window given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setHealthRecovery( this->dHealthCourantFactor, boost::lexical_cast<double>( cParameterValue ) );
+				}
+			}
+			else if ( strcmp( cParameterName, "healthmaxvelocity" ) == 0 )
+			{
+				if ( !CXMLDataset::isValidFloat( cParameterValue ) )
+				{
+					model::doError(
+						"Invalid health monitor maximum velocity given.",
+						model::errorCodes::kLevelWarning
+					);
+				} else {
+					this->setHealthMaxVelocity( boost::lexical_cast<double>( cParameterValue ) );
+				}
+			}
 			else if ( strcmp( cParameterName, "localcacheconstraints" ) == 0 )
 			{
 				unsigned char ucCacheConstraints = 255;
@@ -365,6 +562,9 @@ void CSchemeGodunov::logDetails()
 	case model::schemeConfigurations::godunovType::kCacheEnabled:
 			sConfiguration = "Original state caching";
 		break;
+	case model::schemeConfigurations::godunovType::kCacheCoarsened:
+			sConfiguration = "Coarsened, " + toString( this->uiCoarseningFactor ) + " cells per work-item";
+		break;
 	}
 
 	pManager->log->writeLine( "GODUNOV-TYPE 1ST-ORDER-ACCURATE SCHEME", true, wColour );
@@ -376,6 +576,12 @@ void CSchemeGodunov::logDetails()
 	pManager->log->writeLine( "  Riemann solver:     " + sSolver, true, wColour );
 	pManager->log->writeLine( "  Configuration:      " + sConfiguration, true, wColour );
 	pManager->log->writeLine( "  Friction effects:   " + (std::string)( this->bFrictionEffects ? "Enabled" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Scalar transport:   " + (std::string)( this->bScalarTransport ? "Enabled" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Fused sources:      " + (std::string)( this->bFusedSources ? "Enabled" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Drainage capacity:  " + (std::string)( this->bFusedDrainage ? "Enabled" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Hydrological steps: " + (std::string)( this->bHydrologicalSubcycling ? "Sub-cycled every " : "Gated every " ) + Util::secondsToTime( this->dHydrologicalTimestep ), true, wColour );
+	pManager->log->writeLine( "  Dry fast-forward:   " + (std::string)( this->bDryFastForward ? "Below " + toString( this->dDryFastForwardDepth ) + "m depth" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Health monitor:     " + (std::string)( this->bHealthMonitor ? "Courant x" + toString( this->dHealthCourantFactor ) + " for " + Util::secondsToTime( this->dHealthRecoveryWindow ) + " on failure" : "Disabled" ), true, wColour );
 	pManager->log->writeLine( "  Kernel queue mode:  " + (std::string)( this->bAutomaticQueue ? "Automatic" : "Fixed size" ), true, wColour );
 	pManager->log->writeLine( (std::string)( this->bAutomaticQueue ? "  Initial queue:      " : "  Fixed queue:        " ) + toString( this->uiQueueAdditionSize ) + " iteration(s)", true, wColour );
 	pManager->log->writeLine( "  Debug output:       " + (std::string)( this->bDebugOutput ? "Enabled" : "Disabled" ), true, wColour );
@@ -387,6 +593,15 @@ void CSchemeGodunov::logDetails()
  *  Run all preparation steps
  */
 void CSchemeGodunov::prepareAll()
+{
+	if ( this->prepareSetup() && this->prepareProgram() )
+		this->prepareFinish();
+}
+
+/*
+ *  Prepare everything which doesn't need the built program
+ */
+bool CSchemeGodunov::prepareSetup()
 {
 	pManager->log->writeLine( "Starting to prepare program for Godunov-type scheme." );
 
@@ -405,6 +620,9 @@ void CSchemeGodunov::prepareAll()
 	// Forcing single precision?
 	this->oclModel->setForcedSinglePrecision( pManager->getFloatPrecision() == model::floatPrecision::kSingle );
 
+	// Drainage capacities are a sink in the flux kernel
+	this->bFusedDrainage = this->pDomain->hasDrainageCapacity();
+
 	// OpenCL elements
 	if ( !this->prepare1OExecDimensions() )
 	{
@@ -413,7 +631,7 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OConstants() )
@@ -423,7 +641,7 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepareCode() )
@@ -433,7 +651,7 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OMemory() )
@@ -443,9 +661,35 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
+	return true;
+}
+
+/*
+ *  Build the program, which can run alongside loading the domain data
+ */
+bool CSchemeGodunov::prepareProgram()
+{
+	if ( !this->oclModel->buildProgram() )
+	{
+		model::doError(
+			"Failed to build model codebase. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *  Create the kernels and boundaries once the program is built
+ */
+bool CSchemeGodunov::prepareFinish()
+{
 	if ( !this->prepareGeneralKernels() )
 	{
 		model::doError(
@@ -453,7 +697,7 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OKernels() )
@@ -463,7 +707,7 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if (!this->prepareBoundaries())
@@ -473,11 +717,12 @@ void CSchemeGodunov::prepareAll()
 			model::errorCodes::kLevelModelStop
 			);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	this->logDetails();
 	this->bReady = true;
+	return true;
 }
 
 /*
@@ -491,8 +736,8 @@ bool CSchemeGodunov::prepareCode()
 	oclModel->appendCodeFromResource( "CLFriction_H" );
 	oclModel->appendCodeFromResource( "CLSolverHLLC_H" );
 	oclModel->appendCodeFromResource( "CLDynamicTimestep_H" );
-	oclModel->appendCodeFromResource( "CLSchemeGodunov_H" );
 	oclModel->appendCodeFromResource( "CLBoundaries_H" );
+	oclModel->appendCodeFromResource( "CLSchemeGodunov_H" );
 
 	oclModel->appendCodeFromResource( "CLDomainCartesian_C" );
 	oclModel->appendCodeFromResource( "CLFriction_C" );
@@ -501,7 +746,7 @@ bool CSchemeGodunov::prepareCode()
 	oclModel->appendCodeFromResource( "CLSchemeGodunov_C" );
 	oclModel->appendCodeFromResource( "CLBoundaries_C" );
 
-	bReturnState = oclModel->compileProgram();
+	bReturnState = oclModel->createProgram();
 
 	return bReturnState;
 }
@@ -514,6 +759,21 @@ bool CSchemeGodunov::prepareBoundaries()
 	CBoundaryMap*	pBoundaries = this->pDomain->getBoundaries();
 	pBoundaries->prepareBoundaries( oclModel, oclBufferCellBed, oclBufferCellManning, oclBufferTime, oclBufferTimeHydrological, oclBufferTimestep );
 
+	// Fused boundary buffers only exist now, and follow the time arguments
+	unsigned char ucArgument = 9;
+	if ( this->bFusedSources && this->pFusedUniform != NULL )
+	{
+		oclKernelFullTimestep->assignArgument( ucArgument++, this->pFusedUniform->getConfigurationBuffer() );
+		oclKernelFullTimestep->assignArgument( ucArgument++, this->pFusedUniform->getTimeseriesBuffer() );
+	}
+	if ( this->bFusedSources && this->pFusedGridded != NULL )
+	{
+		oclKernelFullTimestep->assignArgument( ucArgument++, this->pFusedGridded->getConfigurationBuffer() );
+		oclKernelFullTimestep->assignArgument( ucArgument++, this->pFusedGridded->getTimeseriesBuffer() );
+	}
+	if ( this->bFusedDrainage )
+		oclKernelFullTimestep->assignArgument( ucArgument++, oclBufferCellDrainage );
+
 	return true;
 }
 
@@ -582,6 +842,156 @@ unsigned char	CSchemeGodunov::getCacheMode()
 	return this->ucConfiguration;
 }
 
+/*
+ *  Set the number of cells each work-item walks in the coarsened kernels
+ */
+void	CSchemeGodunov::setCoarseningFactor( unsigned int uiFactor )
+{
+	this->uiCoarseningFactor = uiFactor;
+}
+
+/*
+ *  Get the number of cells each work-item walks in the coarsened kernels
+ */
+unsigned int	CSchemeGodunov::getCoarseningFactor()
+{
+	return this->uiCoarseningFactor;
+}
+
+/*
+ *  Cells walked by each work-item of the main scheme kernel, for the
+ *  configuration in use
+ */
+unsigned int	CSchemeGodunov::getKernelCoarsening()
+{
+	return ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheCoarsened ? this->uiCoarseningFactor : 1 );
+}
+
+/*
+ *  Enable or disable transport of a passive scalar
+ */
+void	CSchemeGodunov::setScalarTransport( bool bEnabled )
+{
+	this->bScalarTransport = bEnabled;
+}
+
+/*
+ *  Is a passive scalar transported?
+ */
+bool	CSchemeGodunov::getScalarTransport()
+{
+	return this->bScalarTransport;
+}
+
+/*
+ *  Enable or disable applying uniform/gridded sources in the flux kernel
+ */
+void	CSchemeGodunov::setFusedSources( bool bEnabled )
+{
+	this->bFusedSources = bEnabled;
+}
+
+/*
+ *  Are uniform/gridded sources applied in the flux kernel?
+ */
+bool	CSchemeGodunov::getFusedSources()
+{
+	return this->bFusedSources;
+}
+
+/*
+ *  Enable or disable host scheduling of the hydrological kernels
+ */
+void	CSchemeGodunov::setHydrologicalSubcycling( bool bEnabled )
+{
+	this->bHydrologicalSubcycling = bEnabled;
+}
+
+/*
+ *  Are the hydrological kernels only scheduled when they're due?
+ */
+bool	CSchemeGodunov::getHydrologicalSubcycling()
+{
+	return this->bHydrologicalSubcycling;
+}
+
+/*
+ *  Enable or disable skipping dry spells to the next forcing
+ */
+void	CSchemeGodunov::setDryFastForward( bool bEnabled )
+{
+	this->bDryFastForward = bEnabled;
+}
+
+/*
+ *  Are dry spells skipped to the next forcing?
+ */
+bool	CSchemeGodunov::getDryFastForward()
+{
+	return this->bDryFastForward;
+}
+
+/*
+ *  Set the depth below which the domain is considered dry for fast-forwarding
+ */
+void	CSchemeGodunov::setDryFastForwardDepth( double dDepth )
+{
+	this->dDryFastForwardDepth = dDepth;
+}
+
+/*
+ *  Enable or disable the numerical health monitor
+ */
+void	CSchemeGodunov::setHealthMonitor( bool bEnabled )
+{
+	this->bHealthMonitor = bEnabled;
+}
+
+/*
+ *  Is the numerical health monitor enabled?
+ */
+bool	CSchemeGodunov::getHealthMonitor()
+{
+	return this->bHealthMonitor;
+}
+
+/*
+ *  Set the Courant number reduction for each recovery attempt and
+ *  how long beyond the failure it remains in place
+ */
+void	CSchemeGodunov::setHealthRecovery( double dFactor, double dWindow )
+{
+	this->dHealthCourantFactor	= dFactor;
+	this->dHealthRecoveryWindow	= dWindow;
+}
+
+/*
+ *  Set the velocity beyond which a cell is flagged as unhealthy
+ */
+void	CSchemeGodunov::setHealthMaxVelocity( double dVelocity )
+{
+	this->dHealthMaxVelocity = dVelocity;
+}
+
+/*
+ *  Estimate how many iterations remain until the hydrological processes are due,
+ *  from the accumulated hydrological time and the latest timestep
+ */
+void	CSchemeGodunov::resetHydrologicalCountdown( double dAccumulated )
+{
+	if ( this->dCurrentTimestep <= 0.0 || dAccumulated >= this->dHydrologicalTimestep )
+	{
+		this->uiHydrologicalCountdown = 1;
+		return;
+	}
+
+	this->uiHydrologicalCountdown = static_cast<unsigned int>(
+		std::min( 1E6, ceil( ( this->dHydrologicalTimestep - dAccumulated ) / this->dCurrentTimestep ) )
+	);
+	if ( this->uiHydrologicalCountdown < 1 )
+		this->uiHydrologicalCountdown = 1;
+}
+
 /*
  *  Set the cache size
  */
@@ -637,8 +1047,13 @@ bool CSchemeGodunov::prepare1OExecDimensions()
 	if ( this->ulNonCachedWorkgroupSizeY == 0 )
 		ulNonCachedWorkgroupSizeY = ulConstraintWG;
 
-	ulNonCachedGlobalSizeX	= pDomain->getCols();
-	ulNonCachedGlobalSizeY	= pDomain->getRows();
+	// Work-items span the ghost ring too, which the kernels treat as disabled
+	// cells, so the rows are padded to keep the whole work range in each row.
+	// Coarsened work-items each cover a strip of rows, so every strip is whole.
+	pDomain->setPaddedLayout( this->ucGhostCells, ulNonCachedWorkgroupSizeX, ulNonCachedWorkgroupSizeY * this->getKernelCoarsening() );
+
+	ulNonCachedGlobalSizeX	= pDomain->getCols() + 2 * this->ucGhostCells;
+	ulNonCachedGlobalSizeY	= pDomain->getRows() + 2 * this->ucGhostCells;
 
 	if ( this->ulCachedWorkgroupSizeX == 0 )
 		ulCachedWorkgroupSizeX = ulConstraintWG +
@@ -646,9 +1061,9 @@ bool CSchemeGodunov::prepare1OExecDimensions()
 	if ( this->ulCachedWorkgroupSizeY == 0 )
 		ulCachedWorkgroupSizeY = ulConstraintWG;
 
-	ulCachedGlobalSizeX	= static_cast<unsigned long>( ceil( pDomain->getCols() *
+	ulCachedGlobalSizeX	= static_cast<unsigned long>( ceil( ( pDomain->getCols() + 2 * this->ucGhostCells ) *
 						  ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheEnabled ? static_cast<double>( ulCachedWorkgroupSizeX ) / static_cast<double>( ulCachedWorkgroupSizeX - 2 ) : 1.0 ) ) );
-	ulCachedGlobalSizeY	= static_cast<unsigned long>( ceil( pDomain->getRows() *
+	ulCachedGlobalSizeY	= static_cast<unsigned long>( ceil( ( pDomain->getRows() + 2 * this->ucGhostCells ) *
 						  ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheEnabled ? static_cast<double>( ulCachedWorkgroupSizeY ) / static_cast<double>( ulCachedWorkgroupSizeY - 2 ) : 1.0 ) ) );
 
 	// --
@@ -658,7 +1073,7 @@ bool CSchemeGodunov::prepare1OExecDimensions()
 	// TODO: May need to make this configurable?!
 	ulReductionWorkgroupSize = min(static_cast<size_t>(512), pDevice->clDeviceMaxWorkGroupSize);
 	//ulReductionWorkgroupSize = pDevice->clDeviceMaxWorkGroupSize / 2;
-	ulReductionGlobalSize = static_cast<unsigned long>( ceil( ( static_cast<double>(pDomain->getCellCount()) / this->uiTimestepReductionWavefronts ) / ulReductionWorkgroupSize ) * ulReductionWorkgroupSize );
+	ulReductionGlobalSize = static_cast<unsigned long>( ceil( ( static_cast<double>(pDomain->getAllocatedCellCount()) / this->uiTimestepReductionWavefronts ) / ulReductionWorkgroupSize ) * ulReductionWorkgroupSize );
 
 	return bReturnState;
 }
@@ -709,6 +1124,19 @@ bool CSchemeGodunov::prepare1OConstants()
 			"__attribute__((reqd_work_group_size(" + toString( this->ulNonCachedWorkgroupSizeX )  + ", " + toString( this->ulNonCachedWorkgroupSizeY )  + ", 1)))"
 		);
 	}
+	if ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheCoarsened )
+	{
+		oclModel->registerConstant(
+			"REQD_WG_SIZE_FULL_TS",
+			"__attribute__((reqd_work_group_size(" + toString( this->ulNonCachedWorkgroupSizeX )  + ", " + toString( this->ulNonCachedWorkgroupSizeY )  + ", 1)))"
+		);
+	}
+
+	// --
+	// Cells walked by each work-item
+	// --
+
+	oclModel->registerConstant( "COARSENING_FACTOR", toString( this->getKernelCoarsening() ) );
 
 	oclModel->registerConstant(
 		"REQD_WG_SIZE_LINE",
@@ -748,6 +1176,59 @@ bool CSchemeGodunov::prepare1OConstants()
 		oclModel->removeConstant( "TIMESTEP_DYNAMIC" );
 	}
 
+	// Synchronised timesteps can be reduced a batch behind, so several
+	// iterations are queued between each reduction
+	this->dSyncLagSafety = 0.0;
+	if ( this->bDynamicTimestep && pManager->getDomainSet()->getDomainCount() > 1 )
+		this->dSyncLagSafety = pManager->getDomainSet()->getSyncLagSafety();
+
+	if ( this->dSyncLagSafety > 0.0 )
+	{
+		oclModel->registerConstant( "TIMESTEP_LAGGED", "1" );
+	} else {
+		oclModel->removeConstant( "TIMESTEP_LAGGED" );
+	}
+
+	// Dry spells can only be skipped when domains aren't stepping in lockstep,
+	// and the reduction is what tells us the domain is still
+	if ( this->bDryFastForward && ( !this->bDynamicTimestep ||
+		 ( pManager->getDomainSet()->getDomainCount() > 1 && pManager->getDomainSet()->getSyncMethod() == model::syncMethod::kSyncTimestep ) ) )
+	{
+		model::doError(
+			"Dry fast-forward requires a dynamic timestep without timestep synchronisation.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bDryFastForward = false;
+	}
+
+	if ( this->bDryFastForward )
+	{
+		oclModel->registerConstant( "TIMESTEP_FASTFORWARD", "1" );
+		oclModel->registerConstant( "FASTFORWARD_DEPTH", toString( this->dDryFastForwardDepth ) );
+	} else {
+		oclModel->removeConstant( "TIMESTEP_FASTFORWARD" );
+	}
+
+	// Recovery rolls back to the host copy and tightens the CFL condition,
+	// neither of which makes sense when every domain has to step together
+	if ( this->bHealthMonitor && ( !this->bDynamicTimestep ||
+		 ( pManager->getDomainSet()->getDomainCount() > 1 && pManager->getDomainSet()->getSyncMethod() == model::syncMethod::kSyncTimestep ) ) )
+	{
+		model::doError(
+			"The health monitor requires a dynamic timestep without timestep synchronisation.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bHealthMonitor = false;
+	}
+
+	if ( this->bHealthMonitor )
+	{
+		oclModel->registerConstant( "HEALTH_MONITOR", "1" );
+		oclModel->registerConstant( "HEALTH_MAX_VELOCITY", toString( this->dHealthMaxVelocity ) );
+	} else {
+		oclModel->removeConstant( "HEALTH_MONITOR" );
+	}
+
 	if (this->bFrictionEffects)
 	{
 		oclModel->registerConstant("FRICTION_ENABLED", "1");
@@ -761,6 +1242,65 @@ bool CSchemeGodunov::prepare1OConstants()
 		oclModel->registerConstant( "FRICTION_IN_FLUX_KERNEL",	"1" );
 	}
 
+	if ( this->bScalarTransport )
+	{
+		oclModel->registerConstant( "SCALAR_TRANSPORT", "1" );
+	} else {
+		oclModel->removeConstant( "SCALAR_TRANSPORT" );
+	}
+
+	// Rainfall and losses applied in the flux kernel replace a boundary
+	// kernel pass (and barrier) each
+	if ( this->bFusedSources )
+	{
+		this->pFusedUniform = this->pDomain->getBoundaries()->fuseBoundary( model::boundaries::fusableTypes::kFusableUniform );
+		this->pFusedGridded = this->pDomain->getBoundaries()->fuseBoundary( model::boundaries::fusableTypes::kFusableGridded );
+		if ( this->pFusedUniform == NULL && this->pFusedGridded == NULL )
+		{
+			model::doError(
+				"No uniform or gridded boundaries can be applied in the flux kernel.",
+				model::errorCodes::kLevelWarning
+			);
+			this->bFusedSources = false;
+		}
+	}
+
+	oclModel->registerConstant( "TIMESTEP_HYDROLOGICAL", toString( this->dHydrologicalTimestep ) );
+	if ( this->bHydrologicalSubcycling )
+	{
+		oclModel->registerConstant( "HYDROLOGICAL_SUBCYCLING", "1" );
+	} else {
+		oclModel->removeConstant( "HYDROLOGICAL_SUBCYCLING" );
+	}
+
+	if ( this->bFusedSources || this->bFusedDrainage )
+	{
+		oclModel->registerConstant( "FUSED_SOURCES", "1" );
+	} else {
+		oclModel->removeConstant( "FUSED_SOURCES" );
+	}
+
+	if ( this->pFusedUniform != NULL )
+	{
+		oclModel->registerConstant( "FUSED_SOURCE_UNIFORM", "1" );
+	} else {
+		oclModel->removeConstant( "FUSED_SOURCE_UNIFORM" );
+	}
+
+	if ( this->pFusedGridded != NULL )
+	{
+		oclModel->registerConstant( "FUSED_SOURCE_GRIDDED", "1" );
+	} else {
+		oclModel->removeConstant( "FUSED_SOURCE_GRIDDED" );
+	}
+
+	if ( this->bFusedDrainage )
+	{
+		oclModel->registerConstant( "FUSED_SOURCE_DRAINAGE", "1" );
+	} else {
+		oclModel->removeConstant( "FUSED_SOURCE_DRAINAGE" );
+	}
+
 	// --
 	// Timestep reduction and simulation parameters
 	// --
@@ -777,14 +1317,31 @@ bool CSchemeGodunov::prepare1OConstants()
 	double	dResolution;
 	pDomain->getCellResolution( &dResolution );
 
-	oclModel->registerConstant( "DOMAIN_CELLCOUNT",		toString( pDomain->getCellCount() ) );
+	oclModel->registerConstant( "DOMAIN_CELLCOUNT",		toString( pDomain->getAllocatedCellCount() ) );
 	oclModel->registerConstant( "DOMAIN_COLS",			toString( pDomain->getCols() ) );
 	oclModel->registerConstant( "DOMAIN_ROWS",			toString( pDomain->getRows() ) );
+	oclModel->registerConstant( "DOMAIN_ROW_PITCH",		toString( pDomain->getRowPitch() ) );
+	oclModel->registerConstant( "DOMAIN_GHOST_CELLS",	toString( static_cast<unsigned int>( pDomain->getGhostCells() ) ) );
 	oclModel->registerConstant( "DOMAIN_DELTAX",		toString( dResolution ) );
 	oclModel->registerConstant( "DOMAIN_DELTAY",		toString( dResolution ) );
 	oclModel->registerConstant( "DOMAIN_DELTAX_R",		toString( 1.0 / dResolution ) );
 	oclModel->registerConstant( "DOMAIN_DELTAY_R",		toString( 1.0 / dResolution ) );
 
+	// --
+	// Domain edge treatments (applied through the ghost cells)
+	// --
+
+	CBoundaryMap*	pBoundaries	= pDomain->getBoundaries();
+	this->bGhostFill = false;
+	for( unsigned char i = 0; i < 4; i++ )
+		if ( pBoundaries->getEdgeTreatment( i ) != CDomainCartesian::kBoundaryOpen )
+			this->bGhostFill = true;
+
+	oclModel->registerConstant( "DOMAIN_EDGE_N",		toString( static_cast<unsigned int>( pBoundaries->getEdgeTreatment( CDomainCartesian::kEdgeN ) ) ) );
+	oclModel->registerConstant( "DOMAIN_EDGE_E",		toString( static_cast<unsigned int>( pBoundaries->getEdgeTreatment( CDomainCartesian::kEdgeE ) ) ) );
+	oclModel->registerConstant( "DOMAIN_EDGE_S",		toString( static_cast<unsigned int>( pBoundaries->getEdgeTreatment( CDomainCartesian::kEdgeS ) ) ) );
+	oclModel->registerConstant( "DOMAIN_EDGE_W",		toString( static_cast<unsigned int>( pBoundaries->getEdgeTreatment( CDomainCartesian::kEdgeW ) ) ) );
+
 	return true;
 }
 
@@ -802,25 +1359,64 @@ bool CSchemeGodunov::prepare1OMemory()
 	unsigned char ucFloatSize =  ( pManager->getFloatPrecision() == model::floatPrecision::kSingle ? sizeof( cl_float ) : sizeof( cl_double ) );
 
 	// --
-	// Batch tracking data
+	// Control block: time, timestep and batch tracking scalars packed into one buffer, so the
+	// status can be read back with a single transfer per batch. Each scalar is a sub-buffer
+	// view at the device's base alignment, so the kernels still take them as separate arguments.
 	// --
 
-	oclBufferBatchTimesteps	 = new COCLBuffer( "Batch timesteps cumulative", oclModel, false, true, ucFloatSize, true );
-	oclBufferBatchSuccessful = new COCLBuffer( "Batch successful iterations", oclModel, false, true, sizeof(cl_uint), true );
-	oclBufferBatchSkipped	 = new COCLBuffer( "Batch skipped iterations", oclModel, false, true, sizeof(cl_uint), true );
+	cl_ulong ulControlStride = std::max<cl_ulong>( pDomain->getDevice()->clDeviceAlignBits / 8, sizeof( cl_double ) );
+
+	oclBufferControl = new COCLBuffer( "Control block", oclModel, false, true, ulControlStride * 13, false );
+	oclBufferControl->createPinnedHostBlock();
+	oclBufferControl->createBuffer();
+
+	oclBufferTime				= new COCLBuffer( "Time",							oclBufferControl, ulControlStride * 0, ucFloatSize );
+	oclBufferTimestep			= new COCLBuffer( "Timestep",						oclBufferControl, ulControlStride * 1, ucFloatSize );
+	oclBufferTimeHydrological	= new COCLBuffer( "Time (hydrological)",			oclBufferControl, ulControlStride * 2, ucFloatSize );
+	oclBufferBatchTimesteps		= new COCLBuffer( "Batch timesteps cumulative",		oclBufferControl, ulControlStride * 3, ucFloatSize );
+	oclBufferBatchSuccessful	= new COCLBuffer( "Batch successful iterations",	oclBufferControl, ulControlStride * 4, sizeof(cl_uint) );
+	oclBufferBatchSkipped		= new COCLBuffer( "Batch skipped iterations",		oclBufferControl, ulControlStride * 5, sizeof(cl_uint) );
+	oclBufferTimeTarget			= new COCLBuffer( "Target time (sync)",				oclBufferControl, ulControlStride * 6, ucFloatSize );
+	oclBufferTimestepLagged		= new COCLBuffer( "Timestep (lagged)",				oclBufferControl, ulControlStride * 7, ucFloatSize );
+	oclBufferTimestepLimit		= new COCLBuffer( "Timestep limit (lagged)",		oclBufferControl, ulControlStride * 8, ucFloatSize );
+	oclBufferTimeViolated		= new COCLBuffer( "Time violated (lagged)",			oclBufferControl, ulControlStride * 9, ucFloatSize );
+	oclBufferQuiescent			= new COCLBuffer( "Quiescent (dry and still)",		oclBufferControl, ulControlStride * 10, sizeof(cl_uint) );
+	oclBufferHealth				= new COCLBuffer( "Health flags and count",			oclBufferControl, ulControlStride * 11, sizeof(cl_uint) * 2 );
+	oclBufferCourantNumber		= new COCLBuffer( "Courant number",					oclBufferControl, ulControlStride * 12, ucFloatSize );
+
+	oclBufferTime->createBuffer();
+	oclBufferTimestep->createBuffer();
+	oclBufferTimeHydrological->createBuffer();
+	oclBufferBatchTimesteps->createBuffer();
+	oclBufferBatchSuccessful->createBuffer();
+	oclBufferBatchSkipped->createBuffer();
+	oclBufferTimeTarget->createBuffer();
+	oclBufferTimestepLagged->createBuffer();
+	oclBufferTimestepLimit->createBuffer();
+	oclBufferTimeViolated->createBuffer();
+	oclBufferQuiescent->createBuffer();
+	oclBufferHealth->createBuffer();
+	oclBufferCourantNumber->createBuffer();
 
 	if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
 	{
 		*( oclBufferBatchTimesteps->getHostBlock<float*>() )	= 0.0f;
+		*( oclBufferTimestepLagged->getHostBlock<float*>() )	= 0.0f;
+		*( oclBufferTimestepLimit->getHostBlock<float*>() )		= 0.0f;
+		*( oclBufferTimeViolated->getHostBlock<float*>() )		= -1.0f;
+		*( oclBufferCourantNumber->getHostBlock<float*>() )		= static_cast<float>( this->dCourantNumber );
 	} else {
 		*( oclBufferBatchTimesteps->getHostBlock<double*>() )	= 0.0;
+		*( oclBufferTimestepLagged->getHostBlock<double*>() )	= 0.0;
+		*( oclBufferTimestepLimit->getHostBlock<double*>() )	= 0.0;
+		*( oclBufferTimeViolated->getHostBlock<double*>() )		= -1.0;
+		*( oclBufferCourantNumber->getHostBlock<double*>() )	= this->dCourantNumber;
 	}
 	*( oclBufferBatchSuccessful->getHostBlock<cl_uint*>() )		= 0;
 	*( oclBufferBatchSkipped->getHostBlock<cl_uint*>() )		= 0;
-
-	oclBufferBatchTimesteps->createBuffer();
-	oclBufferBatchSuccessful->createBuffer();
-	oclBufferBatchSkipped->createBuffer();
+	*( oclBufferQuiescent->getHostBlock<cl_uint*>() )			= 0;
+	oclBufferHealth->getHostBlock<cl_uint*>()[0]				= 0;
+	oclBufferHealth->getHostBlock<cl_uint*>()[1]				= 0;
 
 	// --
 	// Domain and cell state data
@@ -839,10 +1435,10 @@ bool CSchemeGodunov::prepare1OMemory()
 	oclBufferCellManning	= new COCLBuffer( "Manning coefficients",	oclModel, true,	true );
 	oclBufferCellBed		= new COCLBuffer( "Bed elevations",			oclModel, true, true );
 
-	oclBufferCellStates->setPointer( pCellStates, ucFloatSize * 4 * pDomain->getCellCount() );
-	oclBufferCellStatesAlt->setPointer( pCellStates, ucFloatSize * 4 * pDomain->getCellCount() );
-	oclBufferCellManning->setPointer( pManningValues, ucFloatSize * pDomain->getCellCount() );
-	oclBufferCellBed->setPointer( pBedElevations, ucFloatSize * pDomain->getCellCount() );
+	oclBufferCellStates->setPointer( pCellStates, ucFloatSize * 4 * pDomain->getAllocatedCellCount() );
+	oclBufferCellStatesAlt->setPointer( pCellStates, ucFloatSize * 4 * pDomain->getAllocatedCellCount() );
+	oclBufferCellManning->setPointer( pManningValues, ucFloatSize * pDomain->getAllocatedCellCount() );
+	oclBufferCellBed->setPointer( pBedElevations, ucFloatSize * pDomain->getAllocatedCellCount() );
 
 	oclBufferCellStates->createBuffer();
 	oclBufferCellStatesAlt->createBuffer();
@@ -850,13 +1446,43 @@ bool CSchemeGodunov::prepare1OMemory()
 	oclBufferCellBed->createBuffer();
 
 	// --
-	// Timesteps and current simulation time
+	// Passive scalar (a placeholder is still required for the kernel arguments)
 	// --
 
-	oclBufferTimestep			= new COCLBuffer( "Timestep", oclModel, false, true, ucFloatSize, true );
-	oclBufferTime				= new COCLBuffer( "Time",	  oclModel, false, true, ucFloatSize, true );
-	oclBufferTimeTarget			= new COCLBuffer( "Target time (sync)",	  oclModel, false, true, ucFloatSize, true );
-	oclBufferTimeHydrological	= new COCLBuffer( "Time (hydrological)", oclModel, false, true, ucFloatSize, true );
+	if ( this->bScalarTransport )
+	{
+		void	*pScalars = NULL;
+		pDomain->createScalarStoreBuffer( &pScalars );
+
+		oclBufferCellScalars	= new COCLBuffer( "Cell scalars",				oclModel, false, true );
+		oclBufferCellScalarsAlt	= new COCLBuffer( "Cell scalars (alternate)",	oclModel, false, true );
+		oclBufferCellScalars->setPointer( pScalars, ucFloatSize * pDomain->getAllocatedCellCount() );
+		oclBufferCellScalarsAlt->setPointer( pScalars, ucFloatSize * pDomain->getAllocatedCellCount() );
+	} else {
+		oclBufferCellScalars	= new COCLBuffer( "Cell scalars (unused)",		oclModel, false, true, ucFloatSize, true );
+		oclBufferCellScalarsAlt	= new COCLBuffer( "Cell scalars (unused)",		oclModel, false, true, ucFloatSize, true );
+	}
+
+	oclBufferCellScalars->createBuffer();
+	oclBufferCellScalarsAlt->createBuffer();
+
+	// --
+	// Drainage capacities (only when a dataSource provides them)
+	// --
+
+	if ( this->bFusedDrainage )
+	{
+		void	*pDrainage = NULL;
+		pDomain->createDrainageStoreBuffer( &pDrainage );
+
+		oclBufferCellDrainage	= new COCLBuffer( "Drainage capacities",		oclModel, true, true );
+		oclBufferCellDrainage->setPointer( pDrainage, ucFloatSize * pDomain->getAllocatedCellCount() );
+		oclBufferCellDrainage->createBuffer();
+	}
+
+	// --
+	// Timesteps and current simulation time
+	// --
 
 	// We duplicate the time and timestep variables if we're using single-precision so we have copies in both formats
 	if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
@@ -872,10 +1498,21 @@ bool CSchemeGodunov::prepare1OMemory()
 		*( oclBufferTimeTarget->getHostBlock<double*>() )		= 0.0;
 	}
 
-	oclBufferTimestep->createBuffer();
-	oclBufferTime->createBuffer();
-	oclBufferTimeHydrological->createBuffer();
-	oclBufferTimeTarget->createBuffer();
+	oclBufferControl->queueWriteAll();
+
+	// Fused sources read this instead on steps without a hydrological update
+	if ( this->bHydrologicalSubcycling && ( this->bFusedSources || this->bFusedDrainage ) )
+	{
+		oclBufferTimeHydrologicalIdle = new COCLBuffer( "Time (hydrological, idle)", oclModel, true, true, ucFloatSize, true );
+		if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
+		{
+			*( oclBufferTimeHydrologicalIdle->getHostBlock<float*>() )	= 0.0f;
+		} else {
+			*( oclBufferTimeHydrologicalIdle->getHostBlock<double*>() ) = 0.0;
+		}
+		oclBufferTimeHydrologicalIdle->createBuffer();
+		oclBufferTimeHydrologicalIdle->queueWriteAll();
+	}
 
 	// --
 	// Timestep reduction global array
@@ -922,9 +1559,9 @@ bool CSchemeGodunov::prepareGeneralKernels()
 	oclKernelTimestepReduction->setGroupSize( this->ulReductionWorkgroupSize );
 	oclKernelTimestepReduction->setGlobalSize( this->ulReductionGlobalSize );
 
-	COCLBuffer* aryArgsTimeAdvance[]		= { oclBufferTime, oclBufferTimestep, oclBufferTimeHydrological, oclBufferTimestepReduction, oclBufferCellStates, oclBufferCellBed, oclBufferTimeTarget, oclBufferBatchTimesteps, oclBufferBatchSuccessful, oclBufferBatchSkipped };
-	COCLBuffer* aryArgsTimestepUpdate[]		= { oclBufferTime, oclBufferTimestep, oclBufferTimestepReduction, oclBufferTimeTarget, oclBufferBatchTimesteps };
-	COCLBuffer* aryArgsTimeReduction[]		= { oclBufferCellStates, oclBufferCellBed, oclBufferTimestepReduction };
+	COCLBuffer* aryArgsTimeAdvance[]		= { oclBufferTime, oclBufferTimestep, oclBufferTimeHydrological, oclBufferTimestepReduction, oclBufferCellStates, oclBufferCellBed, oclBufferTimeTarget, oclBufferBatchTimesteps, oclBufferBatchSuccessful, oclBufferBatchSkipped, oclBufferTimestepLagged, oclBufferTimestepLimit, oclBufferTimeViolated, oclBufferQuiescent, oclBufferCourantNumber };
+	COCLBuffer* aryArgsTimestepUpdate[]		= { oclBufferTime, oclBufferTimestep, oclBufferTimestepReduction, oclBufferTimeTarget, oclBufferBatchTimesteps, oclBufferCourantNumber };
+	COCLBuffer* aryArgsTimeReduction[]		= { oclBufferCellStates, oclBufferCellBed, oclBufferTimestepReduction, oclBufferHealth };
 	COCLBuffer* aryArgsResetCounters[]      = { oclBufferBatchTimesteps, oclBufferBatchSuccessful, oclBufferBatchSkipped };
 
 	oclKernelTimeAdvance->assignArguments( aryArgsTimeAdvance );
@@ -932,6 +1569,15 @@ bool CSchemeGodunov::prepareGeneralKernels()
 	oclKernelTimestepReduction->assignArguments( aryArgsTimeReduction );
 	oclKernelTimestepUpdate->assignArguments( aryArgsTimestepUpdate );
 
+	if ( this->bHydrologicalSubcycling )
+	{
+		oclKernelResetHydrological = oclModel->getKernel( "tst_ResetHydrological" );
+		oclKernelResetHydrological->setGroupSize(1, 1, 1);
+		oclKernelResetHydrological->setGlobalSize(1, 1, 1);
+		COCLBuffer* aryArgsResetHydrological[] = { oclBufferTimeHydrological };
+		oclKernelResetHydrological->assignArguments( aryArgsResetHydrological );
+	}
+
 	// --
 	// Boundaries and friction etc.
 	// --
@@ -943,6 +1589,20 @@ bool CSchemeGodunov::prepareGeneralKernels()
 	COCLBuffer* aryArgsFriction[] = { oclBufferTimestep, oclBufferCellStates, oclBufferCellBed, oclBufferCellManning };
 	oclKernelFriction->assignArguments( aryArgsFriction );
 
+	// --
+	// Domain edges (one work-item per line of ghost cells)
+	// --
+
+	if ( this->bGhostFill )
+	{
+		CDomainCartesian* pDomainCart = static_cast<CDomainCartesian*>( pDomain );
+		oclKernelGhostFill = oclModel->getKernel( "dom_GhostFill" );
+		oclKernelGhostFill->setGroupSize( this->ulNonCachedWorkgroupSizeX * this->ulNonCachedWorkgroupSizeY );
+		oclKernelGhostFill->setGlobalSize( 2 * ( pDomainCart->getCols() + pDomainCart->getRows() ) );
+		COCLBuffer* aryArgsGhostFill[] = { oclBufferCellStates, oclBufferCellScalars };
+		oclKernelGhostFill->assignArguments( aryArgsGhostFill );
+	}
+
 	return bReturnState;
 }
 
@@ -965,14 +1625,21 @@ bool CSchemeGodunov::prepare1OKernels()
 		oclKernelFullTimestep = oclModel->getKernel( "gts_cacheDisabled" );
 		oclKernelFullTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
 		oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, this->ulNonCachedGlobalSizeY );
-		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning };
+		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning, oclBufferCellScalars, oclBufferCellScalarsAlt, oclBufferTime, oclBufferTimeHydrological, NULL, NULL, NULL, NULL, NULL };
 		oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
 	} else if ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheEnabled )
 	{
 		oclKernelFullTimestep = oclModel->getKernel( "gts_cacheEnabled" );
 		oclKernelFullTimestep->setGroupSize( this->ulCachedWorkgroupSizeX, this->ulCachedWorkgroupSizeY );
 		oclKernelFullTimestep->setGlobalSize( this->ulCachedGlobalSizeX, this->ulCachedGlobalSizeY );
-		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning };
+		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning, oclBufferCellScalars, oclBufferCellScalarsAlt, oclBufferTime, oclBufferTimeHydrological, NULL, NULL, NULL, NULL, NULL };
+		oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
+	} else if ( this->ucConfiguration == model::schemeConfigurations::godunovType::kCacheCoarsened )
+	{
+		oclKernelFullTimestep = oclModel->getKernel( "gts_cacheCoarsened" );
+		oclKernelFullTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
+		oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, ( this->ulNonCachedGlobalSizeY + this->uiCoarseningFactor - 1 ) / this->uiCoarseningFactor );
+		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning, oclBufferCellScalars, oclBufferCellScalarsAlt, oclBufferTime, oclBufferTimeHydrological, NULL, NULL, NULL, NULL, NULL };
 		oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
 	}
 
@@ -1007,15 +1674,32 @@ void CSchemeGodunov::release1OResources()
 	if ( this->oclKernelTimeAdvance != NULL )				delete oclKernelTimeAdvance;
 	if ( this->oclKernelTimestepUpdate != NULL )			delete oclKernelTimestepUpdate;
 	if ( this->oclKernelResetCounters != NULL )				delete oclKernelResetCounters;
+	if ( this->oclKernelResetHydrological != NULL )			delete oclKernelResetHydrological;
+	if ( this->oclKernelGhostFill != NULL )					delete oclKernelGhostFill;
 	if ( this->oclBufferCellStates != NULL )				delete oclBufferCellStates;
 	if ( this->oclBufferCellStatesAlt != NULL )				delete oclBufferCellStatesAlt;
+	if ( this->oclBufferCellStatesSaved != NULL )			delete oclBufferCellStatesSaved;
+	if ( this->oclBufferCellScalars != NULL )				delete oclBufferCellScalars;
+	if ( this->oclBufferCellScalarsAlt != NULL )			delete oclBufferCellScalarsAlt;
 	if ( this->oclBufferCellManning != NULL )				delete oclBufferCellManning;
 	if ( this->oclBufferCellBed != NULL )					delete oclBufferCellBed;
+	if ( this->oclBufferCellDrainage != NULL )				delete oclBufferCellDrainage;
 	if ( this->oclBufferTimestep != NULL )					delete oclBufferTimestep;
 	if ( this->oclBufferTimestepReduction != NULL )			delete oclBufferTimestepReduction;
 	if ( this->oclBufferTime != NULL )						delete oclBufferTime;
 	if ( this->oclBufferTimeTarget != NULL )				delete oclBufferTimeTarget;
 	if ( this->oclBufferTimeHydrological != NULL )			delete oclBufferTimeHydrological;
+	if ( this->oclBufferTimeHydrologicalIdle != NULL )		delete oclBufferTimeHydrologicalIdle;
+	if ( this->oclBufferBatchTimesteps != NULL )			delete oclBufferBatchTimesteps;
+	if ( this->oclBufferBatchSuccessful != NULL )			delete oclBufferBatchSuccessful;
+	if ( this->oclBufferBatchSkipped != NULL )				delete oclBufferBatchSkipped;
+	if ( this->oclBufferTimestepLagged != NULL )			delete oclBufferTimestepLagged;
+	if ( this->oclBufferTimestepLimit != NULL )				delete oclBufferTimestepLimit;
+	if ( this->oclBufferTimeViolated != NULL )				delete oclBufferTimeViolated;
+	if ( this->oclBufferQuiescent != NULL )					delete oclBufferQuiescent;
+	if ( this->oclBufferHealth != NULL )					delete oclBufferHealth;
+	if ( this->oclBufferCourantNumber != NULL )				delete oclBufferCourantNumber;
+	if ( this->oclBufferControl != NULL )					delete oclBufferControl;
 
 	oclModel						= NULL;
 	oclKernelFullTimestep			= NULL;
@@ -1023,32 +1707,189 @@ void CSchemeGodunov::release1OResources()
 	oclKernelTimestepReduction		= NULL;
 	oclKernelTimeAdvance			= NULL;
 	oclKernelResetCounters			= NULL;
+	oclKernelResetHydrological		= NULL;
 	oclKernelTimestepUpdate			= NULL;
+	oclKernelGhostFill				= NULL;
 	oclBufferCellStates				= NULL;
 	oclBufferCellStatesAlt			= NULL;
+	oclBufferCellStatesSaved		= NULL;
+	oclBufferCellScalars			= NULL;
+	oclBufferCellScalarsAlt			= NULL;
 	oclBufferCellManning			= NULL;
 	oclBufferCellBed				= NULL;
+	oclBufferCellDrainage			= NULL;
 	oclBufferTimestep				= NULL;
 	oclBufferTimestepReduction		= NULL;
 	oclBufferTime					= NULL;
 	oclBufferTimeTarget				= NULL;
 	oclBufferTimeHydrological		= NULL;
+	oclBufferTimeHydrologicalIdle	= NULL;
+	oclBufferBatchTimesteps			= NULL;
+	oclBufferBatchSuccessful		= NULL;
+	oclBufferBatchSkipped			= NULL;
+	oclBufferTimestepLagged			= NULL;
+	oclBufferTimestepLimit			= NULL;
+	oclBufferTimeViolated			= NULL;
+	oclBufferQuiescent				= NULL;
+	oclBufferHealth					= NULL;
+	oclBufferCourantNumber			= NULL;
+	oclBufferControl				= NULL;
+
+	if ( this->bIncludeBoundaries )
+	{
+		delete [] this->dBoundaryTimeSeries;
+		delete [] this->fBoundaryTimeSeries;
+		delete [] this->uiBoundaryParameters;
+		if ( this->ulBoundaryRelationCells != NULL )
+			delete [] this->ulBoundaryRelationCells;
+		if ( this->uiBoundaryRelationSeries != NULL )
+			delete [] this->uiBoundaryRelationSeries;
+	}
+	this->dBoundaryTimeSeries		= NULL;
+	this->fBoundaryTimeSeries		= NULL;
+	this->ulBoundaryRelationCells	= NULL;
+	this->uiBoundaryRelationSeries	= NULL;
+	this->uiBoundaryParameters		= NULL;
+
+	this->releasePreviewResources();
+}
+
+/*
+ *  Release the OpenCL resources used for the preview pyramid
+ */
+void CSchemeGodunov::releasePreviewResources()
+{
+	for ( unsigned int i = 0; i < this->oclKernelPreview.size(); ++i )
+		delete this->oclKernelPreview[i];
+	for ( unsigned int i = 0; i < this->oclBufferPreviewConfiguration.size(); ++i )
+		delete this->oclBufferPreviewConfiguration[i];
+	if ( this->oclBufferPreview != NULL )					delete oclBufferPreview;
+
+	this->oclKernelPreview.clear();
+	this->oclBufferPreviewConfiguration.clear();
+	this->vPreviewLevels.clear();
+	oclBufferPreview				= NULL;
+	this->bPreviewRequested			= false;
+	this->bPreviewReady				= false;
+}
+
+/*
+ *  Create the kernels and buffers for a pyramid of preview levels. The base level
+ *  takes the maximum depth over blocks of cells, each further level halves the last.
+ */
+void CSchemeGodunov::preparePreview( unsigned long ulCols, unsigned long ulRows, unsigned int uiStride, unsigned int uiLevels )
+{
+	this->releasePreviewResources();
+
+	if ( !this->bReady || uiLevels < 1 || uiStride < 1 )
+		return;
+
+	// Dimension each of the levels
+	cl_uint	uiSourceCols	= static_cast<cl_uint>( ulCols );
+	cl_uint	uiSourceRows	= static_cast<cl_uint>( ulRows );
+	cl_uint	uiSourceOffset	= 0;
+	cl_uint	uiTargetOffset	= 0;
+
+	for ( unsigned int i = 0; i < uiLevels; ++i )
+	{
+		sPreviewConfiguration pLevel;
+
+		pLevel.uiStride			= ( i == 0 ? uiStride : 2 );
+		pLevel.uiSourceCols		= uiSourceCols;
+		pLevel.uiSourceRows		= uiSourceRows;
+		pLevel.uiSourceOffset	= uiSourceOffset;
+		pLevel.uiTargetCols		= ( uiSourceCols + pLevel.uiStride - 1 ) / pLevel.uiStride;
+		pLevel.uiTargetRows		= ( uiSourceRows + pLevel.uiStride - 1 ) / pLevel.uiStride;
+		pLevel.uiTargetOffset	= uiTargetOffset;
+
+		// Nothing more to gain once we're down to a single pixel
+		if ( i > 0 && uiSourceCols <= 1 && uiSourceRows <= 1 )
+			break;
+
+		this->vPreviewLevels.push_back( pLevel );
+
+		uiSourceCols	= pLevel.uiTargetCols;
+		uiSourceRows	= pLevel.uiTargetRows;
+		uiSourceOffset	= pLevel.uiTargetOffset;
+		uiTargetOffset += pLevel.uiTargetCols * pLevel.uiTargetRows;
+	}
+
+	// Single buffer holds all of the levels
+	oclBufferPreview = new COCLBuffer( "Preview pyramid", oclModel, false, true, uiTargetOffset * sizeof( cl_float ), true );
+	oclBufferPreview->createBuffer();
+
+	for ( unsigned int i = 0; i < this->vPreviewLevels.size(); ++i )
+	{
+		COCLBuffer* pBufferConfiguration = new COCLBuffer( "Preview level " + toString( i ) + " conf", oclModel, true, true, sizeof( sPreviewConfiguration ), true );
+		std::memcpy(
+			pBufferConfiguration->getHostBlock<void*>(),
+			&this->vPreviewLevels[i],
+			sizeof( sPreviewConfiguration )
+		);
+		pBufferConfiguration->createBuffer();
+
+		COCLKernel* pKernel = oclModel->getKernel( i == 0 ? "dom_PreviewDepth" : "dom_PreviewReduce" );
+		pKernel->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
+		pKernel->setGlobalSize( this->vPreviewLevels[i].uiTargetCols, this->vPreviewLevels[i].uiTargetRows );
+
+		if ( i == 0 )
+		{
+			COCLBuffer* aryArgsPreview[] = { pBufferConfiguration, oclBufferCellStates, oclBufferCellBed, oclBufferPreview };
+			pKernel->assignArguments( aryArgsPreview );
+		} else {
+			COCLBuffer* aryArgsPreview[] = { pBufferConfiguration, oclBufferPreview };
+			pKernel->assignArguments( aryArgsPreview );
+		}
+
+		this->oclBufferPreviewConfiguration.push_back( pBufferConfiguration );
+		this->oclKernelPreview.push_back( pKernel );
+	}
+
+	pManager->log->writeLine(
+		"Preview pyramid prepared with " + toString( this->vPreviewLevels.size() ) + " level(s), base level is " +
+		toString( this->vPreviewLevels[0].uiTargetCols ) + "x" + toString( this->vPreviewLevels[0].uiTargetRows ) + "."
+	);
+}
+
+/*
+ *  Ask for a preview to be produced at the end of the next batch
+ */
+void CSchemeGodunov::requestPreview()
+{
+	if ( this->oclBufferPreview == NULL || this->bPreviewReady )
+		return;
+
+	this->bPreviewRequested = true;
+}
 
-	if ( this->bIncludeBoundaries )
-	{
-		delete [] this->dBoundaryTimeSeries;
-		delete [] this->fBoundaryTimeSeries;
-		delete [] this->uiBoundaryParameters;
-		if ( this->ulBoundaryRelationCells != NULL )
-			delete [] this->ulBoundaryRelationCells;
-		if ( this->uiBoundaryRelationSeries != NULL )
-			delete [] this->uiBoundaryRelationSeries;
-	}
-	this->dBoundaryTimeSeries		= NULL;
-	this->fBoundaryTimeSeries		= NULL;
-	this->ulBoundaryRelationCells	= NULL;
-	this->uiBoundaryRelationSeries	= NULL;
-	this->uiBoundaryParameters		= NULL;
+/*
+ *  Has the last preview requested been read back to the host?
+ */
+bool CSchemeGodunov::isPreviewReady()
+{
+	return this->bPreviewReady;
+}
+
+/*
+ *  Fetch the host data and dimensions for one level of the preview pyramid
+ */
+cl_float* CSchemeGodunov::getPreviewLevel( unsigned int uiLevel, unsigned int* uiCols, unsigned int* uiRows )
+{
+	if ( !this->bPreviewReady || uiLevel >= this->vPreviewLevels.size() )
+		return NULL;
+
+	*uiCols = this->vPreviewLevels[ uiLevel ].uiTargetCols;
+	*uiRows = this->vPreviewLevels[ uiLevel ].uiTargetRows;
+
+	return oclBufferPreview->getHostBlock<cl_float*>() + this->vPreviewLevels[ uiLevel ].uiTargetOffset;
+}
+
+/*
+ *  Host is finished with the preview data, so it may be overwritten
+ */
+void CSchemeGodunov::releasePreview()
+{
+	this->bPreviewReady = false;
 }
 
 /*
@@ -1067,12 +1908,30 @@ void	CSchemeGodunov::prepareSimulation()
 	pManager->log->writeLine( "Copying domain data to device..." );
 	oclBufferCellStates->queueWriteAll();
 	oclBufferCellStatesAlt->queueWriteAll();
+	if ( this->bScalarTransport )
+	{
+		oclBufferCellScalars->queueWriteAll();
+		oclBufferCellScalarsAlt->queueWriteAll();
+	}
 	oclBufferCellBed->queueWriteAll();
 	oclBufferCellManning->queueWriteAll();
+	if ( this->bFusedDrainage )
+		oclBufferCellDrainage->queueWriteAll();
 	oclBufferTime->queueWriteAll();
 	oclBufferTimestep->queueWriteAll();
 	oclBufferTimeHydrological->queueWriteAll();
 	this->pDomain->getDevice()->blockUntilFinished();
+	this->resetHydrologicalCountdown( 0.0 );
+	this->dSnapshotTime = this->dCurrentTime;
+
+	// Nested links resample their zones with our program on either side
+	for (unsigned int i = 0; i < pDomain->getLinkCount(); i++)
+		pDomain->getLink(i)->prepareTarget( oclModel, oclBufferCellBed );
+	for (unsigned int i = 0; i < pDomain->getDependentLinkCount(); i++)
+		pDomain->getDependentLink(i)->prepareSource( oclModel, oclBufferCellBed );
+
+	if ( !this->pDomain->getHostMirrors() && !this->pDomain->isHostMirrorReleased() )
+		this->releaseHostMirrors();
 
 	// Sort out memory alternation
 	bUseAlternateKernel		= false;
@@ -1170,8 +2029,11 @@ void CSchemeGodunov::Threaded_runBatch()
 				// #endif
 				if ( this->pDomain->getDevice()->isBusy() ) {
 					this->pDomain->getDevice()->blockUntilFinished();
+					continue;
 				}
 
+				// Sleep until further work is scheduled or we're told to terminate
+				cvRunning.wait(lock, [this] { return this->bRunning || !this->bThreadRunning; });
 				continue;
 			}
 		}
@@ -1192,6 +2054,7 @@ void CSchemeGodunov::Threaded_runBatch()
 
 			this->bCellStatesSynced = false;
 			this->uiIterationsSinceSync = 0;
+			this->uiLaggedIterationsSinceSync = 0;
 
 			bUseForcedTimeAdvance = true;
 
@@ -1226,10 +2089,14 @@ void CSchemeGodunov::Threaded_runBatch()
 		}
 
 		// Have we been asked to override the timestep at the start of this batch?
+		// A lagged batch always starts from the reduced timestep, even if unchanged.
 		if ( //uiIterationsSinceSync < this->pDomain->getRollbackLimit() &&
 			 this->dCurrentTime < dTargetTime &&
-			 this->bOverrideTimestep )
+			 ( this->bOverrideTimestep || ( this->dSyncLagSafety > 0.0 && this->dCurrentTimestep > 0.0 ) ) )
 		{
+			if ( this->dSyncLagSafety > 0.0 && this->dCurrentTime + this->dCurrentTimestep > dTargetTime )
+				this->dCurrentTimestep = dTargetTime - this->dCurrentTime;
+
 			if (pManager->getFloatPrecision() == model::floatPrecision::kSingle)
 			{
 				*(oclBufferTimestep->getHostBlock<float*>()) = static_cast<cl_float>(this->dCurrentTimestep);
@@ -1240,6 +2107,10 @@ void CSchemeGodunov::Threaded_runBatch()
 
 			oclBufferTimestep->queueWriteAll();
 
+			// Every iteration in the batch is held at this timestep
+			if ( this->dSyncLagSafety > 0.0 )
+				this->writeControlScalar( oclBufferTimestepLagged, this->dCurrentTimestep );
+
 			// TODO: Remove me?
 			pDomain->getDevice()->queueBarrier();
 			//pDomain->getDevice()->blockUntilFinished();
@@ -1259,6 +2130,7 @@ void CSchemeGodunov::Threaded_runBatch()
 			// Last sync time
 			this->dLastSyncTime = this->dCurrentTime;
 			this->uiIterationsSinceSync = 0;
+			this->uiLaggedIterationsSinceSync = 0;
 
 			// Update the data
 			oclKernelResetCounters->scheduleExecution();
@@ -1286,10 +2158,17 @@ void CSchemeGodunov::Threaded_runBatch()
 		// }
 
 		// Can only schedule one iteration before we need to sync timesteps
-		// if timestep sync method is active.
+		// if timestep sync method is active, unless the reduction is lagged
+		// in which case the batch runs up to the next link exchange.
 		unsigned int uiQueueAmount = this->uiQueueAdditionSize;
 		if (pManager->getDomainSet()->getSyncMethod() == model::syncMethod::kSyncTimestep)
+		{
 			uiQueueAmount = 1;
+			if ( this->dSyncLagSafety > 0.0 )
+				uiQueueAmount = this->uiLaggedIterationsSinceSync < this->getLaggedIterationLimit() ?
+					min( this->uiQueueAdditionSize, this->getLaggedIterationLimit() - this->uiLaggedIterationsSinceSync ) : 0;
+		}
+		bool bBatchScheduled = false;
 
 #ifdef DEBUG_MPI
 		if ( uiQueueAmount > 0 )
@@ -1301,6 +2180,13 @@ void CSchemeGodunov::Threaded_runBatch()
 		if ( uiIterationsSinceSync < this->pDomain->getRollbackLimit() &&
 			 this->dCurrentTime /*+ 0.0000001*/ < dTargetTime )
 		{
+			// The lowest local limit is gathered afresh for each lagged batch
+			if ( this->dSyncLagSafety > 0.0 && uiQueueAmount > 0 )
+			{
+				this->writeControlScalar( oclBufferTimestepLimit, 0.0 );
+				pDomain->getDevice()->queueBarrier();
+			}
+
 			for (unsigned int i = 0; i < uiQueueAmount; i++)
 			{
 #ifdef DEBUG_MPI
@@ -1312,6 +2198,7 @@ void CSchemeGodunov::Threaded_runBatch()
 					pDomain
 				);
 				uiIterationsSinceSync++;
+				uiLaggedIterationsSinceSync++;
 				uiIterationsSinceProgressCheck++;
 				ulCurrentCellsCalculated += this->pDomain->getCellCount();
 				bUseAlternateKernel = !bUseAlternateKernel;
@@ -1319,6 +2206,7 @@ void CSchemeGodunov::Threaded_runBatch()
 
 			// A further download will be required...
 			this->bCellStatesSynced = false;
+			bBatchScheduled = uiQueueAmount > 0;
 		}
 
 
@@ -1328,20 +2216,42 @@ void CSchemeGodunov::Threaded_runBatch()
 
 		// Schedule reading data back. We always need the timestep
 		// but we might not need the other details always...
-		oclBufferTimestep->queueReadAll();
-		oclBufferTime->queueReadAll();
-		oclBufferBatchSkipped->queueReadAll();
-		oclBufferBatchSuccessful->queueReadAll();
-		oclBufferBatchTimesteps->queueReadAll();
+		oclBufferControl->queueReadAll();
 		uiIterationsSinceProgressCheck = 0;
 
+		// Cells held back in a lagged batch must catch up before anything
+		// else reads them
+		if ( this->dSyncLagSafety > 0.0 && bBatchScheduled )
+		{
+			this->pDomain->getDevice()->blockUntilFinished();
+			this->readKeyStatistics();
+			if ( this->dTimeViolated >= 0.0 )
+				this->redoLaggedBatch();
+		}
+
 #ifdef DEBUG_MPI
 		pManager->log->writeLine( "[DEBUG] [" + std::to_string(this->pDomain->getID()) + "] timestep after sync: " + std::to_string(this->dCurrentTimestep) );
 #endif
 #ifdef _WINDLL
-		oclBufferCellStates->queueReadAll();
+		if ( this->oclBufferCellStatesSaved == NULL )
+			oclBufferCellStates->queueReadAll();
 #endif
 
+		// Produce the preview pyramid from the latest cell states if requested,
+		// only the reduced levels are read back
+		bool bPreviewScheduled = false;
+		if ( this->bPreviewRequested && !this->bPreviewReady )
+		{
+			this->oclKernelPreview[0]->assignArgument( 1, this->getNextCellSourceBuffer() );
+			for ( unsigned int i = 0; i < this->oclKernelPreview.size(); ++i )
+			{
+				this->oclKernelPreview[i]->scheduleExecution();
+				pDomain->getDevice()->queueBarrier();
+			}
+			oclBufferPreview->queueReadAll();
+			bPreviewScheduled = true;
+		}
+
 		// Download data for each of the dependent domains
 		if (bDownloadLinks)
 		{
@@ -1377,9 +2287,23 @@ void CSchemeGodunov::Threaded_runBatch()
 			bCellStatesSynced = true;
 		}
 
+		if ( bPreviewScheduled )
+		{
+			this->bPreviewRequested = false;
+			this->bPreviewReady = true;
+		}
+
 		// Read from buffers back to scheme memory space
 		this->readKeyStatistics();
 		this->dCurrentTimestep = std::max(this->dCurrentTimestep,decltype(this->dCurrentTimestep){0}); // DEBUG-NINNGHAZAD
+
+		// Anything unphysical means going back to the host copy more carefully
+		if ( this->bHealthMonitor )
+			this->checkHealth();
+
+		// Nothing will happen until the next forcing, so skip straight to it
+		if ( this->bDryFastForward && this->uiQuiescent && this->dCurrentTime < this->dTargetTime )
+			this->fastForwardDry();
 		#ifdef DEBUG_MPI
 				pManager->log->writeLine( "[DEBUG] [" + std::to_string(this->pDomain->getID()) + "] timestep after readKeyStatistics: " + std::to_string(this->dCurrentTimestep) );
 		#endif
@@ -1404,6 +2328,7 @@ void CSchemeGodunov::Threaded_runBatch()
 
 		// Wait until further work is scheduled
 		setRunning(false);
+		pManager->notifyScheduler();
 		//
 		// if(this->dCurrentTimestep <= 0) {
 		// 	if ( this->pDomain->getDevice()->isBusy() )
@@ -1479,9 +2404,14 @@ void	CSchemeGodunov::runSimulation( double dTargetTime, double dRealTime )
 		 dTargetTime - this->dCurrentTime <= 1E-5 )
 		 bDownloadLinks = true;
 	if ( pManager->getDomainSet()->getSyncMethod() == model::syncMethod::kSyncTimestep &&
+		 this->dSyncLagSafety <= 0.0 &&
 		 ( this->uiIterationsSinceSync >= pDomain->getRollbackLimit() ||
 		   dTargetTime - this->dCurrentTime <= 1E-5 ) )
 		 bDownloadLinks = true;
+	if ( this->dSyncLagSafety > 0.0 &&
+		 ( this->uiLaggedIterationsSinceSync >= this->getLaggedIterationLimit() ||
+		   dTargetTime - this->dCurrentTime <= 1E-5 ) )
+		 bDownloadLinks = true;
 
 	// Calculate a new batch size
 	if (  this->bAutomaticQueue		&&
@@ -1529,7 +2459,11 @@ void	CSchemeGodunov::cleanupSimulation()
 
 	// Kill the worker thread
 	setRunning(false);
-	bThreadRunning = false;
+	{
+		std::unique_lock<std::shared_mutex> lock(mRunning);
+		bThreadRunning = false;
+	}
+	cvRunning.notify_all();
 
 	// Wait for the thread to terminate before returning
 	while (!bThreadTerminated && bThreadRunning) {}
@@ -1544,9 +2478,20 @@ void	CSchemeGodunov::rollbackSimulation( double dCurrentTime, double dTargetTime
 	this->getDomain()->getDevice()->blockUntilFinished();
 
 	uiIterationsSinceSync = 0;
+	uiLaggedIterationsSinceSync = 0;
 
 	this->dCurrentTime = dCurrentTime;
 	this->dTargetTime = dTargetTime;
+	this->dSnapshotTime = dCurrentTime;
+
+	// Abandon any lagged batch that was still being redone
+	if ( this->dSyncLagSafety > 0.0 )
+	{
+		this->dTimeViolated = -1.0;
+		this->bLaggedRedoIncomplete = false;
+		this->writeControlScalar( oclBufferTimeViolated, -1.0 );
+		this->writeControlScalar( oclBufferTimestepLagged, 0.0 );
+	}
 
 	// Update the time
 	if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
@@ -1561,8 +2506,19 @@ void	CSchemeGodunov::rollbackSimulation( double dCurrentTime, double dTargetTime
 	// Write all memory buffers...
 	oclBufferTime->queueWriteAll();
 	oclBufferTimeTarget->queueWriteAll();
-	oclBufferCellStatesAlt->queueWriteAll();
-	oclBufferCellStates->queueWriteAll();
+	if ( this->oclBufferCellStatesSaved != NULL )
+	{
+		oclBufferCellStatesAlt->queueCopyFrom( oclBufferCellStatesSaved );
+		oclBufferCellStates->queueCopyFrom( oclBufferCellStatesSaved );
+	} else {
+		oclBufferCellStatesAlt->queueWriteAll();
+		oclBufferCellStates->queueWriteAll();
+	}
+	if ( this->bScalarTransport )
+	{
+		oclBufferCellScalarsAlt->queueWriteAll();
+		oclBufferCellScalars->queueWriteAll();
+	}
 
 	// Schedule timestep calculation again
 	// Timestep reduction
@@ -1584,6 +2540,30 @@ void	CSchemeGodunov::rollbackSimulation( double dCurrentTime, double dTargetTime
 	pDomain->getDevice()->flush();
 }
 
+/*
+ *  Restart the simulation from the host copy of the domain at an earlier time,
+ *  including any changes made there to the bed elevations or Manning values
+ */
+void	CSchemeGodunov::branchSimulation( double dTime )
+{
+	if ( this->pDomain->isHostMirrorReleased() )
+	{
+		this->pDomain->flushStaging();
+	} else {
+		oclBufferCellBed->queueWriteAll();
+		oclBufferCellManning->queueWriteAll();
+	}
+
+	this->rollbackSimulation( dTime, dTime );
+	this->resetHydrologicalCountdown( 0.0 );
+
+	// A new branch starts healthy, whatever happened to the last one
+	this->writeControlScalar( oclBufferCourantNumber, this->dCourantNumber );
+	this->pDomain->getDevice()->blockUntilFinished();
+	this->dHealthRecoverUntil	= -1.0;
+	this->uiHealthRecoveries	= 0;
+}
+
 /*
  *  Is the simulation a failure requiring a rollback?
  */
@@ -1603,6 +2583,10 @@ bool	CSchemeGodunov::isSimulationFailure( double dExpectedTargetTime )
 		 uiBatchSuccessful > pDomain->getRollbackLimit() )
 		return true;
 
+	// Redoing a lagged batch used up the spare iterations
+	if ( this->bLaggedRedoIncomplete )
+		return true;
+
 	// This also shouldn't happen... but might...
 	if (this->dCurrentTime > dExpectedTargetTime + 1E-5)
 	{
@@ -1662,7 +2646,8 @@ bool	CSchemeGodunov::isSimulationSyncReady( double dExpectedTargetTime )
 
 	// Are we synchronising the timesteps?
 	if ( pManager->getDomainSet()->getSyncMethod() == model::syncMethod::kSyncTimestep &&
-		 uiIterationsSinceSync < this->pDomain->getRollbackLimit() - 1 &&
+		 ( this->dSyncLagSafety > 0.0 ? uiLaggedIterationsSinceSync < this->getLaggedIterationLimit() :
+		                                uiIterationsSinceSync < this->pDomain->getRollbackLimit() - 1 ) &&
 		 dExpectedTargetTime - dCurrentTime > 1E-5 &&
 		 dCurrentTime > 0.0 )
 		return false;
@@ -1687,22 +2672,47 @@ void	CSchemeGodunov::scheduleIteration(
 				CDomain*		pDomain
 	)
 {
+	// Hydrological kernels are only scheduled on the iterations where they're due
+	bool bHydrologicalStep = true;
+	if ( this->bHydrologicalSubcycling )
+	{
+		bHydrologicalStep = ( this->uiHydrologicalCountdown <= 1 );
+		if ( bHydrologicalStep )
+		{
+			this->resetHydrologicalCountdown( 0.0 );
+		} else {
+			this->uiHydrologicalCountdown--;
+		}
+		if ( this->bFusedSources || this->bFusedDrainage )
+			oclKernelFullTimestep->assignArgument( 8, bHydrologicalStep ? oclBufferTimeHydrological : oclBufferTimeHydrologicalIdle );
+	}
+
 	// Re-set the kernel arguments to use the correct cell state buffer
 	if ( bUseAlternateKernel )
 	{
 		oclKernelFullTimestep->assignArgument( 2, oclBufferCellStatesAlt );
 		oclKernelFullTimestep->assignArgument( 3, oclBufferCellStates );
+		if ( this->bScalarTransport )
+		{
+			oclKernelFullTimestep->assignArgument( 5, oclBufferCellScalarsAlt );
+			oclKernelFullTimestep->assignArgument( 6, oclBufferCellScalars );
+		}
 		oclKernelFriction->assignArgument( 1, oclBufferCellStates );
-		oclKernelTimestepReduction->assignArgument( 3, oclBufferCellStates );
+		oclKernelTimestepReduction->assignArgument( 0, oclBufferCellStates );
 	} else {
 		oclKernelFullTimestep->assignArgument( 2, oclBufferCellStates );
 		oclKernelFullTimestep->assignArgument( 3, oclBufferCellStatesAlt );
+		if ( this->bScalarTransport )
+		{
+			oclKernelFullTimestep->assignArgument( 5, oclBufferCellScalars );
+			oclKernelFullTimestep->assignArgument( 6, oclBufferCellScalarsAlt );
+		}
 		oclKernelFriction->assignArgument( 1, oclBufferCellStatesAlt );
-		oclKernelTimestepReduction->assignArgument( 3, oclBufferCellStatesAlt );
+		oclKernelTimestepReduction->assignArgument( 0, oclBufferCellStatesAlt );
 	}
 
 	// Main scheme kernel
-	oclKernelFullTimestep->scheduleExecution();
+	this->scheduleTimestepKernels( bUseAlternateKernel, pDevice );
 
 	//pDomain->getBoundaries()->streamBoundaries(this->getCurrentTime());
 
@@ -1720,9 +2730,26 @@ void	CSchemeGodunov::scheduleIteration(
 	pDevice->queueBarrier();
 
 	// Run the boundary kernels (each bndy has its own kernel now)
-	pDomain->getBoundaries()->applyBoundaries(bUseAlternateKernel ? oclBufferCellStates : oclBufferCellStatesAlt);
+	if ( pDomain->getBoundaries()->applyBoundaries(bUseAlternateKernel ? oclBufferCellStates : oclBufferCellStatesAlt, bHydrologicalStep) > 0 )
+		pDevice->queueBarrier();
 	// pDomain->getBoundaries()->applyBoundaries(bUseAlternateKernel ? oclBufferCellStates : oclBufferCellStatesAlt); // Note: Should not be required unless something else is broken
-	pDevice->queueBarrier();
+
+	// Accumulated hydrological time has now been consumed. This shares no
+	// data with the ghost fill, so both run before the same barrier.
+	bool bResetHydrological = ( this->bHydrologicalSubcycling && bHydrologicalStep );
+	if ( bResetHydrological )
+		oclKernelResetHydrological->scheduleExecution();
+
+	// Closed and transmissive edges follow the updated cells
+	if ( this->bGhostFill )
+	{
+		oclKernelGhostFill->assignArgument( 0, bUseAlternateKernel ? oclBufferCellStates : oclBufferCellStatesAlt );
+		oclKernelGhostFill->assignArgument( 1, bUseAlternateKernel ? oclBufferCellScalars : oclBufferCellScalarsAlt );
+		oclKernelGhostFill->scheduleExecution();
+	}
+
+	if ( bResetHydrological || this->bGhostFill )
+		pDevice->queueBarrier();
 
 	// Timestep reduction
 	if ( this->bDynamicTimestep )
@@ -1740,16 +2767,33 @@ void	CSchemeGodunov::scheduleIteration(
 	//pDevice->blockUntilFinished();
 }
 
+/*
+ *  Schedule the kernel(s) advancing the cell states by one timestep
+ */
+void	CSchemeGodunov::scheduleTimestepKernels(
+				bool			bUseAlternateKernel,
+				COCLDevice*		pDevice
+	)
+{
+	oclKernelFullTimestep->scheduleExecution();
+}
+
 /*
  *  Read back all of the domain data
  */
 void CSchemeGodunov::readDomainAll()
 {
+	this->dSnapshotTime = this->dCurrentTime;
+
 	if ( bUseAlternateKernel )
 	{
-		oclBufferCellStatesAlt->queueReadAll();
+		this->saveStateOnDevice( oclBufferCellStatesAlt );
+		if ( this->bScalarTransport )
+			oclBufferCellScalarsAlt->queueReadAll();
 	} else {
-		oclBufferCellStates->queueReadAll();
+		this->saveStateOnDevice( oclBufferCellStates );
+		if ( this->bScalarTransport )
+			oclBufferCellScalars->queueReadAll();
 	}
 }
 
@@ -1796,11 +2840,15 @@ void CSchemeGodunov::saveCurrentState()
 {
 	// Flag is flipped after an iteration, so if it's true that means
 	// the last one saved to the normal cell state buffer...
-	getNextCellSourceBuffer()->queueReadAll();
+	this->saveStateOnDevice( getNextCellSourceBuffer() );
+	if ( this->bScalarTransport )
+		( bUseAlternateKernel ? oclBufferCellScalarsAlt : oclBufferCellScalars )->queueReadAll();
+	this->dSnapshotTime = this->dCurrentTime;
 
 	// Reset iteration tracking
 	// TODO: Should this be moved into the sync function?
 	uiIterationsSinceSync = 0;
+	uiLaggedIterationsSinceSync = 0;
 
 	// Block until complete
 	// TODO: Investigate - does this need to be a blocking command?
@@ -1810,6 +2858,110 @@ void CSchemeGodunov::saveCurrentState()
 	//pDomain->getDevice()->blockUntilFinished();
 }
 
+/*
+ *  Read the saved cell states back from a buffer, or with the host copies released,
+ *  keep them on the device where the staging areas and rollbacks can reach them
+ */
+void CSchemeGodunov::saveStateOnDevice( COCLBuffer* pSource )
+{
+	if ( this->oclBufferCellStatesSaved == NULL )
+	{
+		pSource->queueReadAll();
+		return;
+	}
+
+	oclBufferCellStatesSaved->queueCopyFrom( pSource );
+	this->pDomain->invalidateStaging( model::domainArrays::kArrayCellStates );
+}
+
+/*
+ *  Free the host copies of the cell states, bed elevations and Manning values
+ *  once uploaded. A saved copy of the states takes the place of the host copy
+ *  for rollbacks, and values are otherwise fetched in chunks when needed.
+ */
+void CSchemeGodunov::releaseHostMirrors()
+{
+	cl_ulong		ulCells		= this->pDomain->getAllocatedCellCount();
+	unsigned char	ucFloatSize	= oclModel->getFloatSize();
+
+	oclBufferCellStatesSaved = new COCLBuffer( "Cell states (saved)", oclModel, false, false, ucFloatSize * 4 * ulCells );
+	if ( !oclBufferCellStatesSaved->createBuffer() )
+	{
+		delete oclBufferCellStatesSaved;
+		oclBufferCellStatesSaved = NULL;
+		return;
+	}
+
+	oclBufferCellStatesSaved->queueCopyFrom( oclBufferCellStates );
+	this->pDomain->getDevice()->blockUntilFinished();
+
+	oclBufferCellStates->setPointer( NULL, ucFloatSize * 4 * ulCells );
+	oclBufferCellStatesAlt->setPointer( NULL, ucFloatSize * 4 * ulCells );
+	oclBufferCellBed->setPointer( NULL, ucFloatSize * ulCells );
+	oclBufferCellManning->setPointer( NULL, ucFloatSize * ulCells );
+	if ( oclBufferCellDrainage != NULL )
+		oclBufferCellDrainage->setPointer( NULL, ucFloatSize * ulCells );
+
+	this->pDomain->releaseStoreBuffers();
+}
+
+/*
+ *  Read part of the cell states (as last saved), bed elevations or Manning values
+ */
+void CSchemeGodunov::readDomainRange( unsigned char ucArray, unsigned long ulStart, unsigned long ulLength, void* pTarget )
+{
+	COCLBuffer*		pBuffer		= oclBufferCellStatesSaved;
+	unsigned char	ucFloatSize	= oclModel->getFloatSize();
+	unsigned char	ucCellSize	= ucFloatSize * 4;
+
+	if ( ucArray == model::domainArrays::kArrayBedElevations )
+	{
+		pBuffer		= oclBufferCellBed;
+		ucCellSize	= ucFloatSize;
+	}
+	else if ( ucArray == model::domainArrays::kArrayManningCoefficients )
+	{
+		pBuffer		= oclBufferCellManning;
+		ucCellSize	= ucFloatSize;
+	}
+
+	if ( pBuffer == NULL )
+		return;
+
+	this->pDomain->getDevice()->queueBarrier();
+	pBuffer->queueReadPartial( static_cast<cl_ulong>( ulStart ) * ucCellSize, static_cast<size_t>( ulLength ) * ucCellSize, pTarget );
+	this->pDomain->getDevice()->blockUntilFinished();
+}
+
+/*
+ *  Write part of the cell states (to be restored on the next rollback), bed
+ *  elevations or Manning values
+ */
+void CSchemeGodunov::writeDomainRange( unsigned char ucArray, unsigned long ulStart, unsigned long ulLength, void* pSource )
+{
+	COCLBuffer*		pBuffer		= oclBufferCellStatesSaved;
+	unsigned char	ucFloatSize	= oclModel->getFloatSize();
+	unsigned char	ucCellSize	= ucFloatSize * 4;
+
+	if ( ucArray == model::domainArrays::kArrayBedElevations )
+	{
+		pBuffer		= oclBufferCellBed;
+		ucCellSize	= ucFloatSize;
+	}
+	else if ( ucArray == model::domainArrays::kArrayManningCoefficients )
+	{
+		pBuffer		= oclBufferCellManning;
+		ucCellSize	= ucFloatSize;
+	}
+
+	if ( pBuffer == NULL )
+		return;
+
+	this->pDomain->getDevice()->queueBarrier();
+	pBuffer->queueWritePartial( static_cast<cl_ulong>( ulStart ) * ucCellSize, static_cast<size_t>( ulLength ) * ucCellSize, pSource );
+	this->pDomain->getDevice()->blockUntilFinished();
+}
+
 /*
  *  Set the target sync time
  */
@@ -1886,6 +3038,187 @@ void CSchemeGodunov::forceTimestep(double dTimestep)
 	this->bOverrideTimestep = true;
 }
 
+/*
+ *  Write a floating point scalar into its slot in the control block
+ */
+void CSchemeGodunov::writeControlScalar( COCLBuffer* pBuffer, double dValue )
+{
+	if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
+	{
+		*( pBuffer->getHostBlock<float*>() ) = static_cast<cl_float>( dValue );
+	} else {
+		*( pBuffer->getHostBlock<double*>() ) = dValue;
+	}
+	pBuffer->queueWriteAll();
+}
+
+/*
+ *  Read a floating point scalar from the host copy of the control block
+ */
+double CSchemeGodunov::readControlScalar( COCLBuffer* pBuffer )
+{
+	if ( pManager->getFloatPrecision() == model::floatPrecision::kSingle )
+		return static_cast<cl_double>( *( pBuffer->getHostBlock<float*>() ) );
+	return *( pBuffer->getHostBlock<double*>() );
+}
+
+/*
+ *  Lagged iterations allowed between synchronisations, keeping the spare
+ *  iterations back for redoing a violated batch
+ */
+unsigned int CSchemeGodunov::getLaggedIterationLimit()
+{
+	unsigned int uiSpares = pManager->getDomainSet()->getSyncBatchSpares();
+	if ( pDomain->getRollbackLimit() <= uiSpares + 1 )
+		return 1;
+	return pDomain->getRollbackLimit() - uiSpares;
+}
+
+/*
+ *  Redo the part of a lagged batch where the local stability limit fell below
+ *  the lagged timestep. The cells were held at the time of the violation while
+ *  the clock kept pace with the other domains, so step from one to the other
+ *  using our own timestep and leave the time exactly where the others are.
+ */
+void CSchemeGodunov::redoLaggedBatch()
+{
+	double dLaggedTime = this->dCurrentTime;
+
+	this->writeControlScalar( oclBufferTime, this->dTimeViolated );
+	this->writeControlScalar( oclBufferTimeTarget, dLaggedTime );
+	this->writeControlScalar( oclBufferTimestep, min( this->dTimestepLimit, dLaggedTime - this->dTimeViolated ) );
+	this->writeControlScalar( oclBufferTimestepLagged, 0.0 );
+	this->writeControlScalar( oclBufferTimeViolated, -1.0 );
+	pDomain->getDevice()->queueBarrier();
+
+#ifdef DEBUG_MPI
+	pManager->log->writeLine( "[DEBUG] [" + std::to_string(this->pDomain->getID()) + "] Redoing lagged batch from " + Util::secondsToTime(this->dTimeViolated) + " to " + Util::secondsToTime(dLaggedTime) );
+#endif
+
+	this->dCurrentTime = this->dTimeViolated;
+	this->dTimeViolated = -1.0;
+
+	// Only the spare iterations are left for this
+	while ( dLaggedTime - this->dCurrentTime > 1E-5 &&
+			uiIterationsSinceSync < this->pDomain->getRollbackLimit() )
+	{
+		unsigned int uiRedoAmount = min( this->uiQueueAdditionSize, this->pDomain->getRollbackLimit() - uiIterationsSinceSync );
+		for ( unsigned int i = 0; i < uiRedoAmount; i++ )
+		{
+			this->scheduleIteration(
+				bUseAlternateKernel,
+				pDomain->getDevice(),
+				pDomain
+			);
+			uiIterationsSinceSync++;
+			ulCurrentCellsCalculated += this->pDomain->getCellCount();
+			bUseAlternateKernel = !bUseAlternateKernel;
+		}
+
+		oclBufferControl->queueReadAll();
+		this->pDomain->getDevice()->blockUntilFinished();
+		this->readKeyStatistics();
+	}
+
+	// Snap to the time the other domains reached, or give up and rollback
+	if ( dLaggedTime - this->dCurrentTime <= 1E-5 )
+	{
+		this->writeControlScalar( oclBufferTime, dLaggedTime );
+		this->dCurrentTime = dLaggedTime;
+	} else {
+		this->bLaggedRedoIncomplete = true;
+	}
+	this->writeControlScalar( oclBufferTimeTarget, this->dTargetTime );
+	oclBufferControl->queueReadAll();
+	this->pDomain->getDevice()->blockUntilFinished();
+	this->readKeyStatistics();
+}
+
+/*
+ *  Jump a dry and still domain to the next time any boundary adds water, or
+ *  the target time if sooner so outputs and synchronisation still happen
+ */
+void CSchemeGodunov::fastForwardDry()
+{
+	double dNextTime = min( this->dTargetTime, pDomain->getBoundaries()->getNextActiveTime( this->dCurrentTime ) );
+
+	// Not worth it if the next step gets there anyway
+	if ( dNextTime - this->dCurrentTime <= this->dCurrentTimestep )
+		return;
+
+#ifdef DEBUG_MPI
+	pManager->log->writeLine( "[DEBUG] [" + std::to_string(this->pDomain->getID()) + "] Fast-forwarding dry domain from " + Util::secondsToTime(this->dCurrentTime) + " to " + Util::secondsToTime(dNextTime) );
+#endif
+
+	// A zero timestep skips the next iteration, which then recalculates it from here
+	this->writeControlScalar( oclBufferTime, dNextTime );
+	this->writeControlScalar( oclBufferTimestep, 0.0 );
+	this->pDomain->getDevice()->blockUntilFinished();
+
+	this->dCurrentTime = dNextTime;
+	this->dCurrentTimestep = 0.0;
+	this->uiQuiescent = 0;
+}
+
+/*
+ *  Roll back to the host copy of the domain with a reduced Courant number if the
+ *  last batch left anything non-finite, negative or running away, then restore
+ *  the configured number once the simulation is safely beyond the failure
+ */
+void CSchemeGodunov::checkHealth()
+{
+	cl_uint* uiHealth = oclBufferHealth->getHostBlock<cl_uint*>();
+
+	if ( uiHealth[0] == 0 )
+	{
+		if ( this->dHealthRecoverUntil >= 0.0 && this->dCurrentTime >= this->dHealthRecoverUntil )
+		{
+			this->writeControlScalar( oclBufferCourantNumber, this->dCourantNumber );
+			this->pDomain->getDevice()->blockUntilFinished();
+			this->dHealthRecoverUntil = -1.0;
+			this->uiHealthRecoveries = 0;
+			pManager->log->writeLine( "Domain #" + toString( this->pDomain->getID() + 1 ) + " recovered, Courant number restored to " + toString( this->dCourantNumber ) + "." );
+		}
+		return;
+	}
+
+	std::string sProblems;
+	if ( uiHealth[0] & 1 ) sProblems += " non-finite values,";
+	if ( uiHealth[0] & 2 ) sProblems += " negative depths,";
+	if ( uiHealth[0] & 4 ) sProblems += " " + toString( uiHealth[1] ) + " runaway velocities,";
+	sProblems.pop_back();
+
+	model::doError(
+		"Domain #" + toString( this->pDomain->getID() + 1 ) + " became unhealthy by " + Util::secondsToTime( this->dCurrentTime ) + " with" + sProblems + ".",
+		model::errorCodes::kLevelWarning
+	);
+
+	// Each attempt tightens the CFL condition further before giving up
+	if ( ++this->uiHealthRecoveries > 5 )
+	{
+		model::doError(
+			"Could not recover from an unhealthy state by reducing the Courant number.",
+			model::errorCodes::kLevelModelStop
+		);
+		return;
+	}
+
+	double dCourantNumber = this->dCourantNumber * pow( this->dHealthCourantFactor, static_cast<double>( this->uiHealthRecoveries ) );
+	this->dHealthRecoverUntil = std::max( this->dHealthRecoverUntil, this->dCurrentTime + this->dHealthRecoveryWindow );
+
+	pManager->log->writeLine( "Rolling back to " + Util::secondsToTime( this->dSnapshotTime ) + " with a Courant number of " + toString( dCourantNumber ) + "." );
+
+	uiHealth[0] = 0;
+	uiHealth[1] = 0;
+	oclBufferHealth->queueWriteAll();
+	this->writeControlScalar( oclBufferCourantNumber, dCourantNumber );
+	this->rollbackSimulation( this->dSnapshotTime, this->dTargetTime );
+	this->pDomain->getDevice()->blockUntilFinished();
+
+	this->dCurrentTimestep = 0.0;
+	this->uiQuiescent = 0;
+}
+
 /*
  *  Fetch key details back to the right places in memory
  */
@@ -1906,5 +3239,26 @@ void	CSchemeGodunov::readKeyStatistics()
 	}
 	uiBatchSuccessful = *( oclBufferBatchSuccessful->getHostBlock<cl_uint*>() );
 	uiBatchSkipped	  = *( oclBufferBatchSkipped->getHostBlock<cl_uint*>() );
+	uiQuiescent		  = *( oclBufferQuiescent->getHostBlock<cl_uint*>() );
 	uiBatchRate = uiBatchSuccessful > uiLastBatchSuccessful ? (uiBatchSuccessful - uiLastBatchSuccessful) : 1;
+
+	// A lagged batch proposes its lowest local limit for the next reduction,
+	// rather than the timestep it was held at
+	if ( this->dSyncLagSafety > 0.0 )
+	{
+		dTimestepLimit = this->readControlScalar( oclBufferTimestepLimit );
+		dTimeViolated = this->readControlScalar( oclBufferTimeViolated );
+		if ( dTimestepLimit > 0.0 )
+			dCurrentTimestep = dTimestepLimit * this->dSyncLagSafety;
+	}
+
+	// Re-estimate the hydrological cadence from what the device has accumulated
+	if ( this->bHydrologicalSubcycling )
+	{
+		this->resetHydrologicalCountdown(
+			pManager->getFloatPrecision() == model::floatPrecision::kSingle ?
+				static_cast<cl_double>( *( oclBufferTimeHydrological->getHostBlock<float*>() ) ) :
+				*( oclBufferTimeHydrological->getHostBlock<double*>() )
+		);
+	}
 }
@@ -21,6 +21,7 @@
 
 #include "CScheme.h"
 #include <mutex>
+#include <vector>
 
 namespace model {
 
@@ -28,7 +29,8 @@ namespace model {
 namespace schemeConfigurations{
 namespace godunovType { enum godunovType {
 	kCacheNone						= 0,		// No caching
-	kCacheEnabled					= 1			// Cache cell state data
+	kCacheEnabled					= 1,		// Cache cell state data
+	kCacheCoarsened					= 2			// Each work-item walks a strip of cells
 }; }  }
 
 namespace cacheConstraints{
@@ -40,6 +42,9 @@ namespace godunovType { enum godunovType {
 
 }
 
+// Class stubs
+class CBoundary;
+
 /*
  *  SCHEME CLASS
  *  CSchemeGodunov
@@ -59,6 +64,9 @@ class CSchemeGodunov : public CScheme
 		virtual void		setupFromConfig( XMLElement*, bool = false );			// Set up the scheme
 		virtual void		logDetails();											// Write some details about the scheme
 		virtual void		prepareAll();											// Prepare absolutely everything for a model run
+		virtual bool		prepareSetup();											// Prepare everything which doesn't need the built program
+		virtual bool		prepareProgram();										// Build the program
+		virtual bool		prepareFinish();										// Create kernels and boundaries once built
 		virtual void		scheduleIteration( bool,								// Schedule an iteration of the scheme
 											   COCLDevice*,
 											   CDomain* );
@@ -72,6 +80,21 @@ class CSchemeGodunov : public CScheme
 		unsigned char		getRiemannSolver();										// Get the Riemann solver in use
 		void				setCacheMode( unsigned char );							// Set the cache configuration
 		unsigned char		getCacheMode();											// Get the cache configuration
+		void				setCoarseningFactor( unsigned int );					// Set the cells walked by each work-item when coarsened
+		unsigned int		getCoarseningFactor();									// Get the cells walked by each work-item when coarsened
+		void				setScalarTransport( bool );								// Enable/disable passive scalar transport
+		bool				getScalarTransport();									// Get enabled/disabled for passive scalar transport
+		void				setFusedSources( bool );								// Enable/disable rainfall within the flux kernel
+		bool				getFusedSources();										// Get enabled/disabled for rainfall within the flux kernel
+		void				setHydrologicalSubcycling( bool );						// Enable/disable host scheduling of hydrological kernels
+		bool				getHydrologicalSubcycling();							// Get enabled/disabled for host scheduling of hydrological kernels
+		void				setDryFastForward( bool );								// Enable/disable skipping dry spells to the next forcing
+		bool				getDryFastForward();									// Get enabled/disabled for skipping dry spells
+		void				setDryFastForwardDepth( double );						// Set the depth below which the domain is considered dry
+		void				setHealthMonitor( bool );								// Enable/disable the numerical health monitor
+		bool				getHealthMonitor();										// Get enabled/disabled for the numerical health monitor
+		void				setHealthRecovery( double, double );					// Set the Courant factor and window used when recovering
+		void				setHealthMaxVelocity( double );							// Set the velocity beyond which a cell is unhealthy
 		void				setCacheConstraints( unsigned char );					// Set LDS cache size constraints
 		unsigned char		getCacheConstraints();									// Get LDS cache size constraints
 		void				setCachedWorkgroupSize( unsigned char );				// Set the work-group size
@@ -82,6 +105,13 @@ class CSchemeGodunov : public CScheme
 		double				getAverageTimestep();									// Get batch average timestep
 		virtual COCLBuffer*	getLastCellSourceBuffer();								// Get the last source cell state buffer
 		virtual COCLBuffer*	getNextCellSourceBuffer();								// Get the next source cell state buffer
+		virtual void		readDomainRange( unsigned char, unsigned long, unsigned long, void* );	// Read part of a cell data array from the device (blocking)
+		virtual void		writeDomainRange( unsigned char, unsigned long, unsigned long, void* );	// Write part of a cell data array to the device (blocking)
+		virtual void		preparePreview( unsigned long, unsigned long, unsigned int, unsigned int );	// Prepare the on-device preview pyramid
+		virtual void		requestPreview();										// Request a preview with the next batch
+		virtual bool		isPreviewReady();										// Has a requested preview been read back?
+		virtual cl_float*	getPreviewLevel( unsigned int, unsigned int*, unsigned int* );	// Fetch a level of the preview pyramid
+		virtual void		releasePreview();										// Finished with the preview data on the host
 
 #ifdef PLATFORM_WIN
 		static DWORD		Threaded_runBatchLaunch(LPVOID param);
@@ -101,11 +131,24 @@ class CSchemeGodunov : public CScheme
 		virtual void		saveCurrentState();										// Save current cell states
 		virtual void		forceTimeAdvance();										// Force time advance (when synced will stall)
 		virtual void		rollbackSimulation( double, double );					// Roll back cell states to the last successful round
+		virtual void		branchSimulation( double );								// Restart from the host copy of the domain at an earlier time
 		virtual bool		isSimulationFailure( double );							// Check whether we successfully reached a specific time
 		virtual bool		isSimulationSyncReady( double );						// Are we ready to synchronise? i.e. have we reached the set sync time?
 
 	protected:
 
+		// Private structures
+		struct sPreviewConfiguration
+		{
+			cl_uint			uiSourceCols;
+			cl_uint			uiSourceRows;
+			cl_uint			uiSourceOffset;
+			cl_uint			uiTargetCols;
+			cl_uint			uiTargetRows;
+			cl_uint			uiTargetOffset;
+			cl_uint			uiStride;
+		};
+
 		// Private variables
 		cl_ulong			ulCachedWorkgroupSizeX, ulCachedWorkgroupSizeY;
 		cl_ulong			ulNonCachedWorkgroupSizeX, ulNonCachedWorkgroupSizeY;
@@ -118,6 +161,9 @@ class CSchemeGodunov : public CScheme
 
 		unsigned char		ucConfiguration;										// Kernel configuration in-use
 		unsigned char		ucCacheConstraints;										// Kernel LDS cache constraints
+		unsigned int		uiCoarseningFactor;										// Cells walked by each work-item in the coarsened kernels
+		unsigned char		ucGhostCells;											// Width of the ghost cell ring the stencil needs
+		bool				bGhostFill;												// Refill the ghost cells each iteration (any edge not open)?
 		unsigned char		ucSolverType;											// Code for the Riemann solver type
 		unsigned char		ucSyncMethod;											// Synchronisation method employed
 		double				dThresholdVerySmall;									// Threshold value for 'very small'
@@ -133,6 +179,29 @@ class CSchemeGodunov : public CScheme
 		bool				bDownloadLinks;											// Download dependent links?
 		bool				bIncludeBoundaries;										// Boundary condition kernel is required?
 		bool				bCellStatesSynced;										// Are the host cell states synchronised with the compute device?
+		bool				bScalarTransport;										// Transport a passive scalar with the flow?
+		bool				bFusedSources;											// Apply uniform/gridded sources in the flux kernel?
+		CBoundary*			pFusedUniform;											// Uniform boundary applied in the flux kernel
+		CBoundary*			pFusedGridded;											// Gridded boundary applied in the flux kernel
+		bool				bFusedDrainage;											// Apply the drainage capacities in the flux kernel?
+		bool				bHydrologicalSubcycling;								// Only launch hydrological kernels when they're due?
+		double				dHydrologicalTimestep;									// Interval between hydrological process updates
+		unsigned int		uiHydrologicalCountdown;								// Iterations until the next hydrological update
+		double				dSyncLagSafety;											// Safety factor on the lagged global timestep (zero if not lagged)
+		double				dTimestepLimit;											// Lowest local timestep limit seen in the last lagged batch
+		double				dTimeViolated;											// Time the lagged timestep was violated (negative if not)
+		unsigned int		uiLaggedIterationsSinceSync;							// Lagged iterations since we last synchronised (excludes redos)
+		bool				bLaggedRedoIncomplete;									// Ran out of iterations redoing a lagged batch?
+		bool				bDryFastForward;										// Skip dry spells straight to the next forcing?
+		double				dDryFastForwardDepth;									// Depth below which the domain is considered dry
+		cl_uint				uiQuiescent;											// Was the domain dry and still after the last iteration?
+		bool				bHealthMonitor;											// Check for non-finite, negative or runaway states?
+		double				dHealthCourantFactor;									// Courant number reduction for each recovery attempt
+		double				dHealthRecoveryWindow;									// Time beyond the failure to keep the reduced Courant number
+		double				dHealthMaxVelocity;										// Velocity beyond which a cell is considered unhealthy
+		double				dHealthRecoverUntil;									// Time the reduced Courant number is lifted (negative if not)
+		unsigned int		uiHealthRecoveries;										// Consecutive recovery attempts for the current failure
+		double				dSnapshotTime;											// Time of the cell states held in host memory
 		unsigned int		uiDebugCellX;											// Debug info cell X
 		unsigned int		uiDebugCellY;											// Debug info cell Y
 		unsigned int		uiTimestepReductionWavefronts;							// Number of wavefronts used in reduction
@@ -141,17 +210,32 @@ class CSchemeGodunov : public CScheme
 		cl_ulong*			ulBoundaryRelationCells;								// Boundary to cell relations
 		cl_uint*			uiBoundaryRelationSeries;								// Target series for the boundary to cell relations
 		cl_uint*			uiBoundaryParameters;									// Boundary parameters bitmask
+		std::vector<sPreviewConfiguration>	vPreviewLevels;							// Dimensions of each preview pyramid level
+		std::atomic<bool>	bPreviewRequested;										// Preview to be produced with the next batch?
+		std::atomic<bool>	bPreviewReady;											// Preview has been read back to the host?
 
 		// Private functions
 		virtual bool		prepareCode();											// Prepare the code required
 		virtual void		releaseResources();										// Release OpenCL resources consumed
 		virtual bool		prepareBoundaries();									// Prepare the boundary conditions and time series
 		bool				prepareGeneralKernels();								// Prepare the general kernels required
+		virtual void		scheduleTimestepKernels( bool, COCLDevice* );			// Schedule the kernel(s) advancing the cell states
+		virtual unsigned int	getKernelCoarsening();								// Cells walked by each work-item in the configuration in use
+		void				resetHydrologicalCountdown( double );					// Estimate iterations until hydrological processes are due
+		void				writeControlScalar( COCLBuffer*, double );				// Write a floating point scalar into the control block
+		double				readControlScalar( COCLBuffer* );						// Read a floating point scalar from the control block host copy
+		unsigned int		getLaggedIterationLimit();								// Lagged iterations allowed between synchronisations
+		void				redoLaggedBatch();										// Redo a violated lagged batch with the local timestep
+		void				fastForwardDry();										// Jump a dry domain to the next forcing or sync point
+		void				checkHealth();											// Recover from an unhealthy state flagged in the last batch
+		void				releaseHostMirrors();									// Hand the host copies back, keeping the saved states on the device
+		void				saveStateOnDevice( COCLBuffer* );						// Take the saved states from a buffer in place of a readback
 		bool				prepare1OKernels();										// Prepare the kernels required
 		bool				prepare1OConstants();									// Assign constants to the executor
 		bool				prepare1OMemory();										// Prepare memory buffers required
 		bool				prepare1OExecDimensions();								// Size the problem for execution
 		void				release1OResources();									// Release 1st-order OpenCL resources consumed
+		void				releasePreviewResources();								// Release OpenCL resources for the preview pyramid
 
 		// OpenCL elements
 		COCLProgram*		oclModel;
@@ -160,19 +244,36 @@ class CSchemeGodunov : public CScheme
 		COCLKernel*			oclKernelTimestepReduction;
 		COCLKernel*			oclKernelTimeAdvance;
 		COCLKernel*			oclKernelResetCounters;
+		COCLKernel*			oclKernelResetHydrological;
 		COCLKernel*			oclKernelTimestepUpdate;
+		COCLKernel*			oclKernelGhostFill;
 		COCLBuffer*			oclBufferCellStates;
 		COCLBuffer*			oclBufferCellStatesAlt;
+		COCLBuffer*			oclBufferCellStatesSaved;
+		COCLBuffer*			oclBufferCellScalars;
+		COCLBuffer*			oclBufferCellScalarsAlt;
 		COCLBuffer*			oclBufferCellManning;
 		COCLBuffer*			oclBufferCellBed;
+		COCLBuffer*			oclBufferCellDrainage;
+		COCLBuffer*			oclBufferControl;
 		COCLBuffer*			oclBufferTimestep;
 		COCLBuffer*			oclBufferTime;
 		COCLBuffer*			oclBufferTimeTarget;
 		COCLBuffer*			oclBufferTimeHydrological;
+		COCLBuffer*			oclBufferTimeHydrologicalIdle;
 		COCLBuffer*			oclBufferTimestepReduction;
 		COCLBuffer*			oclBufferBatchTimesteps;
 		COCLBuffer*			oclBufferBatchSuccessful;
 		COCLBuffer*			oclBufferBatchSkipped;
+		COCLBuffer*			oclBufferTimestepLagged;
+		COCLBuffer*			oclBufferTimestepLimit;
+		COCLBuffer*			oclBufferTimeViolated;
+		COCLBuffer*			oclBufferQuiescent;
+		COCLBuffer*			oclBufferHealth;
+		COCLBuffer*			oclBufferCourantNumber;
+		COCLBuffer*			oclBufferPreview;
+		std::vector<COCLKernel*>	oclKernelPreview;
+		std::vector<COCLBuffer*>	oclBufferPreviewConfiguration;
 
 };
 
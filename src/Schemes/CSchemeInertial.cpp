@@ -24,6 +24,7 @@
 #include "../Boundaries/CBoundary.h"
 #include "../Domain/CDomain.h"
 #include "../Domain/Cartesian/CDomainCartesian.h"
+#include "../Datasets/CXMLDataset.h"
 #include "CSchemeInertial.h"
 
 using std::min;
@@ -45,6 +46,25 @@ CSchemeInertial::CSchemeInertial(void)
 	this->ucSolverType					= model::solverTypes::kHLLC;
 	this->ucConfiguration				= model::schemeConfigurations::inertialFormula::kCacheNone;
 	this->ucCacheConstraints			= model::cacheConstraints::inertialFormula::kCacheActualSize;
+	this->bSemiImplicit					= false;
+	this->uiSolverIterations			= 40;
+	this->dSolverTolerance				= 1E-6;
+
+	oclKernelImplicitFaces				= NULL;
+	oclKernelImplicitResidual			= NULL;
+	oclKernelImplicitStart				= NULL;
+	oclKernelImplicitApply				= NULL;
+	oclKernelImplicitAlpha				= NULL;
+	oclKernelImplicitUpdate				= NULL;
+	oclKernelImplicitBeta				= NULL;
+	oclKernelImplicitDirection			= NULL;
+	oclBufferImplicitFaces				= NULL;
+	oclBufferImplicitSolution			= NULL;
+	oclBufferImplicitDirection			= NULL;
+	oclBufferImplicitProduct			= NULL;
+	oclBufferImplicitDiagonal			= NULL;
+	oclBufferImplicitPartials			= NULL;
+	oclBufferImplicitScalars			= NULL;
 }
 
 /*
@@ -57,9 +77,71 @@ CSchemeInertial::~CSchemeInertial(void)
 }
 
 /*
- *  Run all preparation steps
+ *  Read in settings from the XML configuration file for this scheme
  */
-void CSchemeInertial::prepareAll()
+void	CSchemeInertial::setupFromConfig( XMLElement* pXScheme, bool bInheritanceChain )
+{
+	// Call the base class function which handles most of the settings
+	CSchemeGodunov::setupFromConfig( pXScheme, bInheritanceChain );
+
+	XMLElement		*pParameter		= pXScheme->FirstChildElement("parameter");
+	char			*cParameterName = NULL, *cParameterValue = NULL;
+
+	while ( pParameter != NULL )
+	{
+		Util::toLowercase( &cParameterName,  pParameter->Attribute( "name" ) );
+		Util::toLowercase( &cParameterValue, pParameter->Attribute( "value" ) );
+
+		if ( strcmp( cParameterName, "semiimplicit" ) == 0 )
+		{
+			unsigned char ucSemiImplicit = 255;
+			if ( strcmp( cParameterValue, "yes" ) == 0 || strcmp( cParameterValue, "enabled" ) == 0 )
+				ucSemiImplicit = 1;
+			if ( strcmp( cParameterValue, "no" ) == 0 || strcmp( cParameterValue, "disabled" ) == 0 )
+				ucSemiImplicit = 0;
+			if ( ucSemiImplicit == 255 )
+			{
+				model::doError(
+					"Invalid semi-implicit state given.",
+					model::errorCodes::kLevelWarning
+				);
+			} else {
+				this->setSemiImplicit( ucSemiImplicit == 1 );
+			}
+		}
+		else if ( strcmp( cParameterName, "solveriterations" ) == 0 )
+		{
+			if ( !CXMLDataset::isValidUnsignedInt( cParameterValue ) )
+			{
+				model::doError(
+					"Invalid solver iteration count given.",
+					model::errorCodes::kLevelWarning
+				);
+			} else {
+				this->setSolverIterations( boost::lexical_cast<unsigned int>( cParameterValue ) );
+			}
+		}
+		else if ( strcmp( cParameterName, "solvertolerance" ) == 0 )
+		{
+			if ( !CXMLDataset::isValidFloat( cParameterValue ) )
+			{
+				model::doError(
+					"Invalid solver tolerance given.",
+					model::errorCodes::kLevelWarning
+				);
+			} else {
+				this->setSolverTolerance( boost::lexical_cast<double>( cParameterValue ) );
+			}
+		}
+
+		pParameter = pParameter->NextSiblingElement("parameter");
+	}
+}
+
+/*
+ *  Prepare everything which doesn't need the built program
+ */
+bool CSchemeInertial::prepareSetup()
 {
 	// Clean any pre-existing OpenCL objects
 	this->releaseResources();
@@ -78,6 +160,42 @@ void CSchemeInertial::prepareAll()
 	this->oclModel->setForcedSinglePrecision( pManager->getFloatPrecision() == model::floatPrecision::kSingle );
 	unsigned char ucFloatSize =  ( pManager->getFloatPrecision() == model::floatPrecision::kSingle ? sizeof( cl_double ) : sizeof( cl_float ) );
 
+	// The inertial kernels don't carry the passive scalar
+	if ( this->bScalarTransport )
+	{
+		model::doError(
+			"Scalar transport is only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bScalarTransport = false;
+	}
+	if ( this->bFusedSources )
+	{
+		model::doError(
+			"Fused sources are only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bFusedSources = false;
+	}
+	if ( this->pDomain->hasDrainageCapacity() )
+	{
+		model::doError(
+			"Drainage capacity is only applied by the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+	}
+
+	// Deep still water is no longer a constraint on the timestep, so the
+	// reduction can't tell whether the domain is dry
+	if ( this->bSemiImplicit && this->bDryFastForward )
+	{
+		model::doError(
+			"Dry fast-forward is not available with the semi-implicit scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bDryFastForward = false;
+	}
+
 	// OpenCL elements
 	if ( !this->prepare1OExecDimensions() ) 
 	{ 
@@ -86,7 +204,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OConstants() ) 
@@ -96,7 +214,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepareInertialConstants() ) 
@@ -106,7 +224,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepareCode() ) 
@@ -116,7 +234,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OMemory() ) 
@@ -126,9 +244,27 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
+	}
+
+	if ( this->bSemiImplicit && !this->prepareImplicitMemory() )
+	{
+		model::doError(
+			"Failed to create implicit solver memory buffers. Cannot continue.",
+			model::errorCodes::kLevelModelStop
+		);
+		this->releaseResources();
+		return false;
 	}
 
+	return true;
+}
+
+/*
+ *  Create the kernels and boundaries once the program is built
+ */
+bool CSchemeInertial::prepareFinish()
+{
 	if ( !this->prepareGeneralKernels() ) 
 	{ 
 		model::doError(
@@ -136,7 +272,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 	if ( !this->prepareInertialKernels() ) 
 	{ 
@@ -145,7 +281,7 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if (!this->prepareBoundaries())
@@ -155,11 +291,12 @@ void CSchemeInertial::prepareAll()
 			model::errorCodes::kLevelModelStop
 			);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	this->logDetails();
 	this->bReady = true;
+	return true;
 }
 
 /*
@@ -179,6 +316,9 @@ void CSchemeInertial::logDetails()
 	case model::schemeConfigurations::inertialFormula::kCacheEnabled:
 			sConfiguration = "Enabled";
 		break;
+	case model::schemeConfigurations::inertialFormula::kCacheCoarsened:
+			sConfiguration = "Coarsened, " + toString( this->uiCoarseningFactor ) + " cells per work-item";
+		break;
 	}
 
 	pManager->log->writeLine( "SIMPLIFIED INERTIAL FORMULATION SCHEME", true, wColour );
@@ -189,6 +329,7 @@ void CSchemeInertial::logDetails()
 	pManager->log->writeLine( "  Boundaries:         " + toString( this->pDomain->getBoundaries()->getBoundaryCount() ), true, wColour );
 	pManager->log->writeLine( "  Configuration:      " + sConfiguration, true, wColour );
 	pManager->log->writeLine( "  Friction effects:   " + (std::string)( this->bFrictionEffects ? "Enabled" : "Disabled" ), true, wColour );
+	pManager->log->writeLine( "  Free surface:       " + (std::string)( this->bSemiImplicit ? "Semi-implicit, " + toString( this->uiSolverIterations ) + " CG iterations to " + toString( this->dSolverTolerance ) : "Explicit" ), true, wColour );
 	pManager->log->writeLine( "  Kernel queue mode:  " + (std::string)( this->bAutomaticQueue ? "Automatic" : "Fixed size" ), true, wColour );
 	pManager->log->writeLine( (std::string)( this->bAutomaticQueue ? "  Initial queue:      " : "  Fixed queue:        " ) + toString( this->uiQueueAdditionSize ) + " iteration(s)", true, wColour );
 	pManager->log->writeLine( "  Debug output:       " + (std::string)( this->bDebugOutput ? "Enabled" : "Disabled" ), true, wColour );
@@ -215,7 +356,7 @@ bool CSchemeInertial::prepareCode()
 	oclModel->appendCodeFromResource( "CLSchemeInertial_C" );
 	oclModel->appendCodeFromResource( "CLBoundaries_C" );
 
-	bReturnState = oclModel->compileProgram();
+	bReturnState = oclModel->createProgram();
 
 	return bReturnState;
 }
@@ -247,6 +388,20 @@ bool CSchemeInertial::prepareInertialConstants()
 			break;
 	}
 
+	// --
+	// Semi-implicit free surface, leaving the timestep bound by advection
+	// --
+
+	if ( this->bSemiImplicit )
+	{
+		oclModel->registerConstant( "SEMI_IMPLICIT", "1" );
+		oclModel->registerConstant( "TIMESTEP_ADVECTIVE", "1" );
+		oclModel->registerConstant( "IMPLICIT_TOLERANCE", toString( this->dSolverTolerance ) );
+	} else {
+		oclModel->removeConstant( "SEMI_IMPLICIT" );
+		oclModel->removeConstant( "TIMESTEP_ADVECTIVE" );
+	}
+
 	return true;
 }
 
@@ -264,6 +419,56 @@ bool CSchemeInertial::prepareInertialKernels()
 	// Inertial scheme kernels
 	// --
 
+	if ( this->bSemiImplicit )
+	{
+		oclKernelImplicitFaces		= oclModel->getKernel( "ine_siFaces" );
+		oclKernelImplicitResidual	= oclModel->getKernel( "ine_siResidual" );
+		oclKernelImplicitStart		= oclModel->getKernel( "ine_siStart" );
+		oclKernelImplicitApply		= oclModel->getKernel( "ine_siApply" );
+		oclKernelImplicitAlpha		= oclModel->getKernel( "ine_siAlpha" );
+		oclKernelImplicitUpdate		= oclModel->getKernel( "ine_siUpdate" );
+		oclKernelImplicitBeta		= oclModel->getKernel( "ine_siBeta" );
+		oclKernelImplicitDirection	= oclModel->getKernel( "ine_siDirection" );
+
+		// The solution is committed in place of the explicit kernel, so it
+		// alternates cell state buffers in exactly the same way
+		oclKernelFullTimestep		= oclModel->getKernel( "ine_siFinalise" );
+
+		COCLKernel* aryKernelsCells[]	= { oclKernelImplicitFaces, oclKernelImplicitResidual, oclKernelImplicitApply, oclKernelImplicitUpdate, oclKernelImplicitDirection, oclKernelFullTimestep };
+		COCLKernel* aryKernelsScalars[]	= { oclKernelImplicitStart, oclKernelImplicitAlpha, oclKernelImplicitBeta };
+		for( unsigned int i = 0; i < 6; ++i )
+		{
+			aryKernelsCells[i]->setGroupSize( this->ulReductionWorkgroupSize );
+			aryKernelsCells[i]->setGlobalSize( this->ulReductionGlobalSize );
+		}
+		for( unsigned int i = 0; i < 3; ++i )
+		{
+			aryKernelsScalars[i]->setGroupSize( 1, 1, 1 );
+			aryKernelsScalars[i]->setGlobalSize( 1, 1, 1 );
+		}
+
+		COCLBuffer* aryArgsFaces[]		= { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellManning, oclBufferImplicitFaces };
+		COCLBuffer* aryArgsResidual[]	= { oclBufferTimestep, oclBufferCellStates, oclBufferImplicitFaces, oclBufferImplicitSolution, oclBufferImplicitDirection, oclBufferImplicitDiagonal, oclBufferImplicitPartials };
+		COCLBuffer* aryArgsStart[]		= { oclBufferImplicitPartials, oclBufferImplicitScalars };
+		COCLBuffer* aryArgsApply[]		= { oclBufferTimestep, oclBufferImplicitFaces, oclBufferImplicitDirection, oclBufferImplicitProduct, oclBufferImplicitDiagonal, oclBufferImplicitPartials };
+		COCLBuffer* aryArgsAlpha[]		= { oclBufferImplicitPartials, oclBufferImplicitScalars };
+		COCLBuffer* aryArgsUpdate[]		= { oclBufferImplicitSolution, oclBufferImplicitDirection, oclBufferImplicitProduct, oclBufferImplicitDiagonal, oclBufferImplicitScalars, oclBufferImplicitPartials };
+		COCLBuffer* aryArgsBeta[]		= { oclBufferImplicitPartials, oclBufferImplicitScalars };
+		COCLBuffer* aryArgsDirection[]	= { oclBufferImplicitSolution, oclBufferImplicitDirection, oclBufferImplicitDiagonal, oclBufferImplicitScalars };
+		COCLBuffer* aryArgsFinalise[]	= { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferImplicitFaces, oclBufferImplicitSolution };
+		oclKernelImplicitFaces->assignArguments( aryArgsFaces );
+		oclKernelImplicitResidual->assignArguments( aryArgsResidual );
+		oclKernelImplicitStart->assignArguments( aryArgsStart );
+		oclKernelImplicitApply->assignArguments( aryArgsApply );
+		oclKernelImplicitAlpha->assignArguments( aryArgsAlpha );
+		oclKernelImplicitUpdate->assignArguments( aryArgsUpdate );
+		oclKernelImplicitBeta->assignArguments( aryArgsBeta );
+		oclKernelImplicitDirection->assignArguments( aryArgsDirection );
+		oclKernelFullTimestep->assignArguments( aryArgsFinalise );
+
+		return bReturnState;
+	}
+
 	if ( this->ucConfiguration == model::schemeConfigurations::inertialFormula::kCacheNone )
 	{
 		oclKernelFullTimestep = oclModel->getKernel( "ine_cacheDisabled" );
@@ -280,6 +485,14 @@ bool CSchemeInertial::prepareInertialKernels()
 		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning };	
 		oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
 	}
+	if ( this->ucConfiguration == model::schemeConfigurations::inertialFormula::kCacheCoarsened )
+	{
+		oclKernelFullTimestep = oclModel->getKernel( "ine_cacheCoarsened" );
+		oclKernelFullTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
+		oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, ( this->ulNonCachedGlobalSizeY + this->uiCoarseningFactor - 1 ) / this->uiCoarseningFactor );
+		COCLBuffer* aryArgsFullTimestep[] = { oclBufferTimestep, oclBufferCellBed, oclBufferCellStates, oclBufferCellStatesAlt, oclBufferCellManning };	
+		oclKernelFullTimestep->assignArguments( aryArgsFullTimestep );
+	}
 
 	return bReturnState;
 }
@@ -306,7 +519,112 @@ void CSchemeInertial::releaseInertialResources()
 
 	pManager->log->writeLine("Releasing inertial scheme resources held for OpenCL.");
 
-	// Nothing to do?
+	if ( this->oclKernelImplicitFaces != NULL )				delete oclKernelImplicitFaces;
+	if ( this->oclKernelImplicitResidual != NULL )			delete oclKernelImplicitResidual;
+	if ( this->oclKernelImplicitStart != NULL )				delete oclKernelImplicitStart;
+	if ( this->oclKernelImplicitApply != NULL )				delete oclKernelImplicitApply;
+	if ( this->oclKernelImplicitAlpha != NULL )				delete oclKernelImplicitAlpha;
+	if ( this->oclKernelImplicitUpdate != NULL )			delete oclKernelImplicitUpdate;
+	if ( this->oclKernelImplicitBeta != NULL )				delete oclKernelImplicitBeta;
+	if ( this->oclKernelImplicitDirection != NULL )			delete oclKernelImplicitDirection;
+	if ( this->oclBufferImplicitFaces != NULL )				delete oclBufferImplicitFaces;
+	if ( this->oclBufferImplicitSolution != NULL )			delete oclBufferImplicitSolution;
+	if ( this->oclBufferImplicitDirection != NULL )			delete oclBufferImplicitDirection;
+	if ( this->oclBufferImplicitProduct != NULL )			delete oclBufferImplicitProduct;
+	if ( this->oclBufferImplicitDiagonal != NULL )			delete oclBufferImplicitDiagonal;
+	if ( this->oclBufferImplicitPartials != NULL )			delete oclBufferImplicitPartials;
+	if ( this->oclBufferImplicitScalars != NULL )			delete oclBufferImplicitScalars;
+
+	oclKernelImplicitFaces			= NULL;
+	oclKernelImplicitResidual		= NULL;
+	oclKernelImplicitStart			= NULL;
+	oclKernelImplicitApply			= NULL;
+	oclKernelImplicitAlpha			= NULL;
+	oclKernelImplicitUpdate			= NULL;
+	oclKernelImplicitBeta			= NULL;
+	oclKernelImplicitDirection		= NULL;
+	oclBufferImplicitFaces			= NULL;
+	oclBufferImplicitSolution		= NULL;
+	oclBufferImplicitDirection		= NULL;
+	oclBufferImplicitProduct		= NULL;
+	oclBufferImplicitDiagonal		= NULL;
+	oclBufferImplicitPartials		= NULL;
+	oclBufferImplicitScalars		= NULL;
+}
+
+/*
+ *  Allocate the vectors used by the conjugate gradient solver, which
+ *  only ever live on the device
+ */
+bool CSchemeInertial::prepareImplicitMemory()
+{
+	bool						bReturnState		= true;
+	CDomain*					pDomain				= this->pDomain;
+
+	unsigned char ucFloatSize = ( pManager->getFloatPrecision() == model::floatPrecision::kDouble ? sizeof( cl_double ) : sizeof( cl_float ) );
+	unsigned long ulCellCount = pDomain->getAllocatedCellCount();
+
+	oclBufferImplicitFaces		= new COCLBuffer( "Implicit face terms", oclModel, false, true, ucFloatSize * 4 * ulCellCount, true );
+	oclBufferImplicitSolution	= new COCLBuffer( "Implicit solution and residual", oclModel, false, true, ucFloatSize * 2 * ulCellCount, true );
+	oclBufferImplicitDirection	= new COCLBuffer( "Implicit search direction", oclModel, false, true, ucFloatSize * ulCellCount, true );
+	oclBufferImplicitProduct	= new COCLBuffer( "Implicit matrix product", oclModel, false, true, ucFloatSize * ulCellCount, true );
+	oclBufferImplicitDiagonal	= new COCLBuffer( "Implicit preconditioner", oclModel, false, true, ucFloatSize * ulCellCount, true );
+	oclBufferImplicitPartials	= new COCLBuffer( "Implicit partial sums", oclModel, false, true, ucFloatSize * ( this->ulReductionGlobalSize / this->ulReductionWorkgroupSize ), true );
+	oclBufferImplicitScalars	= new COCLBuffer( "Implicit solver scalars", oclModel, false, true, ucFloatSize * 4, true );
+
+	oclBufferImplicitFaces->createBuffer();
+	oclBufferImplicitSolution->createBuffer();
+	oclBufferImplicitDirection->createBuffer();
+	oclBufferImplicitProduct->createBuffer();
+	oclBufferImplicitDiagonal->createBuffer();
+	oclBufferImplicitPartials->createBuffer();
+	oclBufferImplicitScalars->createBuffer();
+
+	return bReturnState;
+}
+
+/*
+ *  Schedule the conjugate gradient solve for the new levels in place of the
+ *  explicit kernel. Convergence is judged on the device, so the remaining
+ *  iterations become no-ops rather than needing the host to check.
+ */
+void	CSchemeInertial::scheduleTimestepKernels(
+				bool			bUseAlternateKernel,
+				COCLDevice*		pDevice
+	)
+{
+	if ( !this->bSemiImplicit )
+	{
+		CSchemeGodunov::scheduleTimestepKernels( bUseAlternateKernel, pDevice );
+		return;
+	}
+
+	COCLBuffer* pSource = bUseAlternateKernel ? oclBufferCellStatesAlt : oclBufferCellStates;
+	oclKernelImplicitFaces->assignArgument( 2, pSource );
+	oclKernelImplicitResidual->assignArgument( 1, pSource );
+
+	oclKernelImplicitFaces->scheduleExecution();
+	pDevice->queueBarrier();
+	oclKernelImplicitResidual->scheduleExecution();
+	pDevice->queueBarrier();
+	oclKernelImplicitStart->scheduleExecution();
+	pDevice->queueBarrier();
+
+	for( unsigned int i = 0; i < this->uiSolverIterations; ++i )
+	{
+		oclKernelImplicitApply->scheduleExecution();
+		pDevice->queueBarrier();
+		oclKernelImplicitAlpha->scheduleExecution();
+		pDevice->queueBarrier();
+		oclKernelImplicitUpdate->scheduleExecution();
+		pDevice->queueBarrier();
+		oclKernelImplicitBeta->scheduleExecution();
+		pDevice->queueBarrier();
+		oclKernelImplicitDirection->scheduleExecution();
+		pDevice->queueBarrier();
+	}
+
+	oclKernelFullTimestep->scheduleExecution();
 }
 
 /*
@@ -340,3 +658,35 @@ unsigned char	CSchemeInertial::getCacheConstraints()
 {
 	return this->ucCacheConstraints;
 }
+
+/*
+ *  Enable or disable taking the free-surface gradient at the new time level
+ */
+void	CSchemeInertial::setSemiImplicit( bool bEnabled )
+{
+	this->bSemiImplicit = bEnabled;
+}
+
+/*
+ *  Is the free-surface gradient taken at the new time level?
+ */
+bool	CSchemeInertial::getSemiImplicit()
+{
+	return this->bSemiImplicit;
+}
+
+/*
+ *  Set the conjugate gradient iterations scheduled for each timestep
+ */
+void	CSchemeInertial::setSolverIterations( unsigned int uiIterations )
+{
+	this->uiSolverIterations = uiIterations;
+}
+
+/*
+ *  Set the residual, relative to the initial residual, the solver stops at
+ */
+void	CSchemeInertial::setSolverTolerance( double dTolerance )
+{
+	this->dSolverTolerance = dTolerance;
+}
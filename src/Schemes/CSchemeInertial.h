@@ -27,7 +27,8 @@ namespace model {
 namespace schemeConfigurations{ 
 namespace inertialFormula { enum inertialFormula {
 	kCacheNone						= 0,		// No caching
-	kCacheEnabled					= 1			// Cache cell state data
+	kCacheEnabled					= 1,		// Cache cell state data
+	kCacheCoarsened					= 2			// Each work-item walks a strip of cells
 }; }  }
 
 namespace cacheConstraints{ 
@@ -55,12 +56,18 @@ class CSchemeInertial : public CSchemeGodunov
 		virtual ~CSchemeInertial( void );									// Destructor
 
 		// Public functions
+		virtual void		setupFromConfig( XMLElement*, bool = false );	// Set up the scheme
 		virtual void		logDetails();									// Write some details about the scheme
-		virtual void		prepareAll();									// Prepare absolutely everything for a model run
+		virtual bool		prepareSetup();									// Prepare everything which doesn't need the built program
+		virtual bool		prepareFinish();								// Create kernels and boundaries once built
 		void				setCacheMode( unsigned char );					// Set the cache configuration
 		unsigned char		getCacheMode();									// Get the cache configuration
 		void				setCacheConstraints( unsigned char );			// Set LDS cache size constraints
 		unsigned char		getCacheConstraints();							// Get LDS cache size constraints
+		void				setSemiImplicit( bool );						// Enable/disable the implicit free-surface gradient
+		bool				getSemiImplicit();								// Get enabled/disabled for the implicit free-surface gradient
+		void				setSolverIterations( unsigned int );			// Set the conjugate gradient iterations per timestep
+		void				setSolverTolerance( double );					// Set the relative residual the solver stops at
 
 	protected:
 
@@ -70,6 +77,30 @@ class CSchemeInertial : public CSchemeGodunov
 		bool				prepareInertialKernels();						// Prepare the kernels required
 		bool				prepareInertialConstants();						// Assign constants to the executor
 		void				releaseInertialResources();						// Release OpenCL resources consumed
+		bool				prepareImplicitMemory();						// Prepare memory buffers for the implicit solver
+		virtual void		scheduleTimestepKernels( bool, COCLDevice* );	// Schedule the kernel(s) advancing the cell states
+
+		// Private variables
+		bool				bSemiImplicit;									// Free-surface gradient taken at the new time level?
+		unsigned int		uiSolverIterations;								// Conjugate gradient iterations per timestep
+		double				dSolverTolerance;								// Relative residual the solver stops at
+
+		// OpenCL elements
+		COCLKernel*			oclKernelImplicitFaces;
+		COCLKernel*			oclKernelImplicitResidual;
+		COCLKernel*			oclKernelImplicitStart;
+		COCLKernel*			oclKernelImplicitApply;
+		COCLKernel*			oclKernelImplicitAlpha;
+		COCLKernel*			oclKernelImplicitUpdate;
+		COCLKernel*			oclKernelImplicitBeta;
+		COCLKernel*			oclKernelImplicitDirection;
+		COCLBuffer*			oclBufferImplicitFaces;
+		COCLBuffer*			oclBufferImplicitSolution;
+		COCLBuffer*			oclBufferImplicitDirection;
+		COCLBuffer*			oclBufferImplicitProduct;
+		COCLBuffer*			oclBufferImplicitDiagonal;
+		COCLBuffer*			oclBufferImplicitPartials;
+		COCLBuffer*			oclBufferImplicitScalars;
 
 };
 
@@ -45,6 +45,7 @@ CSchemeMUSCLHancock::CSchemeMUSCLHancock(void)
 	this->ucSolverType					= model::solverTypes::kHLLC;
 	this->ucConfiguration				= model::schemeConfigurations::musclHancock::kCachePrediction;
 	this->ucCacheConstraints			= model::cacheConstraints::musclHancock::kCacheActualSize;
+	this->ucGhostCells					= 2;
 
 	this->ulCachedWorkgroupSizeX		= 0;
 	this->ulCachedWorkgroupSizeY		= 0;
@@ -98,6 +99,8 @@ void	CSchemeMUSCLHancock::setupFromConfig( XMLElement* pXScheme, bool bInheritan
 				usCache = model::schemeConfigurations::musclHancock::kCachePrediction;
 			if ( strcmp( cParameterValue, "none" ) == 0 || strcmp( cParameterValue, "no" ) == 0 )
 				usCache = model::schemeConfigurations::musclHancock::kCacheNone;
+			if ( strcmp( cParameterValue, "coarsened" ) == 0 || strcmp( cParameterValue, "strip" ) == 0 )
+				usCache = model::schemeConfigurations::musclHancock::kCacheCoarsened;
 			if ( usCache == 255 )
 			{
 				model::doError(
@@ -150,9 +153,9 @@ void	CSchemeMUSCLHancock::setupFromConfig( XMLElement* pXScheme, bool bInheritan
 }
 
 /*
- *  Run all preparation steps
+ *  Prepare everything which doesn't need the built program
  */
-void CSchemeMUSCLHancock::prepareAll()
+bool CSchemeMUSCLHancock::prepareSetup()
 {
 	this->releaseResources();
 
@@ -169,6 +172,35 @@ void CSchemeMUSCLHancock::prepareAll()
 	this->oclModel->setForcedSinglePrecision( pManager->getFloatPrecision() == model::floatPrecision::kSingle );
 	unsigned char ucFloatSize =  ( pManager->getFloatPrecision() == model::floatPrecision::kDouble ? sizeof( cl_double ) : sizeof( cl_float ) );
 
+	// The second-order kernels don't carry the passive scalar
+	if ( this->bScalarTransport )
+	{
+		model::doError(
+			"Scalar transport is only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bScalarTransport = false;
+	}
+
+	// ...have no fused source parameters
+	if ( this->bFusedSources )
+	{
+		model::doError(
+			"Fused sources are only available with the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+		this->bFusedSources = false;
+	}
+
+	// ...nor a drainage sink
+	if ( this->pDomain->hasDrainageCapacity() )
+	{
+		model::doError(
+			"Drainage capacity is only applied by the Godunov-type scheme.",
+			model::errorCodes::kLevelWarning
+		);
+	}
+
 	// OpenCL elements
 	if ( !this->prepare1OExecDimensions() ) 
 	{ 
@@ -177,7 +209,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 	if ( !this->prepare2OExecDimensions() ) 
 	{ 
@@ -186,7 +218,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OConstants() ) 
@@ -196,7 +228,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 	if ( !this->prepare2OConstants() ) 
 	{ 
@@ -205,7 +237,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepareCode() ) 
@@ -215,7 +247,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if ( !this->prepare1OMemory() ) 
@@ -225,7 +257,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 	if ( !this->prepare2OMemory() ) 
 	{ 
@@ -234,9 +266,17 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
+	return true;
+}
+
+/*
+ *  Create the kernels and boundaries once the program is built
+ */
+bool CSchemeMUSCLHancock::prepareFinish()
+{
 	if ( !this->prepareGeneralKernels() ) 
 	{ 
 		model::doError(
@@ -244,7 +284,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 	if ( !this->prepare2OKernels() ) 
 	{ 
@@ -253,7 +293,7 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 		);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	if (!this->prepareBoundaries())
@@ -263,11 +303,12 @@ void CSchemeMUSCLHancock::prepareAll()
 			model::errorCodes::kLevelModelStop
 			);
 		this->releaseResources();
-		return;
+		return false;
 	}
 
 	this->logDetails();
 	this->bReady = true;
+	return true;
 }
 
 /*
@@ -298,6 +339,9 @@ void CSchemeMUSCLHancock::logDetails()
 	case model::schemeConfigurations::musclHancock::kCacheMaximum:
 			sConfiguration = "Maximum local caching";
 		break;
+	case model::schemeConfigurations::musclHancock::kCacheCoarsened:
+			sConfiguration = "Coarsened, " + toString( this->uiCoarseningFactor ) + " cells per work-item";
+		break;
 	}
 
 	pManager->log->writeLine( "MUSCL-HANCOCK 2ND-ORDER-ACCURATE SCHEME", true, wColour );
@@ -339,7 +383,7 @@ bool CSchemeMUSCLHancock::prepareCode()
 	oclModel->appendCodeFromResource( "CLSchemeMUSCLHancock_C" );
 	oclModel->appendCodeFromResource( "CLBoundaries_C" );
 
-	bReturnState = oclModel->compileProgram();
+	bReturnState = oclModel->createProgram();
 
 	return bReturnState;
 }
@@ -372,10 +416,10 @@ bool CSchemeMUSCLHancock::prepare2OExecDimensions()
 	if ( this->ulCachedWorkgroupSizeY == 0 )
 		ulCachedWorkgroupSizeY = ulConstraintWG;
 
-	ulCachedGlobalSizeX	= static_cast<unsigned long>( ceil( pDomain->getCols() * 
+	ulCachedGlobalSizeX	= static_cast<unsigned long>( ceil( ( pDomain->getCols() + 2 * this->ucGhostCells ) * 
 						  ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCachePrediction ? static_cast<double>( ulCachedWorkgroupSizeX ) / static_cast<double>( ulCachedWorkgroupSizeX - 2 ) : 1.0 ) *
 						  ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheMaximum    ? static_cast<double>( ulCachedWorkgroupSizeX ) / static_cast<double>( ulCachedWorkgroupSizeX - 4 ) : 1.0 ) ) );
-	ulCachedGlobalSizeY	= static_cast<unsigned long>( ceil( pDomain->getRows() * 
+	ulCachedGlobalSizeY	= static_cast<unsigned long>( ceil( ( pDomain->getRows() + 2 * this->ucGhostCells ) * 
 						  ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCachePrediction ? static_cast<double>( ulCachedWorkgroupSizeY ) / static_cast<double>( ulCachedWorkgroupSizeY - 2 ) : 1.0 ) *
 						  ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheMaximum    ? static_cast<double>( ulCachedWorkgroupSizeY ) / static_cast<double>( ulCachedWorkgroupSizeY - 4 ) : 1.0 ) ) );
 
@@ -393,7 +437,8 @@ bool CSchemeMUSCLHancock::prepare2OConstants()
 	// Work-group size requirements
 	// --
 
-	if ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheNone )
+	if ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheNone ||
+		 this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheCoarsened )
 	{
 		oclModel->registerConstant( 
 			"REQD_WG_SIZE_HALF_TS", 
@@ -479,13 +524,13 @@ bool CSchemeMUSCLHancock::prepare2OMemory()
 
 	if ( this->bContiguousFaceData )
 	{
-		oclBufferFaceExtrapolations = new COCLBuffer( "Face extrapolations", oclModel, false, true, ucFloatSize * 4 * 4 * pDomain->getCellCount(), true );
+		oclBufferFaceExtrapolations = new COCLBuffer( "Face extrapolations", oclModel, false, true, ucFloatSize * 4 * 4 * pDomain->getAllocatedCellCount(), true );
 		oclBufferFaceExtrapolations->createBuffer();
 	} else {
-		oclBufferFaceExtrapolationN = new COCLBuffer( "Face extrapolations N", oclModel, false, true, ucFloatSize * 4 * pDomain->getCellCount(), true );
-		oclBufferFaceExtrapolationE = new COCLBuffer( "Face extrapolations E", oclModel, false, true, ucFloatSize * 4 * pDomain->getCellCount(), true );
-		oclBufferFaceExtrapolationS = new COCLBuffer( "Face extrapolations S", oclModel, false, true, ucFloatSize * 4 * pDomain->getCellCount(), true );
-		oclBufferFaceExtrapolationW = new COCLBuffer( "Face extrapolations W", oclModel, false, true, ucFloatSize * 4 * pDomain->getCellCount(), true );
+		oclBufferFaceExtrapolationN = new COCLBuffer( "Face extrapolations N", oclModel, false, true, ucFloatSize * 4 * pDomain->getAllocatedCellCount(), true );
+		oclBufferFaceExtrapolationE = new COCLBuffer( "Face extrapolations E", oclModel, false, true, ucFloatSize * 4 * pDomain->getAllocatedCellCount(), true );
+		oclBufferFaceExtrapolationS = new COCLBuffer( "Face extrapolations S", oclModel, false, true, ucFloatSize * 4 * pDomain->getAllocatedCellCount(), true );
+		oclBufferFaceExtrapolationW = new COCLBuffer( "Face extrapolations W", oclModel, false, true, ucFloatSize * 4 * pDomain->getAllocatedCellCount(), true );
 		oclBufferFaceExtrapolationN->createBuffer();
 		oclBufferFaceExtrapolationE->createBuffer();
 		oclBufferFaceExtrapolationS->createBuffer();
@@ -546,12 +591,18 @@ bool CSchemeMUSCLHancock::prepare2OKernels()
 	else 
 	{
 
-		oclKernelHalfTimestep = oclModel->getKernel( "mch_1st_cacheNone" );
+		// Coarsened kernels take the same arguments, but each work-item
+		// covers a strip of rows so fewer are needed vertically
+		bool			bCoarsened		= ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheCoarsened );
+		unsigned int	uiCoarsening	= this->getKernelCoarsening();
+		cl_ulong		ulGlobalSizeY	= ( this->ulNonCachedGlobalSizeY + uiCoarsening - 1 ) / uiCoarsening;
+
+		oclKernelHalfTimestep = oclModel->getKernel( bCoarsened ? "mch_1st_cacheCoarsened" : "mch_1st_cacheNone" );
 		oclKernelHalfTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
-		oclKernelHalfTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, this->ulNonCachedGlobalSizeY );
-		oclKernelFullTimestep = oclModel->getKernel( "mch_2nd_cacheNone" );
+		oclKernelHalfTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, ulGlobalSizeY );
+		oclKernelFullTimestep = oclModel->getKernel( bCoarsened ? "mch_2nd_cacheCoarsened" : "mch_2nd_cacheNone" );
 		oclKernelFullTimestep->setGroupSize( this->ulNonCachedWorkgroupSizeX, this->ulNonCachedWorkgroupSizeY );
-		oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, this->ulNonCachedGlobalSizeY );
+		oclKernelFullTimestep->setGlobalSize( this->ulNonCachedGlobalSizeX, ulGlobalSizeY );
 
 		if ( this->bContiguousFaceData )
 		{
@@ -608,6 +659,14 @@ void CSchemeMUSCLHancock::release2OResources()
 	oclBufferFaceExtrapolationW		= NULL;
 }
 
+/*
+ *  Cells walked by each work-item in the configuration in use
+ */
+unsigned int	CSchemeMUSCLHancock::getKernelCoarsening()
+{
+	return ( this->ucConfiguration == model::schemeConfigurations::musclHancock::kCacheCoarsened ? this->uiCoarseningFactor : 1 );
+}
+
 /*
  *  Set the cache configuration to use
  */
@@ -649,6 +708,19 @@ void	CSchemeMUSCLHancock::scheduleIteration(
 					CDomain*					pDomain
 		)
 {
+	// Hydrological kernels are only scheduled on the iterations where they're due
+	bool bHydrologicalStep = true;
+	if ( this->bHydrologicalSubcycling )
+	{
+		bHydrologicalStep = ( this->uiHydrologicalCountdown <= 1 );
+		if ( bHydrologicalStep )
+		{
+			this->resetHydrologicalCountdown( 0.0 );
+		} else {
+			this->uiHydrologicalCountdown--;
+		}
+	}
+
 	// Half-timestep and full-timestep kernels
 	if ( this->ucConfiguration != model::schemeConfigurations::musclHancock::kCacheMaximum )
 	{
@@ -668,9 +740,23 @@ void	CSchemeMUSCLHancock::scheduleIteration(
 	}
 
 	// Run the boundary kernels (each bndy has its own kernel now)
-	pDomain->getBoundaries()->applyBoundaries(oclBufferCellStates);
+	pDomain->getBoundaries()->applyBoundaries(oclBufferCellStates, bHydrologicalStep);
 	pDevice->queueBarrier();
 
+	// Accumulated hydrological time has now been consumed
+	if ( this->bHydrologicalSubcycling && bHydrologicalStep )
+	{
+		oclKernelResetHydrological->scheduleExecution();
+		pDevice->queueBarrier();
+	}
+
+	// Closed and transmissive edges follow the updated cells
+	if ( this->bGhostFill )
+	{
+		oclKernelGhostFill->scheduleExecution();
+		pDevice->queueBarrier();
+	}
+
 	// Timestep reduction
 	if ( this->bDynamicTimestep )
 	{
@@ -730,15 +816,15 @@ void CSchemeMUSCLHancock::readDomainAll()
 	switch (this->ucConfiguration)
 	{
 		default:
-			oclBufferCellStates->queueReadAll();
+			this->saveStateOnDevice(oclBufferCellStates);
 		break;
 		case model::schemeConfigurations::musclHancock::kCacheMaximum:
 			if (bUseAlternateKernel)
 			{
-				oclBufferCellStatesAlt->queueReadAll();
+				this->saveStateOnDevice(oclBufferCellStatesAlt);
 			}
 			else {
-				oclBufferCellStates->queueReadAll();
+				this->saveStateOnDevice(oclBufferCellStates);
 			}
 		break;
 	}
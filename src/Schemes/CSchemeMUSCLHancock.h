@@ -29,7 +29,8 @@ namespace schemeConfigurations{
 namespace musclHancock { enum musclHancock {
 	kCacheNone						= 10,		// Option B in dissertation: No local memory used
 	kCachePrediction				= 11,		// Option C in dissertation: Only the prediction step uses caching
-	kCacheMaximum					= 12		// Option D in dissertation: All stages use cache memory
+	kCacheMaximum					= 12,		// Option D in dissertation: All stages use cache memory
+	kCacheCoarsened					= 13		// No local memory, each work-item walks a strip of cells
 }; }  }
 
 namespace cacheConstraints{ 
@@ -59,7 +60,8 @@ class CSchemeMUSCLHancock : public CSchemeGodunov
 		// Public functions
 		virtual void		setupFromConfig( XMLElement*, bool = false );	// Set up the scheme
 		virtual void		logDetails();									// Write some details about the scheme
-		virtual void		prepareAll();									// Prepare absolutely everything for a model run
+		virtual bool		prepareSetup();									// Prepare everything which doesn't need the built program
+		virtual bool		prepareFinish();								// Create kernels and boundaries once built
 		virtual void		scheduleIteration( bool,						// Schedule an iteration of the scheme
 											   COCLDevice*,
 											   CDomain* );	
@@ -83,6 +85,7 @@ class CSchemeMUSCLHancock : public CSchemeGodunov
 		bool				prepare2OMemory();								// Prepare memory buffers required
 		bool				prepare2OExecDimensions();						// Size the problem for execution
 		void				release2OResources();							// Release 2nd-order OpenCL resources consumed
+		virtual unsigned int	getKernelCoarsening();						// Cells walked by each work-item in the configuration in use
 
 		// Private variables
 		bool				bContiguousFaceData;							// Store all face state data contiguously?
@@ -38,6 +38,7 @@ char*					model::workingDir;
 char*					model::logFile;
 char*					model::configFile;
 char*					model::codeDir;
+char*					model::spoolDir;
 bool					model::quietMode;
 bool					model::forceAbort;
 bool					model::gdalInitiated;
@@ -82,7 +83,7 @@ int _tmain(int argc, char* argv[])
 
 	int iReturnCode = model::loadConfiguration();
 	if ( iReturnCode != model::appReturnCodes::kAppSuccess ) return iReturnCode;
-	iReturnCode = model::commenceSimulation();
+	iReturnCode = ( model::spoolDir == NULL ? model::commenceSimulation() : model::runService() );
 	if ( iReturnCode != model::appReturnCodes::kAppSuccess ) return iReturnCode;
 	iReturnCode = model::closeConfiguration();
 	if ( iReturnCode != model::appReturnCodes::kAppSuccess ) return iReturnCode;
@@ -142,7 +143,7 @@ int main(int argc, char* argv[])
 	int iReturnCode = model::loadConfiguration();
 	if ( iReturnCode != model::appReturnCodes::kAppSuccess ) 
 		return iReturnCode;
-	iReturnCode = model::commenceSimulation();
+	iReturnCode = ( model::spoolDir == NULL ? model::commenceSimulation() : model::runService() );
 	if ( iReturnCode != model::appReturnCodes::kAppSuccess ) 
 		return iReturnCode;
 	iReturnCode = model::closeConfiguration();
@@ -448,6 +449,22 @@ int model::commenceSimulation()
 	return model::appReturnCodes::kAppSuccess;
 }
 
+/*
+ *  Keep the configuration loaded and run jobs from the spool directory
+ */
+int model::runService()
+{
+	if ( !pManager ) 
+		return model::doClose(
+			model::appReturnCodes::kAppInitFailure	
+		);
+
+	pManager->runService( std::string( model::spoolDir ) );
+	pManager->runModelCleanup();
+
+	return model::appReturnCodes::kAppSuccess;
+}
+
 /*
  *  Close down the simulation
  */
@@ -464,7 +481,7 @@ int model::closeConfiguration()
 void model::parseArguments( int iArgCount, char* cArgEntities[] )
 {
 	// Arguments to check for
-	unsigned int	argOptionCount = 6;
+	unsigned int	argOptionCount = 7;
 	modelArgument	argOptions[]   = {
 		{	
 			"-c",
@@ -495,6 +512,11 @@ void model::parseArguments( int iArgCount, char* cArgEntities[] )
 			"-x",
 			"--code-dir\0",
 			"Directory containing the OpenCL code structure\0"
+		},
+		{
+			"-p",
+			"--service-spool\0",
+			"Stay resident and run jobs placed in this directory\0"
 		}
 	};
 
@@ -548,6 +570,14 @@ void model::handleArgument( const char * cLongName, char * cValue )
 		strcpy( codeDir, cValue );
 	}
 
+	else if ( strcmp( cLongName, "--service-spool" ) == 0 )
+	{
+		// Resolve now, as loading the configuration changes directory
+		std::string sSpoolDir = boost::filesystem::absolute( cValue ).string();
+		spoolDir = new char[ sSpoolDir.length() + 1 ];
+		strcpy( spoolDir, sSpoolDir.c_str() );
+	}
+
 	else if ( strcmp( cLongName, "--quiet-mode" ) == 0 )
 	{
 		model::quietMode = true;
@@ -590,6 +620,7 @@ int model::doClose( int iCode )
 	delete [] model::logFile;			// TODO: Fix me...
 	delete [] model::configFile;
 	delete [] model::codeDir;
+	delete [] model::spoolDir;
 	model::doPause();
 
 	pManager			= NULL;
@@ -597,6 +628,7 @@ int model::doClose( int iCode )
 	model::workingDir	= NULL;
 	model::logFile		= NULL;
 	model::configFile	= NULL;
+	model::spoolDir		= NULL;
 
 	return iCode;
 }
@@ -72,6 +72,7 @@ namespace model
 {
 int						loadConfiguration();
 int						commenceSimulation();
+int						runService();
 int						closeConfiguration();
 void					outputVersion();
 void					doPause();
@@ -160,6 +161,7 @@ extern	bool			disableScreen;
 extern	bool			disableConsole;
 extern	char*			workingDir;
 extern  char*			codeDir;
+extern  char*			spoolDir;
 extern  char*			configFile;
 extern  char*			logFile;
 extern	CModel*			pManager;
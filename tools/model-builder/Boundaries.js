@@ -30,6 +30,11 @@ Boundaries.prototype.writeFiles = function(duration, directory, cb) {
 		writeRequirements.push(this.writeFilesDrainage.bind(this, duration, directory, writeComplete));
 	}
 	
+	if (this.boundaryDefinition.inflowPoints) {
+		writeRequirements.push(this.writeFilesInflow.bind(this, duration, directory, writeComplete));
+		writeRequirements.push(this.writeFilesInflowMap.bind(this, directory, writeComplete));
+	}
+	
 	writeComplete(false);
 }
 
@@ -41,6 +46,10 @@ Boundaries.prototype.hasRainfall = function() {
 	return !!this.boundaryDefinition.rainfallIntensity;
 }
 
+Boundaries.prototype.getInflowPointCount = function() {
+	return this.boundaryDefinition.inflowPoints || 0;
+}
+
 Boundaries.prototype.writeFilesRainfall = function(duration, directory, cb) {
 	console.log('    Attempting to write rainfall intensity boundary.');
 	fs.writeFile(
@@ -59,6 +68,24 @@ Boundaries.prototype.writeFilesDrainage = function(duration, directory, cb) {
 	);
 }
 
+Boundaries.prototype.writeFilesInflow = function(duration, directory, cb) {
+	console.log('    Attempting to write inflow point boundary.');
+	fs.writeFile(
+		directory + '/inflow.csv',
+		this.getInflow(duration),
+		cb
+	);
+}
+
+Boundaries.prototype.writeFilesInflowMap = function(directory, cb) {
+	console.log('    Attempting to write inflow point map for ' + this.boundaryDefinition.inflowPoints + ' boundaries.');
+	fs.writeFile(
+		directory + '/inflow-map.csv',
+		this.getInflowMap(),
+		cb
+	);
+}
+
 Boundaries.prototype.getRainfall = function(duration) {
 	let csvHeader = 'Time (s),Rainfall intensity (mm/hr)\n';
 	let csvLines = '';
@@ -76,4 +103,30 @@ Boundaries.prototype.getDrainage = function(duration) {
 	return csvHeader + csvLines;
 }
 
+Boundaries.prototype.getInflow = function(duration) {
+	let csvHeader = 'Time (s),Depth (m),Discharge X (m3/s),Discharge Y (m3/s)\n';
+	let csvLines = '';
+	csvLines += '0.0,0.0,' + this.boundaryDefinition.inflowRate + ',0.0\n';
+	csvLines += duration + ',0.0,' + this.boundaryDefinition.inflowRate + ',0.0\n';
+	return csvHeader + csvLines;
+}
+
+Boundaries.prototype.getInflowMap = function() {
+	// One cell per boundary, spread on a regular grid across the extent
+	let extent = this.boundaryDefinition.inflowExtent;
+	let points = this.boundaryDefinition.inflowPoints;
+	let columns = Math.ceil(Math.sqrt(points));
+	let rows = Math.ceil(points / columns);
+	let spacingX = (extent.getUpperX() - extent.getLowerX()) / columns;
+	let spacingY = (extent.getUpperY() - extent.getLowerY()) / rows;
+	let csvHeader = 'X,Y,Boundary\n';
+	let csvLines = '';
+	for (let i = 0; i < points; i++) {
+		csvLines += (extent.getLowerX() + ((i % columns) + 0.5) * spacingX) + ',' +
+		            (extent.getLowerY() + (Math.floor(i / columns) + 0.5) * spacingY) + ',' +
+		            'Inflow_' + (i + 1) + '\n';
+	}
+	return csvHeader + csvLines;
+}
+
 module.exports = Boundaries;
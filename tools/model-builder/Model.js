@@ -276,6 +276,11 @@ Model.prototype.getXMLFile = function() {
 	if (this.boundaries.hasDrainage()) {
 		xmlBoundaries += '						<timeseries type="atmospheric" name="Drainage" value="loss-rate" source="drainage.csv" />\n';
 	}
+	
+	for (let i = 0; i < this.boundaries.getInflowPointCount(); i++) {
+		xmlBoundaries += '						<timeseries type="cell" name="Inflow_' + (i + 1) + '" depthValue="ignore" dischargeValue="total" source="inflow.csv" />\n';
+	}
+	let xmlBoundaryMap = this.boundaries.getInflowPointCount() > 0 ? ' mapFile="inflow-map.csv" mapType="coordinates"' : '';
 
 	let xml = '\
 	<?xml version="1.0"?>\n\
@@ -333,7 +338,7 @@ Model.prototype.getXMLFile = function() {
 						<parameter name="groupSize" value="32x8" />\n\
 ' + xmlSchemeOptions.trimRight() + '\n\
 					</scheme>\n\
-					<boundaryConditions sourceDir="boundaries/">\n\
+					<boundaryConditions sourceDir="boundaries/"' + xmlBoundaryMap + '>\n\
 ' + xmlBoundaries.trimRight() + '\n\
 					</boundaryConditions>\n\
 				</domain>\n';
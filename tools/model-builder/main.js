@@ -274,7 +274,28 @@ function getExtent (modelInfo, commands) {
 	return new Extent(llCoords[0], llCoords[1], urCoords[0], urCoords[1]);
 }
 
-function getBoundaries (modelInfo, commands) {
+function getInflowPoints (commands, extent) {
+	if (commands.inflowPoints === undefined) return {};
+	
+	let inflowPoints = parseInt(commands.inflowPoints, 10);
+	if (!isFinite(inflowPoints) ||
+	    isNaN(inflowPoints) ||
+		inflowPoints <= 0) {
+		console.log('Number of inflow points is invalid.');
+		return null;
+	}
+	
+	return {
+		inflowPoints: inflowPoints,
+		inflowRate: parseFloat(commands.inflowRate || '0.01'),
+		inflowExtent: extent
+	};
+}
+
+function getBoundaries (modelInfo, commands, extent) {
+	let inflowDefinition = getInflowPoints(commands, extent);
+	if (inflowDefinition === null) return false;
+	
 	if (modelInfo.source === 'pluvial') {
 		let rainfallIntensity = getRate(commands.rainfallIntensity);
 		let rainfallDuration = getSeconds(commands.rainfallDuration);
@@ -289,13 +310,13 @@ function getBoundaries (modelInfo, commands) {
 			return false;
 		}
 
-		return new Boundaries({
+		return new Boundaries(Object.assign({
 			rainfallIntensity: rainfallIntensity,
 			rainfallDuration: rainfallDuration,
 			drainageRate: drainageRate
-		});
+		}, inflowDefinition));
 	} else if (modelInfo.source === 'analytical' || modelInfo.source === 'laboratory') {
-		return new Boundaries({});
+		return new Boundaries(inflowDefinition);
 	} else {
 		console.log('Cannot prepare boundaries for this type of model.');
 		return false;
@@ -323,6 +344,8 @@ program
 	.option('-ri, --rainfall-intensity <Xmm/hr>', 'rainfall intensity')
 	.option('-rd, --rainfall-duration <Xmins>', 'rainfall duration')
 	.option('-dr, --drainage <Xmm/hr>', 'drainage rate')
+	.option('-ip, --inflow-points <count>', 'cell inflow boundaries sharing one map file')
+	.option('-iq, --inflow-rate <Xm3/s>', 'discharge for each inflow point')
 	.option('-c, --constants <a=X,b=Y>', 'override underlying constants')
 	.parse(process.argv);
 
@@ -332,7 +355,7 @@ if (!modelInfo) triggerErrorFail('You must specify more inforation about this mo
 var modelExtent = getExtent(modelInfo, program);
 if (!modelExtent) triggerErrorFail('You must specify a valid extent for the model.');
 
-var modelBoundaries = getBoundaries(modelInfo, program);
+var modelBoundaries = getBoundaries(modelInfo, program, modelExtent);
 if (!modelBoundaries) triggerErrorFail('You must specify more boundary conditions.');
 
 var model = new Model(modelInfo, modelExtent, modelBoundaries);